@@ -13,25 +13,114 @@
 extern "C" {
 #endif
 
+#define MAX_TXN_LOCKS 16
+#define MAX_SUBTREE 1024
+#define MAX_INDOUBT 1024
+#define MAX_EPOCH_TXNS 256
+#define MAX_INFO 256
+#define VOTE_RETRY 2
 
 struct TxnID {
 	int txn_id;
+	u_quad_t trace_id;
+	u_quad_t span_id;
 };
 typedef struct TxnID TxnID;
 
+struct LockReq {
+	int key;
+	int exclusive;
+};
+typedef struct LockReq LockReq;
+
+struct Member {
+	char *host;
+	u_int prog;
+};
+typedef struct Member Member;
+
+struct PrepareArgs {
+	int txn_id;
+	u_quad_t trace_id;
+	u_quad_t span_id;
+	struct {
+		u_int locks_len;
+		LockReq *locks_val;
+	} locks;
+	int fanout;
+	struct {
+		u_int subtree_len;
+		Member *subtree_val;
+	} subtree;
+};
+typedef struct PrepareArgs PrepareArgs;
+
 struct PrepareResult {
 	int ok;
-	char *info;
+	union {
+		char *info;
+	} PrepareResult_u;
 };
 typedef struct PrepareResult PrepareResult;
 
+struct InDoubtList {
+	struct {
+		u_int txn_ids_len;
+		int *txn_ids_val;
+	} txn_ids;
+	int more;
+};
+typedef struct InDoubtList InDoubtList;
+
+struct DecisionBatch {
+	u_quad_t trace_id;
+	u_quad_t span_id;
+	struct {
+		u_int commit_ids_len;
+		int *commit_ids_val;
+	} commit_ids;
+	struct {
+		u_int abort_ids_len;
+		int *abort_ids_val;
+	} abort_ids;
+};
+typedef struct DecisionBatch DecisionBatch;
+
+struct EpochTxn {
+	int txn_id;
+	struct {
+		u_int locks_len;
+		LockReq *locks_val;
+	} locks;
+};
+typedef struct EpochTxn EpochTxn;
+
+struct PrepareEpochArgs {
+	int epoch_id;
+	u_quad_t trace_id;
+	u_quad_t span_id;
+	struct {
+		u_int txns_len;
+		EpochTxn *txns_val;
+	} txns;
+};
+typedef struct PrepareEpochArgs PrepareEpochArgs;
+
+struct EpochVotes {
+	struct {
+		u_int votes_len;
+		int *votes_val;
+	} votes;
+};
+typedef struct EpochVotes EpochVotes;
+
 #define COMMIT_PROG 0x20000001
 #define COMMIT_VERS 1
 
 #if defined(__STDC__) || defined(__cplusplus)
 #define PREPARE 1
-extern  PrepareResult * prepare_1(TxnID , CLIENT *);
-extern  PrepareResult * prepare_1_svc(TxnID , struct svc_req *);
+extern  PrepareResult * prepare_1(PrepareArgs , CLIENT *);
+extern  PrepareResult * prepare_1_svc(PrepareArgs , struct svc_req *);
 #define COMMIT 2
 extern  int * commit_1(TxnID , CLIENT *);
 extern  int * commit_1_svc(TxnID , struct svc_req *);
@@ -41,6 +130,18 @@ extern  int * abort_1_svc(TxnID , struct svc_req *);
 #define STATUS 4
 extern  int * status_1(TxnID , CLIENT *);
 extern  int * status_1_svc(TxnID , struct svc_req *);
+#define IN_DOUBT 5
+extern  InDoubtList * in_doubt_1(int , CLIENT *);
+extern  InDoubtList * in_doubt_1_svc(int , struct svc_req *);
+#define DECIDE_BATCH 6
+extern  int * decide_batch_1(DecisionBatch , CLIENT *);
+extern  int * decide_batch_1_svc(DecisionBatch , struct svc_req *);
+#define PREPARE_EPOCH 7
+extern  EpochVotes * prepare_epoch_1(PrepareEpochArgs , CLIENT *);
+extern  EpochVotes * prepare_epoch_1_svc(PrepareEpochArgs , struct svc_req *);
+#define PREPARE_COMMIT 8
+extern  PrepareResult * prepare_commit_1(PrepareArgs , CLIENT *);
+extern  PrepareResult * prepare_commit_1_svc(PrepareArgs , struct svc_req *);
 extern int commit_prog_1_freeresult (SVCXPRT *, xdrproc_t, caddr_t);
 
 #else /* K&R C */
@@ -56,6 +157,18 @@ extern  int * abort_1_svc();
 #define STATUS 4
 extern  int * status_1();
 extern  int * status_1_svc();
+#define IN_DOUBT 5
+extern  InDoubtList * in_doubt_1();
+extern  InDoubtList * in_doubt_1_svc();
+#define DECIDE_BATCH 6
+extern  int * decide_batch_1();
+extern  int * decide_batch_1_svc();
+#define PREPARE_EPOCH 7
+extern  EpochVotes * prepare_epoch_1();
+extern  EpochVotes * prepare_epoch_1_svc();
+#define PREPARE_COMMIT 8
+extern  PrepareResult * prepare_commit_1();
+extern  PrepareResult * prepare_commit_1_svc();
 extern int commit_prog_1_freeresult ();
 #endif /* K&R C */
 
@@ -63,11 +176,27 @@ extern int commit_prog_1_freeresult ();
 
 #if defined(__STDC__) || defined(__cplusplus)
 extern  bool_t xdr_TxnID (XDR *, TxnID*);
+extern  bool_t xdr_LockReq (XDR *, LockReq*);
+extern  bool_t xdr_Member (XDR *, Member*);
+extern  bool_t xdr_PrepareArgs (XDR *, PrepareArgs*);
 extern  bool_t xdr_PrepareResult (XDR *, PrepareResult*);
+extern  bool_t xdr_InDoubtList (XDR *, InDoubtList*);
+extern  bool_t xdr_DecisionBatch (XDR *, DecisionBatch*);
+extern  bool_t xdr_EpochTxn (XDR *, EpochTxn*);
+extern  bool_t xdr_PrepareEpochArgs (XDR *, PrepareEpochArgs*);
+extern  bool_t xdr_EpochVotes (XDR *, EpochVotes*);
 
 #else /* K&R C */
 extern bool_t xdr_TxnID ();
+extern bool_t xdr_LockReq ();
+extern bool_t xdr_Member ();
+extern bool_t xdr_PrepareArgs ();
 extern bool_t xdr_PrepareResult ();
+extern bool_t xdr_InDoubtList ();
+extern bool_t xdr_DecisionBatch ();
+extern bool_t xdr_EpochTxn ();
+extern bool_t xdr_PrepareEpochArgs ();
+extern bool_t xdr_EpochVotes ();
 
 #endif /* K&R C */
 
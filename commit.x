@@ -1,15 +1,73 @@
+const MAX_TXN_LOCKS = 16;
+const MAX_SUBTREE = 1024;
+const MAX_INDOUBT = 1024;
+const MAX_EPOCH_TXNS = 256;
+const MAX_INFO = 256;
+const VOTE_RETRY = 2; /* PrepareResult.ok: wait-die 로 lock 을 기다리는 중, 같은 PREPARE 를 나중에 다시 보냄 */
+
 struct TxnID {
         int txn_id;
+        unsigned hyper trace_id;  /* 0 = tracing off */
+        unsigned hyper span_id;   /* 보낸 쪽 RPC 의 flow id */
 };
-struct PrepareResult {
-        int ok; /* 1 = YES (vote-commit), 0 = NO (vote-abort) */
-        string info<256>;
+struct LockReq {
+        int key;
+        int exclusive; /* 1 = X, 0 = S */
+};
+struct Member {
+        string host<255>;
+        unsigned int prog;
+};
+struct PrepareArgs {
+        int txn_id;
+        unsigned hyper trace_id;
+        unsigned hyper span_id;
+        LockReq locks<MAX_TXN_LOCKS>;
+        int fanout;               /* tree mode: 자식 subtree 수 */
+        Member subtree<MAX_SUBTREE>; /* 이 노드가 sub-coordinator 로서 맡을 하위 participant 들 */
+};
+/* 이유 문자열은 NO 일 때만 보냄 (YES 응답은 ok 4 byte) */
+union PrepareResult switch (int ok) { /* 1 = YES (vote-commit), 0 = NO (vote-abort), VOTE_RETRY */
+case 0:
+        string info<MAX_INFO>;
+default:
+        void;
+};
+/* recovery: participant 가 가진 PREPARED 상태 (결정을 못 받은) txn 목록 */
+struct InDoubtList {
+        int txn_ids<MAX_INDOUBT>; /* 오름차순 */
+        int more;                 /* 1 = 마지막 txn_id 뒤로 더 있음 (다시 요청) */
+};
+/* recovery: 여러 txn 의 결정을 한 번에 전달 */
+struct DecisionBatch {
+        unsigned hyper trace_id;
+        unsigned hyper span_id;
+        int commit_ids<MAX_INDOUBT>;
+        int abort_ids<MAX_INDOUBT>;
+};
+/* epoch mode: 한 번의 PREPARE 로 여러 txn 을 처리, 투표는 txn 별 */
+struct EpochTxn {
+        int txn_id;
+        LockReq locks<MAX_TXN_LOCKS>;
+};
+struct PrepareEpochArgs {
+        int epoch_id;             /* epoch 의 첫 txn_id */
+        unsigned hyper trace_id;
+        unsigned hyper span_id;
+        EpochTxn txns<MAX_EPOCH_TXNS>;
+};
+struct EpochVotes {
+        int votes<MAX_EPOCH_TXNS>; /* txns 와 같은 순서, 1 = YES, 0 = NO */
 };
 program COMMIT_PROG {
         version COMMIT_VERS {
-                PrepareResult PREPARE(TxnID) = 1;
+                PrepareResult PREPARE(PrepareArgs) = 1;
                 int COMMIT(TxnID) = 2;
                 int ABORT(TxnID) = 3;
                 int STATUS(TxnID) = 4;
+                InDoubtList IN_DOUBT(int) = 5;        /* 인자: 이 txn_id 보다 큰 것만 */
+                int DECIDE_BATCH(DecisionBatch) = 6;  /* 반환: 새로 기록한 결정 수 */
+                EpochVotes PREPARE_EPOCH(PrepareEpochArgs) = 7;
+                PrepareResult PREPARE_COMMIT(PrepareArgs) = 8; /* one-phase: participant 가 직접 COMMIT/ABORT 결정, ok = 1 이면 COMMITTED */
         } = 1;
 } = 0x20000001;
@@ -10,13 +10,13 @@
 static struct timeval TIMEOUT = { 25, 0 };
 
 PrepareResult *
-prepare_1(TxnID arg1,  CLIENT *clnt)
+prepare_1(PrepareArgs arg1,  CLIENT *clnt)
 {
 	static PrepareResult clnt_res;
 
 	memset((char *)&clnt_res, 0, sizeof(clnt_res));
 	if (clnt_call (clnt, PREPARE,
-		(xdrproc_t) xdr_TxnID, (caddr_t) &arg1,
+		(xdrproc_t) xdr_PrepareArgs, (caddr_t) &arg1,
 		(xdrproc_t) xdr_PrepareResult, (caddr_t) &clnt_res,
 		TIMEOUT) != RPC_SUCCESS) {
 		return (NULL);
@@ -68,3 +68,63 @@ status_1(TxnID arg1,  CLIENT *clnt)
 	}
 	return (&clnt_res);
 }
+
+InDoubtList *
+in_doubt_1(int arg1,  CLIENT *clnt)
+{
+	static InDoubtList clnt_res;
+
+	memset((char *)&clnt_res, 0, sizeof(clnt_res));
+	if (clnt_call (clnt, IN_DOUBT,
+		(xdrproc_t) xdr_int, (caddr_t) &arg1,
+		(xdrproc_t) xdr_InDoubtList, (caddr_t) &clnt_res,
+		TIMEOUT) != RPC_SUCCESS) {
+		return (NULL);
+	}
+	return (&clnt_res);
+}
+
+int *
+decide_batch_1(DecisionBatch arg1,  CLIENT *clnt)
+{
+	static int clnt_res;
+
+	memset((char *)&clnt_res, 0, sizeof(clnt_res));
+	if (clnt_call (clnt, DECIDE_BATCH,
+		(xdrproc_t) xdr_DecisionBatch, (caddr_t) &arg1,
+		(xdrproc_t) xdr_int, (caddr_t) &clnt_res,
+		TIMEOUT) != RPC_SUCCESS) {
+		return (NULL);
+	}
+	return (&clnt_res);
+}
+
+EpochVotes *
+prepare_epoch_1(PrepareEpochArgs arg1,  CLIENT *clnt)
+{
+	static EpochVotes clnt_res;
+
+	memset((char *)&clnt_res, 0, sizeof(clnt_res));
+	if (clnt_call (clnt, PREPARE_EPOCH,
+		(xdrproc_t) xdr_PrepareEpochArgs, (caddr_t) &arg1,
+		(xdrproc_t) xdr_EpochVotes, (caddr_t) &clnt_res,
+		TIMEOUT) != RPC_SUCCESS) {
+		return (NULL);
+	}
+	return (&clnt_res);
+}
+
+PrepareResult *
+prepare_commit_1(PrepareArgs arg1,  CLIENT *clnt)
+{
+	static PrepareResult clnt_res;
+
+	memset((char *)&clnt_res, 0, sizeof(clnt_res));
+	if (clnt_call (clnt, PREPARE_COMMIT,
+		(xdrproc_t) xdr_PrepareArgs, (caddr_t) &arg1,
+		(xdrproc_t) xdr_PrepareResult, (caddr_t) &clnt_res,
+		TIMEOUT) != RPC_SUCCESS) {
+		return (NULL);
+	}
+	return (&clnt_res);
+}
@@ -17,7 +17,7 @@
 #endif
 
 static PrepareResult *
-_prepare_1 (TxnID  *argp, struct svc_req *rqstp)
+_prepare_1 (PrepareArgs  *argp, struct svc_req *rqstp)
 {
 	return (prepare_1_svc(*argp, rqstp));
 }
@@ -40,14 +40,42 @@ _status_1 (TxnID  *argp, struct svc_req *rqstp)
 	return (status_1_svc(*argp, rqstp));
 }
 
+static InDoubtList *
+_in_doubt_1 (int  *argp, struct svc_req *rqstp)
+{
+	return (in_doubt_1_svc(*argp, rqstp));
+}
+
+static int *
+_decide_batch_1 (DecisionBatch  *argp, struct svc_req *rqstp)
+{
+	return (decide_batch_1_svc(*argp, rqstp));
+}
+
+static EpochVotes *
+_prepare_epoch_1 (PrepareEpochArgs  *argp, struct svc_req *rqstp)
+{
+	return (prepare_epoch_1_svc(*argp, rqstp));
+}
+
+static PrepareResult *
+_prepare_commit_1 (PrepareArgs  *argp, struct svc_req *rqstp)
+{
+	return (prepare_commit_1_svc(*argp, rqstp));
+}
+
 static void
 commit_prog_1(struct svc_req *rqstp, register SVCXPRT *transp)
 {
 	union {
-		TxnID prepare_1_arg;
+		PrepareArgs prepare_1_arg;
 		TxnID commit_1_arg;
 		TxnID abort_1_arg;
 		TxnID status_1_arg;
+		int in_doubt_1_arg;
+		DecisionBatch decide_batch_1_arg;
+		PrepareEpochArgs prepare_epoch_1_arg;
+		PrepareArgs prepare_commit_1_arg;
 	} argument;
 	char *result;
 	xdrproc_t _xdr_argument, _xdr_result;
@@ -59,7 +87,7 @@ commit_prog_1(struct svc_req *rqstp, register SVCXPRT *transp)
 		return;
 
 	case PREPARE:
-		_xdr_argument = (xdrproc_t) xdr_TxnID;
+		_xdr_argument = (xdrproc_t) xdr_PrepareArgs;
 		_xdr_result = (xdrproc_t) xdr_PrepareResult;
 		local = (char *(*)(char *, struct svc_req *)) _prepare_1;
 		break;
@@ -82,6 +110,30 @@ commit_prog_1(struct svc_req *rqstp, register SVCXPRT *transp)
 		local = (char *(*)(char *, struct svc_req *)) _status_1;
 		break;
 
+	case IN_DOUBT:
+		_xdr_argument = (xdrproc_t) xdr_int;
+		_xdr_result = (xdrproc_t) xdr_InDoubtList;
+		local = (char *(*)(char *, struct svc_req *)) _in_doubt_1;
+		break;
+
+	case DECIDE_BATCH:
+		_xdr_argument = (xdrproc_t) xdr_DecisionBatch;
+		_xdr_result = (xdrproc_t) xdr_int;
+		local = (char *(*)(char *, struct svc_req *)) _decide_batch_1;
+		break;
+
+	case PREPARE_EPOCH:
+		_xdr_argument = (xdrproc_t) xdr_PrepareEpochArgs;
+		_xdr_result = (xdrproc_t) xdr_EpochVotes;
+		local = (char *(*)(char *, struct svc_req *)) _prepare_epoch_1;
+		break;
+
+	case PREPARE_COMMIT:
+		_xdr_argument = (xdrproc_t) xdr_PrepareArgs;
+		_xdr_result = (xdrproc_t) xdr_PrepareResult;
+		local = (char *(*)(char *, struct svc_req *)) _prepare_commit_1;
+		break;
+
 	default:
 		svcerr_noproc (transp);
 		return;
@@ -12,6 +12,56 @@ xdr_TxnID (XDR *xdrs, TxnID *objp)
 
 	 if (!xdr_int (xdrs, &objp->txn_id))
 		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->trace_id))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->span_id))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_LockReq (XDR *xdrs, LockReq *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_int (xdrs, &objp->key))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->exclusive))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_Member (XDR *xdrs, Member *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_string (xdrs, &objp->host, 255))
+		 return FALSE;
+	 if (!xdr_u_int (xdrs, &objp->prog))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_PrepareArgs (XDR *xdrs, PrepareArgs *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_int (xdrs, &objp->txn_id))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->trace_id))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->span_id))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->locks.locks_val, (u_int *) &objp->locks.locks_len, MAX_TXN_LOCKS,
+		sizeof (LockReq), (xdrproc_t) xdr_LockReq))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->fanout))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->subtree.subtree_val, (u_int *) &objp->subtree.subtree_len, MAX_SUBTREE,
+		sizeof (Member), (xdrproc_t) xdr_Member))
+		 return FALSE;
 	return TRUE;
 }
 
@@ -22,7 +72,85 @@ xdr_PrepareResult (XDR *xdrs, PrepareResult *objp)
 
 	 if (!xdr_int (xdrs, &objp->ok))
 		 return FALSE;
-	 if (!xdr_string (xdrs, &objp->info, 256))
+	switch (objp->ok) {
+	case 0:
+		 if (!xdr_string (xdrs, &objp->PrepareResult_u.info, MAX_INFO))
+			 return FALSE;
+		break;
+	default:
+		break;
+	}
+	return TRUE;
+}
+
+bool_t
+xdr_InDoubtList (XDR *xdrs, InDoubtList *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_array (xdrs, (char **)&objp->txn_ids.txn_ids_val, (u_int *) &objp->txn_ids.txn_ids_len, MAX_INDOUBT,
+		sizeof (int), (xdrproc_t) xdr_int))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->more))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_DecisionBatch (XDR *xdrs, DecisionBatch *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_u_quad_t (xdrs, &objp->trace_id))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->span_id))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->commit_ids.commit_ids_val, (u_int *) &objp->commit_ids.commit_ids_len, MAX_INDOUBT,
+		sizeof (int), (xdrproc_t) xdr_int))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->abort_ids.abort_ids_val, (u_int *) &objp->abort_ids.abort_ids_len, MAX_INDOUBT,
+		sizeof (int), (xdrproc_t) xdr_int))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_EpochTxn (XDR *xdrs, EpochTxn *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_int (xdrs, &objp->txn_id))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->locks.locks_val, (u_int *) &objp->locks.locks_len, MAX_TXN_LOCKS,
+		sizeof (LockReq), (xdrproc_t) xdr_LockReq))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_PrepareEpochArgs (XDR *xdrs, PrepareEpochArgs *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_int (xdrs, &objp->epoch_id))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->trace_id))
+		 return FALSE;
+	 if (!xdr_u_quad_t (xdrs, &objp->span_id))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->txns.txns_val, (u_int *) &objp->txns.txns_len, MAX_EPOCH_TXNS,
+		sizeof (EpochTxn), (xdrproc_t) xdr_EpochTxn))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_EpochVotes (XDR *xdrs, EpochVotes *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_array (xdrs, (char **)&objp->votes.votes_val, (u_int *) &objp->votes.votes_len, MAX_EPOCH_TXNS,
+		sizeof (int), (xdrproc_t) xdr_int))
 		 return FALSE;
 	return TRUE;
 }
@@ -0,0 +1,1528 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <rpc/rpc.h>
+#include <time.h>
+#include <sys/eventfd.h>
+#include "coord_lib.h"
+#include "tree.h"
+#include "uring_log.h"
+#include "trace.h"
+#include "replica.h"
+#include "xdr_fast.h"
+#include "env.h"
+
+#define MAX_PARTICIPANTS MAX_SUBTREE
+#define MAX_HOST_LEN 256
+// RPC 타임아웃 5초
+#define TIMEOUT_SEC 5
+#define PREPARE_RETRY_MS (TIMEOUT_SEC * 1000) // deadline 없는 txn 이 VOTE_RETRY 를 받고 다시 보내는 최대 시간
+
+typedef struct {
+    char host[MAX_HOST_LEN];
+    unsigned long prog_number;
+    int limit;                // 동시에 진행할 수 있는 txn 수 (0 = 제한 없음)
+    int inflight;             // slot_mu 로 보호
+} Participant;
+
+typedef struct {
+    int txn_id;
+    char state[32];
+    int committed; // DECISION_COMMIT 을 본 적 있음 (COMPLETE 뒤에도 결정을 알 수 있게)
+} TxnRecord;
+
+struct CoordTxn {
+    Coordinator *coord;
+    int txn_id;
+    uint64_t trace_id;
+    LockReq locks[MAX_TXN_LOCKS];
+    int lock_count;
+    int decision;
+    int has_deadline;
+    struct timespec deadline; // CLOCK_MONOTONIC
+    coord_done_fn cb;
+    void *cb_arg;
+    struct CoordTxn *next;
+};
+
+struct Coordinator {
+    CoordOptions opts;
+    char conf_file[256];
+    char log_file[256];
+    Participant participants[MAX_PARTICIPANTS];
+    Member members[MAX_PARTICIPANTS]; // tree mode 용 (host 는 participants[] 를 가리킴)
+    int participant_count;
+    int next_txn_id;
+
+    pthread_mutex_t log_mu;   // txn.log append 직렬화 (fsync backend)
+    UringLog *ulog;           // io_uring backend, NULL 이면 fsync backend
+    pthread_mutex_t mu;       // 아래 queue 들과 next_txn_id 보호
+    pthread_cond_t work_cv;
+    CoordTxn *submit_head, *submit_tail;
+    int submit_len;
+    int collecting;           // epoch mode: 지금 epoch 를 모으는 thread 가 있음
+
+    pthread_mutex_t slot_mu;  // participant 별 inflight 보호
+    pthread_cond_t slot_cv;   // CLOCK_MONOTONIC (deadline 까지 대기)
+    int has_limits;
+    CoordTxn *done_head, *done_tail;
+    int stopping;
+    int failed;               // 로그를 쓸 수 없음: 새 txn 은 받지 않고 진행 중인 것은 ABORT
+    int error_reported;       // on_error 를 이미 호출함
+    char error[256];          // 첫 오류
+
+    int lease_fd;             // opts.lease_file 의 fcntl lock (-1 = lease 없이 동작)
+    int repl_fd;              // hot standby 로의 복제 연결 (-1 = 없음)
+    time_t repl_retry_at;     // 끊겼을 때 다음 연결 시도 시각 (CLOCK_MONOTONIC 초)
+    int degraded;             // lease 에 degraded 를 표시함 (standby 로그가 뒤처짐)
+    pthread_mutex_t repl_mu;  // frame 전송 + ack 대기 직렬화
+
+    int event_fd;
+    pthread_t *workers;
+    int worker_count;
+};
+
+// RPC 타임아웃 구조체 초기화.
+static struct timeval TIMEOUT = {TIMEOUT_SEC, 0};
+// worker thread 가 지금 진행 중인 txn 의 trace id (span 기록용)
+static __thread uint64_t cur_trace_id = 0;
+
+/* ---------- Failure Injection / Logging ---------- */
+static void maybe_fail(Coordinator *c, const char *phase) {
+    env->crash_point(phase);
+    if ((strcmp(phase, "after_prepare") == 0 && c->opts.fail_after_prepare) ||
+        (strcmp(phase, "after_commit") == 0 && c->opts.fail_after_commit)) {
+        fprintf(stderr, "[FAILURE] Simulating crash during %s\n", phase);
+        exit(99);
+    }
+}
+
+// 더 진행할 수 없는 오류. 프로세스를 끝내지 않고 failed 로 표시한 뒤 coord_poll 이 on_error 를 부르게 깨움
+static void coord_fail(Coordinator *c, const char *fmt, ...) {
+    char msg[256];
+    uint64_t one = 1;
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+    fprintf(stderr, "[ERROR] %s\n", msg);
+
+    pthread_mutex_lock(&c->mu);
+    if (!c->failed) snprintf(c->error, sizeof(c->error), "%s", msg);
+    c->failed = 1;
+    pthread_mutex_unlock(&c->mu);
+    if (c->event_fd >= 0 && write(c->event_fd, &one, sizeof(one)) != sizeof(one))
+        perror("eventfd write");
+}
+
+static int coord_failed(Coordinator *c) {
+    pthread_mutex_lock(&c->mu);
+    int failed = c->failed;
+    pthread_mutex_unlock(&c->mu);
+    return failed;
+}
+
+static const char *decision_name(int decision) {
+    return decision == COORD_DECISION_UNKNOWN ? "UNKNOWN" : decision ? "COMMIT" : "ABORT";
+}
+
+// standby 에 연결해 지금 로그 전체를 SNAPSHOT 으로 보냄 (repl_mu 를 쥐고 호출).
+// standby 가 다시 primary 와 같은 로그를 가졌으므로 lease 의 degraded 표시를 지움
+static void attach_standby(Coordinator *c) {
+    struct timespec now;
+    env->now(&now);
+    c->repl_retry_at = now.tv_sec + 1;
+
+    c->repl_fd = replica_connect(c->opts.replica_addr);
+    if (c->repl_fd >= 0 && replica_send_file(c->repl_fd, c->log_file) < 0) {
+        close(c->repl_fd);
+        c->repl_fd = -1;
+    }
+    if (c->repl_fd < 0) return;
+    fprintf(stderr, "[DEBUG] Replicating %s to standby %s\n", c->log_file, c->opts.replica_addr);
+    if (c->degraded) {
+        // 지우지 못하면 표시가 남을 뿐 (standby 가 넘겨받지 않는 쪽으로 안전함)
+        if (lease_set_degraded(c->lease_fd, 0) < 0) perror("lease degraded");
+        else c->degraded = 0;
+    }
+}
+
+// standby 없이 기록하기 전에 lease 에 degraded 를 남겨 standby 가 뒤처진 로그로 넘겨받지 않게 함 (repl_mu 를 쥐고 호출)
+static int mark_degraded(Coordinator *c) {
+    if (lease_set_degraded(c->lease_fd, 1) < 0) {
+        coord_fail(c, "cannot mark lease %s degraded: %s", c->opts.lease_file, strerror(errno));
+        return -1;
+    }
+    c->degraded = 1;
+    fprintf(stderr, "[WARNING] Standby %s is not in sync. Marked lease %s degraded: the standby will not take over until it is attached again.\n",
+                    c->opts.replica_addr, c->opts.lease_file);
+    return 0;
+}
+
+// 로컬에 기록한 레코드를 standby 에게 보내고 ack (standby 의 fdatasync) 까지 기다림.
+// standby 가 끊기면 lease 에 degraded 를 표시한 뒤 복제 없이 계속 진행하고 1초에 한 번 다시 붙어봄.
+// 다시 붙으면 이 레코드까지 포함한 로그 전체를 보내므로 따로 보내지 않음.
+// 표시하지 못하면 -1: 이 레코드 (결정일 수 있음) 를 standby 모르게 내보낼 수 없으므로 log 실패와 같이 다룸
+static int replicate(Coordinator *c, const char *buf, size_t len) {
+    int rc = 0;
+    pthread_mutex_lock(&c->repl_mu);
+    if (c->repl_fd < 0) {
+        struct timespec now;
+        env->now(&now);
+        if (now.tv_sec >= c->repl_retry_at) attach_standby(c);
+    } else if (replica_send(c->repl_fd, REPLICA_APPEND, buf, len) < 0) {
+        fprintf(stderr, "[WARNING] Lost standby %s.\n", c->opts.replica_addr);
+        close(c->repl_fd);
+        c->repl_fd = -1;
+        attach_standby(c); // standby 가 재시작했을 수 있으므로 한 번은 바로 시도
+    }
+    if (c->repl_fd < 0 && !c->degraded) rc = mark_degraded(c);
+    pthread_mutex_unlock(&c->repl_mu);
+    return rc;
+}
+
+// 이미 만들어 둔 레코드(여러 줄 가능)를 한 번의 fsync 로 기록. 실패하면 coordinator 를 failed 로 바꾸고 -1.
+// 한 번 실패한 뒤에는 (앞 레코드가 빠졌을 수 있으므로) 이어 쓰지 않음
+static int append_log(Coordinator *c, const char *buf, size_t len) {
+    if (coord_failed(c)) return -1;
+    if (c->ulog) {
+        int rc = ulog_append_sync(c->ulog, buf, len);
+        if (rc < 0) { coord_fail(c, "log append to %s failed: %s", c->log_file, strerror(-rc)); return -1; }
+    } else {
+        pthread_mutex_lock(&c->log_mu);
+        int rc = env->append(c->log_file, buf, len);
+        pthread_mutex_unlock(&c->log_mu);
+        if (rc < 0) { coord_fail(c, "log append to %s failed: %s", c->log_file, strerror(-rc)); return -1; }
+    }
+    env->crash_point("log");
+    if (c->opts.replica_addr && replicate(c, buf, len) < 0) return -1;
+    return 0;
+}
+
+static void log_done(int res, void *arg) {
+    Coordinator *c = arg;
+    if (res < 0) coord_fail(c, "log append to %s failed: %s", c->log_file, strerror(-res));
+}
+
+// 기다릴 필요가 없는 레코드 (COMPLETE / EPOCH_COMPLETE): io_uring backend 면 submit 만 하고 돌아가고
+// 실패는 completion thread 가 coord_fail 로 알림. COMPLETE 가 빠지더라도 recovery 가 결정을 다시 보낼 뿐이라
+// 안전함. fsync backend 면 append_log 와 같음
+static int append_log_nowait(Coordinator *c, const char *buf, size_t len) {
+    int rc;
+    if (!c->ulog) return append_log(c, buf, len);
+    if (coord_failed(c)) return -1;
+    rc = ulog_append(c->ulog, buf, len, log_done, c);
+    if (rc < 0) { coord_fail(c, "log append to %s failed: %s", c->log_file, strerror(-rc)); return -1; }
+    if (c->opts.replica_addr && replicate(c, buf, len) < 0) return -1;
+    return 0;
+}
+
+static int write_complete(Coordinator *c, int txn_id) {
+    uint64_t t0 = trace_now();
+    char line[64];
+    int len = snprintf(line, sizeof(line), "%d COMPLETE\n", txn_id);
+    int rc = append_log_nowait(c, line, len);
+    trace_span(c->ulog ? "log_submit" : "log_fsync", txn_id, cur_trace_id, t0, "COMPLETE");
+    return rc;
+}
+
+static int write_log(Coordinator *c, int txn_id, const char *state) {
+    uint64_t t0 = trace_now();
+    char line[64];
+    int len = snprintf(line, sizeof(line), "%d %s\n", txn_id, state);
+    int rc = append_log(c, line, len);
+    trace_span("log_fsync", txn_id, cur_trace_id, t0, state);
+    return rc;
+}
+
+// 여러 txn 의 같은 상태를 한 번의 fsync 로 기록 (recovery 용)
+static int write_log_batch(Coordinator *c, const int *ids, int n, const char *state) {
+    uint64_t t0 = trace_now();
+    size_t cap = (size_t)n * 32, len = 0;
+    char *buf;
+    int i, rc;
+    if (n <= 0) return 0;
+    buf = malloc(cap);
+    if (!buf) { coord_fail(c, "out of memory writing %d %s record(s)", n, state); return -1; }
+    for (i = 0; i < n; i++)
+        len += snprintf(buf + len, cap - len, "%d %s\n", ids[i], state);
+    rc = append_log(c, buf, len);
+    free(buf);
+    trace_span("log_fsync", ids[0], cur_trace_id, t0, state);
+    return rc;
+}
+
+// epoch 레코드: "E<epoch> EPOCH_START id id ..." / "E<epoch> EPOCH_DECISION C:id A:id ..." /
+// "E<epoch> EPOCH_COMPLETE id id ...". 'E' 로 시작하므로 txn 단위 레코드와 섞여도 구분됨
+static int write_epoch_log(Coordinator *c, int epoch, const char *state, CoordTxn **txns, int n) {
+    uint64_t t0 = trace_now();
+    size_t cap = 64 + (size_t)n * 16, len;
+    char *buf = malloc(cap);
+    int k, rc, complete;
+    if (!buf) { coord_fail(c, "out of memory writing epoch %d %s", epoch, state); return -1; }
+    len = snprintf(buf, cap, "E%d %s", epoch, state);
+    for (k = 0; k < n; k++) {
+        if (strcmp(state, "EPOCH_DECISION") == 0)
+            len += snprintf(buf + len, cap - len, " %c:%d", txns[k]->decision ? 'C' : 'A', txns[k]->txn_id);
+        else
+            len += snprintf(buf + len, cap - len, " %d", txns[k]->txn_id);
+    }
+    len += snprintf(buf + len, cap - len, "\n");
+    complete = strcmp(state, "EPOCH_COMPLETE") == 0;
+    rc = complete ? append_log_nowait(c, buf, len) : append_log(c, buf, len);
+    free(buf);
+    trace_span(complete && c->ulog ? "log_submit" : "log_fsync", epoch, cur_trace_id, t0, state);
+    return rc;
+}
+
+/* ---------- Utility: Log File Reading for Recovery ---------- */
+static int set_record(TxnRecord **records, int *cap, int *record_count, int id, const char *state) {
+    if (id <= 0) return 0;
+    if (id > *cap) {
+        int new_cap = *cap;
+        while (new_cap < id) new_cap *= 2;
+        TxnRecord *grown = realloc(*records, new_cap * sizeof(TxnRecord));
+        if (!grown) { perror("realloc"); return -1; }
+        *records = grown;
+        memset(*records + *cap, 0, (new_cap - *cap) * sizeof(TxnRecord));
+        *cap = new_cap;
+    }
+    TxnRecord *r = &(*records)[id-1];
+    r->txn_id = id;
+    if (strcmp(state, "DECISION_COMMIT") == 0) r->committed = 1;
+    strncpy(r->state, state, 31);
+    r->state[31] = '\0';
+    if (id > *record_count) *record_count = id;
+    return 0;
+}
+
+// epoch 레코드를 txn 별 START / DECISION_* / COMPLETE 로 풀어서 반영
+static int set_epoch_records(TxnRecord **records, int *cap, int *record_count, char *line) {
+    char *save = NULL;
+    char *tok = strtok_r(line, " \n", &save); // E<epoch>
+    const char *kind = strtok_r(NULL, " \n", &save);
+    int rc = 0;
+    if (!tok || !kind) return 0;
+    while (rc == 0 && (tok = strtok_r(NULL, " \n", &save)) != NULL) {
+        if (strcmp(kind, "EPOCH_START") == 0)
+            rc = set_record(records, cap, record_count, atoi(tok), "START");
+        else if (strcmp(kind, "EPOCH_COMPLETE") == 0)
+            rc = set_record(records, cap, record_count, atoi(tok), "COMPLETE");
+        else if (strcmp(kind, "EPOCH_DECISION") == 0 && (tok[0] == 'C' || tok[0] == 'A') && tok[1] == ':')
+            rc = set_record(records, cap, record_count, atoi(tok + 2), tok[0] == 'C' ? "DECISION_COMMIT" : "DECISION_ABORT");
+    }
+    return rc;
+}
+
+// txn_id - 1 을 index 로 마지막 상태를 저장. 배열은 가장 큰 txn_id 에 맞춰 늘어남.
+// 로그가 없으면 NULL + record_count 0, 메모리가 부족하면 NULL + record_count -1
+static TxnRecord *read_all_txn_states(Coordinator *c, int *record_count) {
+    FILE *f = env->open_read(c->log_file);
+    *record_count = 0;
+    if (!f) return NULL;
+
+    int cap = 64, rc = 0;
+    TxnRecord *records = calloc(cap, sizeof(TxnRecord));
+    char *line = NULL;
+    size_t line_cap = 0;
+    int id;
+    char state[32];
+
+    // epoch 레코드는 한 줄이 길 수 있어 getline 사용
+    while (records && rc == 0 && getline(&line, &line_cap, f) > 0) {
+        if (line[0] == 'E') { rc = set_epoch_records(&records, &cap, record_count, line); continue; }
+        if (sscanf(line, "%d %31s", &id, state) != 2 || id <= 0) continue;
+        rc = set_record(&records, &cap, record_count, id, state);
+    }
+    free(line);
+    fclose(f);
+    if (!records || rc < 0) {
+        free(records);
+        *record_count = -1;
+        return NULL;
+    }
+    return records;
+}
+
+/* ---------- Participant Loading ---------- */
+static int load_participants(Coordinator *c) {
+    int i;
+    FILE *f = env->open_read(c->conf_file);
+    if (!f) { perror("fopen participants.conf"); return -1; }
+    c->participant_count = 0;
+
+    // "host prog [limit]": limit 이 없으면 opts.participant_limit
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        Participant *p = &c->participants[c->participant_count];
+        int limit = 0;
+        int n = sscanf(line, "%255s %lx %d", p->host, &p->prog_number, &limit);
+        if (n < 2) continue;
+        p->limit = n == 3 ? limit : c->opts.participant_limit;
+        p->inflight = 0;
+        if (p->limit > 0) c->has_limits = 1;
+        c->participant_count++;
+        if (c->participant_count >= MAX_PARTICIPANTS) break;
+    }
+    fclose(f);
+
+    if (c->participant_count == 0) {
+        fprintf(stderr, "[ERROR] No participants found in %s\n", c->conf_file);
+        return -1;
+    }
+
+    for (i = 0; i < c->participant_count; i++) {
+        c->members[i].host = c->participants[i].host;
+        c->members[i].prog = c->participants[i].prog_number;
+    }
+
+    printf("Loaded %d participants from %s.\n", c->participant_count, c->conf_file);
+    return 0;
+}
+
+/* ---------- Admission Control ---------- */
+// CLOCK_MONOTONIC 은 env 의 시계 (sim 에서는 virtual clock)
+static void timespec_after_ms(clockid_t clk, struct timespec *ts, int ms) {
+    if (clk == CLOCK_MONOTONIC) env->now(ts);
+    else clock_gettime(clk, ts);
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) { ts->tv_sec++; ts->tv_nsec -= 1000000000L; }
+}
+
+static long elapsed_since_ms(const struct timespec *since) {
+    struct timespec now;
+    env->now(&now);
+    return (now.tv_sec - since->tv_sec) * 1000L + (now.tv_nsec - since->tv_nsec) / 1000000L;
+}
+
+static int txn_expired(const CoordTxn *t) {
+    struct timespec now;
+    if (!t->has_deadline) return 0;
+    env->now(&now);
+    return now.tv_sec > t->deadline.tv_sec ||
+           (now.tv_sec == t->deadline.tv_sec && now.tv_nsec >= t->deadline.tv_nsec);
+}
+
+// participant 마다 동시에 진행 중인 txn 수를 limit 으로 제한. 모든 txn 이 index 순서로 잡으므로 deadlock 없음.
+// deadline 까지 자리가 나지 않으면 잡았던 slot 을 돌려놓고 0
+static int acquire_slots(Coordinator *c, const struct timespec *deadline) {
+    int i, j;
+    if (!c->has_limits) return 1;
+    pthread_mutex_lock(&c->slot_mu);
+    for (i = 0; i < c->participant_count; i++) {
+        Participant *p = &c->participants[i];
+        while (p->limit > 0 && p->inflight >= p->limit) {
+            int rc = deadline ? pthread_cond_timedwait(&c->slot_cv, &c->slot_mu, deadline)
+                              : pthread_cond_wait(&c->slot_cv, &c->slot_mu);
+            if (rc == ETIMEDOUT) {
+                for (j = 0; j < i; j++) c->participants[j].inflight--;
+                pthread_cond_broadcast(&c->slot_cv);
+                pthread_mutex_unlock(&c->slot_mu);
+                return 0;
+            }
+        }
+        p->inflight++;
+    }
+    pthread_mutex_unlock(&c->slot_mu);
+    return 1;
+}
+
+static void release_slots(Coordinator *c) {
+    int i;
+    if (!c->has_limits) return;
+    pthread_mutex_lock(&c->slot_mu);
+    for (i = 0; i < c->participant_count; i++) c->participants[i].inflight--;
+    pthread_cond_broadcast(&c->slot_cv);
+    pthread_mutex_unlock(&c->slot_mu);
+}
+
+/* ---------- RPC Calls ---------- */
+// rpcgen stub(prepare_1 등)은 static 결과 버퍼를 공유하므로 worker thread 에서는 clnt_call 을 직접 사용
+// proc: PREPARE 또는 PREPARE_COMMIT (one-phase / last agent).
+// NO 의 이유는 info (MAX_INFO + 1) 에 decode 되므로 res 는 xdr_free 할 필요 없음
+// participant 가 VOTE_RETRY (wait-die 로 lock 대기 중) 를 주면 1ms 부터 두 배씩 (최대 64ms) 쉬고 같은 PREPARE 를 다시 보냄.
+// txn deadline (없으면 PREPARE_RETRY_MS) 까지 못 받으면 포기: PREPARE 는 NO 로,
+// PREPARE_COMMIT 은 결과를 모르는 것으로 (RPC_TIMEDOUT) 돌려서 last agent 쪽 fence 로 정리되게 함
+static enum clnt_stat prepare_rpc(CoordTxn *t, CLIENT *clnt, rpcproc_t proc, PrepareResult *res, char *info) {
+    PrepareArgs arg;
+    enum clnt_stat st;
+    struct timespec start;
+    int delay_ms = 1;
+
+    env->now(&start);
+    memset(&arg, 0, sizeof(arg));
+    arg.txn_id = t->txn_id;
+    arg.trace_id = t->trace_id;
+    arg.span_id = trace_new_id();
+    arg.locks.locks_len = t->lock_count;
+    arg.locks.locks_val = t->locks;
+    memset(res, 0, sizeof(*res));
+    info[0] = '\0';
+    res->PrepareResult_u.info = info;
+    for (;;) {
+        trace_flow_start(arg.span_id, t->txn_id, t->trace_id);
+        st = clnt_call(clnt, proc,
+                       (xdrproc_t) xdr_PrepareArgs_fast, (caddr_t) &arg,
+                       (xdrproc_t) xdr_PrepareResult, (caddr_t) res,
+                       TIMEOUT);
+        if (st != RPC_SUCCESS || res->ok != VOTE_RETRY) return st;
+
+        if (t->has_deadline ? txn_expired(t) : elapsed_since_ms(&start) >= PREPARE_RETRY_MS) {
+            fprintf(stderr, "[TXN_ABORT] Txn %d: gave up waiting for a lock (wait-die).\n", t->txn_id);
+            if (proc == PREPARE_COMMIT) return RPC_TIMEDOUT;
+            res->ok = 0;
+            snprintf(info, MAX_INFO + 1, "Lock wait gave up");
+            return RPC_SUCCESS;
+        }
+        env->sleep_ms(delay_ms);
+        if (delay_ms < 64) delay_ms *= 2;
+        arg.span_id = trace_new_id();
+    }
+}
+
+static int decision_rpc(int txn_id, int decision, CLIENT *clnt) {
+    TxnID arg;
+    int ack = 0;
+    arg.txn_id = txn_id;
+    arg.trace_id = cur_trace_id;
+    arg.span_id = trace_new_id();
+    trace_flow_start(arg.span_id, txn_id, cur_trace_id);
+    return clnt_call(clnt, decision ? COMMIT : ABORT,
+                     (xdrproc_t) xdr_TxnID_fast, (caddr_t) &arg,
+                     (xdrproc_t) xdr_int, (caddr_t) &ack,
+                     TIMEOUT) == RPC_SUCCESS;
+}
+
+// 결정을 맡긴 마지막 participant (last agent) 의 결과 확인: 1 = COMMIT, 0 = ABORT, -1 = 알 수 없음.
+// 먼저 ABORT fence 를 보내 (이미 결정한 txn 은 participant 가 건너뜀) 늦게 도착한 PREPARE_COMMIT 이
+// 이후에 COMMIT 하지 못하게 막고, 그 다음 STATUS 로 최종 상태를 물어봄
+static int last_agent_outcome(CLIENT *clnt, int txn_id) {
+    DecisionBatch fence;
+    TxnID arg;
+    int ack = 0, status = 0;
+
+    memset(&fence, 0, sizeof(fence));
+    fence.abort_ids.abort_ids_len = 1;
+    fence.abort_ids.abort_ids_val = &txn_id;
+    fence.trace_id = cur_trace_id;
+    if (clnt_call(clnt, DECIDE_BATCH, (xdrproc_t) xdr_DecisionBatch, (caddr_t) &fence,
+                  (xdrproc_t) xdr_int, (caddr_t) &ack, TIMEOUT) != RPC_SUCCESS)
+        return -1;
+
+    memset(&arg, 0, sizeof(arg));
+    arg.txn_id = txn_id;
+    arg.trace_id = cur_trace_id;
+    if (clnt_call(clnt, STATUS, (xdrproc_t) xdr_TxnID_fast, (caddr_t) &arg,
+                  (xdrproc_t) xdr_int, (caddr_t) &status, TIMEOUT) != RPC_SUCCESS)
+        return -1;
+    return status == 1;
+}
+
+/* ---------- Connection Helper ---------- */
+static CLIENT *connect_to_participant_proto(Coordinator *c, int i, const char *proto) {
+    int attempts = 0; const int max_attempts = 10; const int retry_delay_sec = 1;
+    CLIENT *clnt = NULL;
+    Participant *p = &c->participants[i];
+
+    while (clnt == NULL && attempts < max_attempts) {
+        if (attempts > 0) {
+            fprintf(stderr, "[RETRY] P%d connection failed. Retrying in %d sec (Attempt %d/%d)...\n",
+                             i+1, retry_delay_sec, attempts + 1, max_attempts);
+            env->sleep_ms(retry_delay_sec * 1000);
+        }
+        clnt = env->connect(p->host, p->prog_number, COMMIT_VERS, proto);
+        if (clnt) {
+             clnt_control(clnt, CLSET_TIMEOUT, (char *)&TIMEOUT);
+        }
+        attempts++;
+    }
+
+    if (!clnt) {
+        fprintf(stderr, "[ERROR] Connect FAILED to P%d (Prog: 0x%lx) after %d attempts. RPC Error: %s\n",
+                         i+1, p->prog_number, max_attempts, clnt_spcreateerror("clnt_create"));
+    } else {
+        fprintf(stderr, "[DEBUG] Connect SUCCESS to P%d (Prog: 0x%lx) after %d attempt(s)\n",
+                         i+1, p->prog_number, attempts);
+    }
+    return clnt;
+}
+
+static CLIENT *connect_to_participant(Coordinator *c, int i) {
+    return connect_to_participant_proto(c, i, "udp");
+}
+
+/* ---------- Notify Helper ---------- */
+// skip: 스스로 결정한 last agent (없으면 -1)
+static void notify_participants(Coordinator *c, int txn_id, int decision, int skip) {
+    int i;
+    char peer[16];
+    for (i = 0; i < c->participant_count; i++) {
+        if (i == skip) continue;
+        uint64_t t0 = trace_now();
+        snprintf(peer, sizeof(peer), "P%d", i+1);
+        CLIENT *clnt = connect_to_participant(c, i);
+        if (!clnt) {
+            fprintf(stderr, "[WARNING] Cannot notify P%d of decision. Recovery needed.\n", i+1);
+            trace_span("notify", txn_id, cur_trace_id, t0, "connect failed");
+            continue;
+        }
+
+        if (decision) {
+            // 명세: maybe_fail("after_commit")은 COMMIT 통지 루프 안에 있어야 함.
+            maybe_fail(c, "after_commit"); // COMMIT 통지 직전
+        }
+        decision_rpc(txn_id, decision, clnt);
+        clnt_destroy(clnt);
+        trace_span("notify", txn_id, cur_trace_id, t0, peer);
+    }
+}
+
+/* ---------- Recovery Logic ---------- */
+// participant 하나의 in-doubt 목록을 받아, 그 txn 들에 대해서만 결정을 batch 로 보냄.
+// coordinator 로그에 DECISION_COMMIT 이 있으면 COMMIT, 없으면 (START 만 / 기록 없음) ABORT (presumed abort)
+// IN_DOUBT 를 모르는 participant (이 commit.x 이전 빌드) 와는 복구하지 않음: 같은 프로그램의 새 버전과 함께 띄워야 함
+static void recover_participant(Coordinator *c, int i, const TxnRecord *records, int max_id,
+                                const int *start_only, int n_start) {
+    static int commit_ids[MAX_INDOUBT], abort_ids[MAX_INDOUBT];
+    CLIENT *clnt = connect_to_participant(c, i);
+    int after = 0, total = 0, sent_commit = 0, sent_abort = 0;
+    uint64_t t0 = trace_now();
+    char peer[16];
+
+    snprintf(peer, sizeof(peer), "P%d", i+1);
+    if (!clnt) {
+        fprintf(stderr, "[WARNING] Cannot query P%d for in-doubt transactions. Recovery needed.\n", i+1);
+        trace_span("indoubt_query", 0, cur_trace_id, t0, "connect failed");
+        return;
+    }
+
+    for (;;) {
+        InDoubtList list;
+        DecisionBatch batch;
+        int ack = 0;
+        u_int k;
+        enum clnt_stat st;
+
+        memset(&list, 0, sizeof(list));
+        st = clnt_call(clnt, IN_DOUBT, (xdrproc_t) xdr_int, (caddr_t) &after,
+                       (xdrproc_t) xdr_InDoubtList, (caddr_t) &list, TIMEOUT);
+        if (st == RPC_PROCUNAVAIL) {
+            fprintf(stderr, "[WARNING] P%d does not support IN_DOUBT (older participant). Recovery needed.\n", i+1);
+            break;
+        }
+        if (st != RPC_SUCCESS) {
+            fprintf(stderr, "[WARNING] IN_DOUBT to P%d failed (%s). Recovery needed.\n", i+1, clnt_sperrno(st));
+            break;
+        }
+
+        memset(&batch, 0, sizeof(batch));
+        batch.commit_ids.commit_ids_val = commit_ids;
+        batch.abort_ids.abort_ids_val = abort_ids;
+        for (k = 0; k < list.txn_ids.txn_ids_len; k++) {
+            int id = list.txn_ids.txn_ids_val[k];
+            after = id;
+            // last agent 의 결정을 아직 모름: COMMIT 됐을 수 있으므로 in-doubt 로 남김
+            if (id >= 1 && id <= max_id && strncmp(records[id-1].state, "LAST_AGENT", 10) == 0)
+                continue;
+            if (id >= 1 && id <= max_id && records[id-1].committed)
+                commit_ids[batch.commit_ids.commit_ids_len++] = id;
+            else
+                abort_ids[batch.abort_ids.abort_ids_len++] = id;
+        }
+        total += list.txn_ids.txn_ids_len;
+        int more = list.more && list.txn_ids.txn_ids_len > 0;
+        xdr_free((xdrproc_t) xdr_InDoubtList, (char *) &list);
+
+        if (batch.commit_ids.commit_ids_len + batch.abort_ids.abort_ids_len > 0) {
+            if (batch.commit_ids.commit_ids_len > 0) maybe_fail(c, "after_commit");
+            batch.trace_id = cur_trace_id;
+            batch.span_id = trace_new_id();
+            trace_flow_start(batch.span_id, 0, cur_trace_id);
+            if (clnt_call(clnt, DECIDE_BATCH, (xdrproc_t) xdr_DecisionBatch, (caddr_t) &batch,
+                          (xdrproc_t) xdr_int, (caddr_t) &ack, TIMEOUT) != RPC_SUCCESS) {
+                fprintf(stderr, "[WARNING] DECIDE_BATCH to P%d failed. Recovery needed.\n", i+1);
+                break;
+            }
+            sent_commit += batch.commit_ids.commit_ids_len;
+            sent_abort += batch.abort_ids.abort_ids_len;
+        }
+        if (!more) {
+            // 복구 중 ABORT 로 정한 txn 은 PREPARE 를 아직 못 받은 participant 에게도 ABORT 를 남김.
+            // 늦게 도착한 PREPARE 가 이전 ABORT 로그를 보고 NO 로 투표하게 됨 (이미 결정된 txn 은 participant 가 건너뜀)
+            if (n_start > 0) {
+                memset(&batch, 0, sizeof(batch));
+                batch.abort_ids.abort_ids_len = n_start;
+                batch.abort_ids.abort_ids_val = (int *) start_only;
+                batch.trace_id = cur_trace_id;
+                if (clnt_call(clnt, DECIDE_BATCH, (xdrproc_t) xdr_DecisionBatch, (caddr_t) &batch,
+                              (xdrproc_t) xdr_int, (caddr_t) &ack, TIMEOUT) != RPC_SUCCESS)
+                    fprintf(stderr, "[WARNING] DECIDE_BATCH (abort fence) to P%d failed.\n", i+1);
+            }
+            break;
+        }
+    }
+    clnt_destroy(clnt);
+
+    printf("[RECOVERY] P%d: %d in-doubt txn(s), sent %d COMMIT / %d ABORT in batch\n",
+           i+1, total, sent_commit, sent_abort);
+    trace_span("indoubt_query", 0, cur_trace_id, t0, peer);
+}
+
+// 마지막 레코드가 LAST_AGENT:<p> 인 txn 은 participant p 가 결정을 내렸음 (PREPARE_COMMIT).
+// p 에게 결과를 물어 DECISION_* 로 기록해 두면 아래에서 일반 txn 처럼 재전송 + COMPLETE 됨.
+// (COMPLETE 뒤에도 다음 recovery 가 in-doubt participant 에게 같은 결정을 보낼 수 있도록 결정을 로그에 남김)
+static int resolve_last_agents(Coordinator *c, TxnRecord *records, int max_id) {
+    CLIENT **clnts = calloc(c->participant_count, sizeof(CLIENT *));
+    char *tried = calloc(c->participant_count, 1);
+    int *commit_ids = malloc(max_id * sizeof(int)), *abort_ids = malloc(max_id * sizeof(int));
+    int n_commit = 0, n_abort = 0, rc = -1;
+    int i, p;
+
+    if (!clnts || !tried || !commit_ids || !abort_ids) {
+        coord_fail(c, "out of memory during recovery");
+        max_id = 0;
+    }
+    for (i = 0; i < max_id; i++) {
+        int txn_id = records[i].txn_id, decision = -1;
+        if (txn_id == 0 || sscanf(records[i].state, "LAST_AGENT:%d", &p) != 1) continue;
+
+        if (p >= 1 && p <= c->participant_count) {
+            if (!tried[p-1]) { clnts[p-1] = connect_to_participant(c, p-1); tried[p-1] = 1; }
+            if (clnts[p-1]) decision = last_agent_outcome(clnts[p-1], txn_id);
+        }
+        if (decision < 0) {
+            fprintf(stderr, "[WARNING] Txn %d: cannot get the decision of last agent P%d. Leaving it in doubt.\n", txn_id, p);
+            continue;
+        }
+        printf("[RECOVERY] Txn %d: last agent P%d decided %s. Resending...\n", txn_id, p, decision ? "COMMIT" : "ABORT");
+        strcpy(records[i].state, decision ? "DECISION_COMMIT" : "DECISION_ABORT");
+        records[i].committed = decision;
+        if (decision) commit_ids[n_commit++] = txn_id; else abort_ids[n_abort++] = txn_id;
+    }
+    if (max_id > 0 && write_log_batch(c, commit_ids, n_commit, "DECISION_COMMIT") == 0 &&
+        write_log_batch(c, abort_ids, n_abort, "DECISION_ABORT") == 0)
+        rc = 0;
+
+    for (i = 0; clnts && i < c->participant_count; i++)
+        if (clnts[i]) clnt_destroy(clnts[i]);
+    free(clnts);
+    free(tried);
+    free(commit_ids);
+    free(abort_ids);
+    return rc;
+}
+
+static double elapsed_ms(const struct timespec *since) {
+    struct timespec now;
+    env->now(&now);
+    return (now.tv_sec - since->tv_sec) * 1e3 + (now.tv_nsec - since->tv_nsec) / 1e6;
+}
+
+// 로그를 읽거나 쓰지 못하면 -1 (coord_open 실패)
+static int run_recovery(Coordinator *c) {
+    struct timespec started;
+    env->now(&started);
+    int max_id = 0;
+    TxnRecord *records = read_all_txn_states(c, &max_id);
+    double scan_ms = elapsed_ms(&started);
+    int *start_only, *unresolved;
+    int n_start = 0, n_unresolved = 0, rc = -1;
+    uint64_t t0;
+    int i;
+
+    if (max_id < 0) {
+        fprintf(stderr, "[ERROR] Out of memory reading %s\n", c->log_file);
+        return -1;
+    }
+    printf("Starting Coordinator Recovery: Scanning %d transaction logs...\n", max_id);
+
+    if (!records) return 0;
+    if (max_id == 0) { free(records); return 0; }
+
+    cur_trace_id = trace_new_id();
+    t0 = trace_now();
+    start_only = malloc(max_id * sizeof(int));
+    unresolved = malloc(max_id * sizeof(int));
+    if (!start_only || !unresolved || resolve_last_agents(c, records, max_id) < 0) {
+        if (!start_only || !unresolved) fprintf(stderr, "[ERROR] Out of memory during recovery\n");
+        free(start_only);
+        free(unresolved);
+        free(records);
+        return -1;
+    }
+
+    // 1. coordinator 로그 정리: START 만 있으면 ABORT 로 결정, DECISION 만 있으면 재전송 대상
+    for (i = 0; i < max_id; i++) {
+        int txn_id = records[i].txn_id;
+        const char *state = records[i].state;
+
+        if (txn_id == 0) continue;
+        if (strstr(state, "DECISION") != NULL) {
+            printf("[RECOVERY] Txn %d: Found DECISION (%s) but no COMPLETE. Resending...\n", txn_id, state);
+            unresolved[n_unresolved++] = txn_id;
+        } else if (strcmp(state, "START") == 0) {
+            printf("[RECOVERY] Txn %d: Found START but no DECISION. Deciding ABORT...\n", txn_id);
+            start_only[n_start++] = txn_id;
+            unresolved[n_unresolved++] = txn_id;
+        }
+
+        if (txn_id >= c->next_txn_id) {
+            c->next_txn_id = txn_id + 1;
+        }
+    }
+    if (write_log_batch(c, start_only, n_start, "DECISION_ABORT") == 0) {
+        // 2. participant 마다 in-doubt 목록을 한 번에 받아 필요한 결정만 batch 로 전달.
+        //    coordinator 가 COMPLETE 를 쓴 뒤에도 결정을 못 받은 participant 가 여기서 정리됨
+        for (i = 0; i < c->participant_count; i++)
+            recover_participant(c, i, records, max_id, start_only, n_start);
+
+        // 3. 한 번의 fsync 로 COMPLETE
+        if (write_log_batch(c, unresolved, n_unresolved, "COMPLETE") == 0) {
+            for (i = 0; i < n_unresolved; i++)
+                printf("[RECOVERY] Txn %d: Recovered successfully.\n", unresolved[i]);
+            rc = 0;
+        }
+    }
+    trace_span("recovery", 0, cur_trace_id, t0, NULL);
+
+    free(start_only);
+    free(unresolved);
+    free(records);
+    if (rc < 0) return rc;
+    // test/bench_recovery.sh 가 이 줄의 시간을 읽음
+    printf("Recovery finished. Next transaction ID: %d (log scan %.3f ms, total %.3f ms)\n",
+           c->next_txn_id, scan_ms, elapsed_ms(&started));
+    return 0;
+}
+
+/* ---------- Transaction Handling (tree mode) ---------- */
+// coordinator 는 fanout 개의 subtree root 하고만 통신하고, 투표 취합과 결정 전달은 root 들이 맡음
+static int handle_transaction_tree(CoordTxn *t) {
+    Coordinator *c = t->coord;
+    PrepareArgs arg;
+    char why[256] = "";
+    int decision;
+    uint64_t t0;
+
+    if (txn_expired(t)) {
+        fprintf(stderr, "[TXN_ABORT] Txn %d: deadline passed before PREPARE. DECISION=ABORT.\n", t->txn_id);
+        return 0;
+    }
+    if (write_log(c, t->txn_id, "START") < 0) return 0;
+
+    memset(&arg, 0, sizeof(arg));
+    arg.txn_id = t->txn_id;
+    arg.trace_id = t->trace_id;
+    arg.locks.locks_len = t->lock_count;
+    arg.locks.locks_val = t->locks;
+    arg.fanout = c->opts.tree_fanout;
+    t0 = trace_now();
+    decision = tree_prepare(&arg, c->members, c->participant_count, why, sizeof(why));
+    trace_span("prepare_tree", t->txn_id, t->trace_id, t0, decision ? "YES" : "NO");
+
+    maybe_fail(c, "after_prepare");
+    if (!decision)
+        fprintf(stderr, "[TXN_ABORT] Txn %d: subtree voted NO or did not respond (%s). DECISION=ABORT.\n",
+                         t->txn_id, why);
+
+    t0 = trace_now();
+    if (write_log(c, t->txn_id, decision ? "DECISION_COMMIT" : "DECISION_ABORT") < 0 && decision)
+        return COORD_DECISION_UNKNOWN; // DECISION_COMMIT 이 디스크에 남았는지 모름: 알리지 않고 재시작 recovery 에 맡김
+    trace_span("decision", t->txn_id, t->trace_id, t0, decision ? "COMMIT" : "ABORT");
+
+    if (decision) maybe_fail(c, "after_commit");
+    t0 = trace_now();
+    tree_decide(t->txn_id, decision, c->members, c->participant_count, c->opts.tree_fanout, t->trace_id);
+    trace_span("notify_tree", t->txn_id, t->trace_id, t0, NULL);
+
+    write_complete(c, t->txn_id);
+    return decision;
+}
+
+/* ---------- Transaction Handling ---------- */
+static void close_clients(Coordinator *c, CLIENT **clnts) {
+    int i;
+    for (i = 0; i < c->participant_count; i++)
+        if (clnts[i]) clnt_destroy(clnts[i]);
+    free(clnts);
+}
+
+static int handle_transaction(CoordTxn *t) {
+    Coordinator *c = t->coord;
+    int txn_id = t->txn_id;
+    int decision = 1; // 1: COMMIT, 0: ABORT
+    int last = -1;    // one_phase: PREPARE 대신 PREPARE_COMMIT 을 받을 마지막 participant
+    int agent = -1;   // 실제로 PREPARE_COMMIT 을 보낸 participant (스스로 결정했으므로 통지하지 않음)
+    CLIENT **clnts;
+    PrepareResult res;
+    char info[MAX_INFO + 1];
+    char peer[24];
+    uint64_t t0;
+    int i;
+
+    if (c->opts.tree_fanout > 0)
+        return handle_transaction_tree(t);
+
+    clnts = calloc(c->participant_count, sizeof(CLIENT *));
+    if (!clnts) { perror("calloc"); return 0; } // 아무것도 보내지 않았으므로 ABORT
+
+    // 참가자 연결은 Phase 1 시작 전에 한 번만 시도
+    for (i = 0; i < c->participant_count; i++) {
+        t0 = trace_now();
+        clnts[i] = connect_to_participant(c, i);
+        snprintf(peer, sizeof(peer), "P%d", i+1);
+        trace_span("connect", txn_id, t->trace_id, t0, peer);
+        // 연결 실패 시 ABORT 결정은 하지만, PREPARE를 보내기 전에 fail_fast 하지 않음
+        if (!clnts[i]) {
+            decision = 0;
+            fprintf(stderr, "[TXN_ERROR] P%d not connected. DECISION=ABORT.\n", i+1);
+        }
+    }
+
+    // 연결 재시도 동안 deadline 이 지났으면 participant 에게 아무것도 보내지 않고 ABORT (로그 불필요)
+    if (txn_expired(t)) {
+        fprintf(stderr, "[TXN_ABORT] Txn %d: deadline passed before PREPARE. DECISION=ABORT.\n", txn_id);
+        close_clients(c, clnts);
+        return 0;
+    }
+
+    if (c->opts.one_phase && decision) last = c->participant_count - 1;
+
+    // participant 가 하나뿐이면 START 없이 바로 LAST_AGENT 레코드로 시작
+    if (last != 0 && write_log(c, txn_id, "START") < 0) {
+        close_clients(c, clnts);
+        return 0;
+    }
+
+    // Phase 1: Prepare
+    for (i = 0; i < c->participant_count && i != last; i++) {
+        if (!clnts[i]) continue;
+        if (decision && txn_expired(t)) {
+            fprintf(stderr, "[TXN_ABORT] Txn %d: deadline passed before PREPARE to P%d. DECISION=ABORT.\n", txn_id, i+1);
+            decision = 0;
+            break;
+        }
+
+        t0 = trace_now();
+        int ok = prepare_rpc(t, clnts[i], PREPARE, &res, info) == RPC_SUCCESS;
+        snprintf(peer, sizeof(peer), "P%d %s", i+1, !ok ? "timeout" : res.ok ? "YES" : "NO");
+        trace_span("prepare", txn_id, t->trace_id, t0, peer);
+
+        // 명세: send PREPARE 직후 maybe_fail("after_prepare")
+        maybe_fail(c, "after_prepare");
+
+        // 명세: if no reply or VOTE_ABORT received: decision = ABORT, break
+        if (!ok || res.ok == 0) {
+            if (!ok) {
+                fprintf(stderr, "[TXN_ERROR] P%d (0x%lx) failed to respond to PREPARE (Timeout/RPC error)\n",
+                                 i+1, c->participants[i].prog_number);
+            } else {
+                fprintf(stderr, "[TXN_ABORT] P%d (0x%lx) voted NO (Result: %s). DECISION=ABORT.\n",
+                                 i+1, c->participants[i].prog_number, info);
+            }
+            decision = 0;
+            break;
+        }
+    }
+
+    // Last agent: 나머지가 모두 YES 면 PREPARE 와 결정을 합친 PREPARE_COMMIT 을 보내고 그 participant 의 결정을 따름.
+    // LAST_AGENT 레코드가 먼저 기록되어야 재시작 recovery 가 START 만 보고 ABORT 로 정하지 않고 STATUS 를 물어봄
+    if (last >= 0 && decision && txn_expired(t)) {
+        fprintf(stderr, "[TXN_ABORT] Txn %d: deadline passed before PREPARE_COMMIT to P%d. DECISION=ABORT.\n", txn_id, last+1);
+        decision = 0;
+    }
+    if (last >= 0 && decision) {
+        char state[32];
+        snprintf(state, sizeof(state), "LAST_AGENT:%d", last+1);
+        // 기록하지 못했으면 PREPARE_COMMIT 을 보내지 않고 ABORT
+        if (write_log(c, txn_id, state) < 0) decision = 0;
+    }
+    if (last >= 0 && decision) {
+        enum clnt_stat st;
+
+        agent = last;
+
+        t0 = trace_now();
+        st = prepare_rpc(t, clnts[last], PREPARE_COMMIT, &res, info);
+        if (st == RPC_SUCCESS) {
+            decision = res.ok;
+            if (!res.ok)
+                fprintf(stderr, "[TXN_ABORT] Last agent P%d (0x%lx) decided ABORT (Result: %s).\n",
+                                 last+1, c->participants[last].prog_number, info);
+        } else {
+            fprintf(stderr, "[TXN_ERROR] Last agent P%d (0x%lx) failed to respond to PREPARE_COMMIT (%s). Asking for its decision...\n",
+                             last+1, c->participants[last].prog_number, clnt_sperrno(st));
+            decision = last_agent_outcome(clnts[last], txn_id);
+        }
+        snprintf(peer, sizeof(peer), "P%d %s", last+1, decision < 0 ? "unknown" : decision ? "COMMIT" : "ABORT");
+        trace_span("prepare_commit", txn_id, t->trace_id, t0, peer);
+
+        maybe_fail(c, "after_prepare");
+
+        // 결과를 모르면 다른 participant 들을 PREPARED 로 둔 채 recovery 에 맡김 (LAST_AGENT 가 마지막 레코드)
+        if (decision < 0) {
+            fprintf(stderr, "[WARNING] Txn %d: decision of last agent P%d unknown. Recovery needed.\n", txn_id, last+1);
+            close_clients(c, clnts);
+            return COORD_DECISION_UNKNOWN;
+        }
+    }
+
+    if (agent >= 0 && c->participant_count == 1) {
+        // one-phase: 알릴 participant 가 없으므로 결정과 COMPLETE 를 한 번의 fsync 로 기록
+        char buf[96];
+        int len = snprintf(buf, sizeof(buf), "%d %s\n%d COMPLETE\n",
+                           txn_id, decision ? "DECISION_COMMIT" : "DECISION_ABORT", txn_id);
+        t0 = trace_now();
+        if (append_log(c, buf, len) < 0 && decision) {
+            // LAST_AGENT 가 마지막 레코드로 남음: COMMIT 으로 알리지 않고 재시작 recovery 가 STATUS 로 확인하게 함
+            close_clients(c, clnts);
+            return COORD_DECISION_UNKNOWN;
+        }
+        trace_span("decision", txn_id, t->trace_id, t0, decision ? "COMMIT" : "ABORT");
+    } else {
+        t0 = trace_now();
+        if (write_log(c, txn_id, decision ? "DECISION_COMMIT" : "DECISION_ABORT") < 0 && decision) {
+            // DECISION_COMMIT 이 디스크에 남았는지 모름: COMMIT 을 알리지 않고 재시작 recovery 에 맡김
+            close_clients(c, clnts);
+            return COORD_DECISION_UNKNOWN;
+        }
+        trace_span("decision", txn_id, t->trace_id, t0, decision ? "COMMIT" : "ABORT");
+
+        // Phase 2: Commit/Abort - maybe_fail("after_commit")은 notify_participants 내에서 호출됨.
+        notify_participants(c, txn_id, decision, agent);
+
+        write_complete(c, txn_id);
+    }
+
+    close_clients(c, clnts);
+    return decision;
+}
+
+/* ---------- Transaction Handling (epoch mode) ---------- */
+// epoch 에 모인 txn 들을 participant 마다 PREPARE_EPOCH 한 번, DECIDE_BATCH 한 번으로 처리.
+// coordinator 로그도 epoch 당 START / DECISION / COMPLETE 레코드 하나씩.
+// PREPARE_EPOCH 는 UDP datagram 하나를 넘을 수 있어 tcp 로 연결. 연결 중 deadline 이 지난 txn 은 txns 에서 빠짐
+static void handle_epoch(Coordinator *c, CoordTxn **txns, int n) {
+    static __thread EpochTxn ets[MAX_EPOCH_TXNS];
+    static __thread int commit_ids[MAX_EPOCH_TXNS], abort_ids[MAX_EPOCH_TXNS];
+    PrepareEpochArgs arg;
+    DecisionBatch batch;
+    CLIENT **clnts;
+    char peer[16];
+    uint64_t t0;
+    int i, k, epoch, live = 0, any_yes = 1;
+
+    clnts = calloc(c->participant_count, sizeof(CLIENT *));
+    if (!clnts) {
+        perror("calloc");
+        for (k = 0; k < n; k++) txns[k]->decision = 0;
+        return;
+    }
+
+    for (i = 0; i < c->participant_count; i++) {
+        clnts[i] = connect_to_participant_proto(c, i, "tcp");
+        if (!clnts[i]) {
+            fprintf(stderr, "[TXN_ERROR] P%d not connected. Epoch %d: DECISION=ABORT for all %d txn(s).\n", i+1, txns[0]->txn_id, n);
+            any_yes = 0;
+        }
+    }
+
+    // 연결 재시도 동안 deadline 이 지난 txn 은 participant 에게 보내지 않고 ABORT (로그 불필요, flat mode 와 같음)
+    for (k = 0; k < n; k++) {
+        if (txn_expired(txns[k])) {
+            fprintf(stderr, "[TXN_ABORT] Txn %d: deadline passed before PREPARE. DECISION=ABORT.\n", txns[k]->txn_id);
+            txns[k]->decision = 0;
+        } else {
+            txns[live++] = txns[k];
+        }
+    }
+    n = live;
+    if (n == 0) {
+        close_clients(c, clnts);
+        return;
+    }
+    epoch = txns[0]->txn_id;
+
+    memset(&arg, 0, sizeof(arg));
+    arg.epoch_id = epoch;
+    arg.trace_id = cur_trace_id;
+    arg.txns.txns_len = n;
+    arg.txns.txns_val = ets;
+    for (k = 0; k < n; k++) {
+        ets[k].txn_id = txns[k]->txn_id;
+        ets[k].locks.locks_len = txns[k]->lock_count;
+        ets[k].locks.locks_val = txns[k]->locks;
+        txns[k]->decision = any_yes;
+    }
+
+    if (write_epoch_log(c, epoch, "EPOCH_START", txns, n) < 0) {
+        for (k = 0; k < n; k++) txns[k]->decision = 0;
+        close_clients(c, clnts);
+        return;
+    }
+
+    // Phase 1: participant 마다 epoch 전체를 한 번에 PREPARE, 투표는 txn 별 AND
+    for (i = 0; i < c->participant_count && any_yes; i++) {
+        EpochVotes res;
+        if (!clnts[i]) continue;
+
+        memset(&res, 0, sizeof(res));
+        arg.span_id = trace_new_id();
+        trace_flow_start(arg.span_id, epoch, cur_trace_id);
+        t0 = trace_now();
+        int ok = clnt_call(clnts[i], PREPARE_EPOCH,
+                           (xdrproc_t) xdr_PrepareEpochArgs, (caddr_t) &arg,
+                           (xdrproc_t) xdr_EpochVotes, (caddr_t) &res, TIMEOUT) == RPC_SUCCESS;
+        snprintf(peer, sizeof(peer), "P%d", i+1);
+        trace_span("prepare_epoch", epoch, cur_trace_id, t0, peer);
+
+        maybe_fail(c, "after_prepare");
+
+        if (!ok || res.votes.votes_len != (u_int) n) {
+            fprintf(stderr, "[TXN_ERROR] P%d (0x%lx) failed to respond to PREPARE_EPOCH %d. DECISION=ABORT for the epoch.\n",
+                             i+1, c->participants[i].prog_number, epoch);
+            for (k = 0; k < n; k++) txns[k]->decision = 0;
+        } else {
+            for (k = 0; k < n; k++)
+                if (!res.votes.votes_val[k]) txns[k]->decision = 0;
+        }
+        if (ok) xdr_free((xdrproc_t) xdr_EpochVotes, (char *) &res);
+
+        any_yes = 0;
+        for (k = 0; k < n; k++) any_yes |= txns[k]->decision;
+    }
+
+    // DECISION 을 쓰지 못하면 COMMIT 이 디스크에 남았는지 모르므로 그 txn 들은 알리지 않고 재시작 recovery 에 맡김
+    if (write_epoch_log(c, epoch, "EPOCH_DECISION", txns, n) < 0)
+        for (k = 0; k < n; k++)
+            if (txns[k]->decision) txns[k]->decision = COORD_DECISION_UNKNOWN;
+
+    // Phase 2: participant 마다 결정 한 번
+    memset(&batch, 0, sizeof(batch));
+    batch.trace_id = cur_trace_id;
+    batch.commit_ids.commit_ids_val = commit_ids;
+    batch.abort_ids.abort_ids_val = abort_ids;
+    for (k = 0; k < n; k++) {
+        if (txns[k]->decision == 1) commit_ids[batch.commit_ids.commit_ids_len++] = txns[k]->txn_id;
+        else if (txns[k]->decision == 0) abort_ids[batch.abort_ids.abort_ids_len++] = txns[k]->txn_id;
+    }
+    for (i = 0; i < c->participant_count; i++) {
+        int ack = 0;
+        t0 = trace_now();
+        snprintf(peer, sizeof(peer), "P%d", i+1);
+        if (!clnts[i]) clnts[i] = connect_to_participant_proto(c, i, "tcp");
+        if (!clnts[i]) {
+            fprintf(stderr, "[WARNING] Cannot notify P%d of epoch %d decisions. Recovery needed.\n", i+1, epoch);
+            trace_span("notify", epoch, cur_trace_id, t0, "connect failed");
+            continue;
+        }
+        if (batch.commit_ids.commit_ids_len > 0) maybe_fail(c, "after_commit");
+        batch.span_id = trace_new_id();
+        trace_flow_start(batch.span_id, epoch, cur_trace_id);
+        if (clnt_call(clnts[i], DECIDE_BATCH, (xdrproc_t) xdr_DecisionBatch, (caddr_t) &batch,
+                      (xdrproc_t) xdr_int, (caddr_t) &ack, TIMEOUT) != RPC_SUCCESS)
+            fprintf(stderr, "[WARNING] DECIDE_BATCH to P%d failed for epoch %d. Recovery needed.\n", i+1, epoch);
+        trace_span("notify", epoch, cur_trace_id, t0, peer);
+    }
+
+    write_epoch_log(c, epoch, "EPOCH_COMPLETE", txns, n);
+
+    printf("Epoch %d completed: %u COMMIT / %u ABORT\n", epoch,
+           batch.commit_ids.commit_ids_len, batch.abort_ids.abort_ids_len);
+
+    close_clients(c, clnts);
+}
+
+/* ---------- Worker / Completion Queue ---------- */
+static void *worker_main(void *arg) {
+    Coordinator *c = arg;
+    for (;;) {
+        pthread_mutex_lock(&c->mu);
+        while (!c->submit_head && !c->stopping)
+            pthread_cond_wait(&c->work_cv, &c->mu);
+        CoordTxn *t = c->submit_head;
+        if (!t) { pthread_mutex_unlock(&c->mu); return NULL; } // stopping 이고 할 일 없음
+        c->submit_head = t->next;
+        if (!c->submit_head) c->submit_tail = NULL;
+        c->submit_len--;
+        pthread_mutex_unlock(&c->mu);
+
+        uint64_t t0 = trace_now();
+        cur_trace_id = t->trace_id;
+        if (coord_failed(c)) {
+            fprintf(stderr, "[TXN_ABORT] Txn %d: coordinator failed (%s). DECISION=ABORT.\n", t->txn_id, c->error);
+            t->decision = 0;
+        } else if (txn_expired(t) || !acquire_slots(c, t->has_deadline ? &t->deadline : NULL)) {
+            fprintf(stderr, "[TXN_ABORT] Txn %d: deadline passed while queued. DECISION=ABORT.\n", t->txn_id);
+            t->decision = 0;
+        } else {
+            t->decision = handle_transaction(t);
+            release_slots(c);
+        }
+        trace_span("txn", t->txn_id, t->trace_id, t0, decision_name(t->decision));
+
+        pthread_mutex_lock(&c->mu);
+        t->next = NULL;
+        if (c->done_tail) c->done_tail->next = t; else c->done_head = t;
+        c->done_tail = t;
+        pthread_mutex_unlock(&c->mu);
+
+        uint64_t one = 1;
+        if (write(c->event_fd, &one, sizeof(one)) != sizeof(one))
+            perror("eventfd write");
+    }
+}
+
+// coordinator 가 실패했거나 deadline 이 지난 txn 을 ABORT 로 정하고 빼냄. 남은 txn 수
+static int drop_expired(Coordinator *c, CoordTxn **txns, int n) {
+    int k, live = 0;
+    for (k = 0; k < n; k++) {
+        if (coord_failed(c)) {
+            fprintf(stderr, "[TXN_ABORT] Txn %d: coordinator failed (%s). DECISION=ABORT.\n", txns[k]->txn_id, c->error);
+            txns[k]->decision = 0;
+        } else if (txn_expired(txns[k])) {
+            fprintf(stderr, "[TXN_ABORT] Txn %d: deadline passed while queued. DECISION=ABORT.\n", txns[k]->txn_id);
+            txns[k]->decision = 0;
+        } else {
+            txns[live++] = txns[k];
+        }
+    }
+    return live;
+}
+
+// deadline 이 있는 txn 중 가장 이른 것 (하나도 없으면 NULL: 무한 대기)
+static const struct timespec *earliest_deadline(CoordTxn **txns, int n) {
+    const struct timespec *first = NULL;
+    int k;
+    for (k = 0; k < n; k++) {
+        const struct timespec *d = &txns[k]->deadline;
+        if (!txns[k]->has_deadline) continue;
+        if (!first || d->tv_sec < first->tv_sec || (d->tv_sec == first->tv_sec && d->tv_nsec < first->tv_nsec))
+            first = d;
+    }
+    return first;
+}
+
+// epoch mode worker. 한 번에 한 thread 만 epoch 를 모으고 (첫 txn 도착 후 epoch_ms 동안 또는
+// MAX_EPOCH_TXNS 개가 찰 때까지), 다른 thread 들은 앞 epoch 의 2PC 와 겹쳐서 다음 epoch 를 모은다
+static void *epoch_main(void *arg) {
+    Coordinator *c = arg;
+    CoordTxn *batch[MAX_EPOCH_TXNS], *live_txns[MAX_EPOCH_TXNS];
+    for (;;) {
+        struct timespec deadline;
+        int n = 0, k;
+
+        pthread_mutex_lock(&c->mu);
+        while ((c->collecting || !c->submit_head) && !c->stopping)
+            pthread_cond_wait(&c->work_cv, &c->mu);
+        if (!c->submit_head) { pthread_mutex_unlock(&c->mu); return NULL; }
+
+        c->collecting = 1;
+        timespec_after_ms(CLOCK_REALTIME, &deadline, c->opts.epoch_ms);
+        while (!c->stopping && c->submit_len < MAX_EPOCH_TXNS)
+            if (pthread_cond_timedwait(&c->work_cv, &c->mu, &deadline) == ETIMEDOUT) break;
+
+        while (c->submit_head && n < MAX_EPOCH_TXNS) {
+            batch[n++] = c->submit_head;
+            c->submit_head = c->submit_head->next;
+            c->submit_len--;
+        }
+        if (!c->submit_head) c->submit_tail = NULL;
+        c->collecting = 0;
+        pthread_cond_broadcast(&c->work_cv);
+        pthread_mutex_unlock(&c->mu);
+
+        // deadline 이 지난 txn 은 epoch 에 넣지 않고 바로 ABORT. slot 은 남은 txn 중 가장 이른 deadline 까지만
+        // 기다리고, 그때까지 못 잡으면 지난 txn 을 빼고 다시 기다림
+        memcpy(live_txns, batch, n * sizeof(batch[0]));
+        int live = drop_expired(c, live_txns, n), got = 0;
+        while (live > 0 && !(got = acquire_slots(c, earliest_deadline(live_txns, live))))
+            live = drop_expired(c, live_txns, live);
+
+        uint64_t t0 = trace_now();
+        cur_trace_id = trace_new_id();
+        if (got) {
+            handle_epoch(c, live_txns, live);
+            release_slots(c);
+        }
+        for (k = 0; k < n; k++)
+            trace_span("txn", batch[k]->txn_id, batch[k]->trace_id, t0, decision_name(batch[k]->decision));
+
+        pthread_mutex_lock(&c->mu);
+        for (k = 0; k < n; k++) {
+            batch[k]->next = NULL;
+            if (c->done_tail) c->done_tail->next = batch[k]; else c->done_head = batch[k];
+            c->done_tail = batch[k];
+        }
+        pthread_mutex_unlock(&c->mu);
+
+        uint64_t one = 1;
+        if (write(c->event_fd, &one, sizeof(one)) != sizeof(one))
+            perror("eventfd write");
+    }
+}
+
+/* ---------- Hot standby ---------- */
+// standby_port 가 있으면 lease 를 넘겨받을 때까지 primary 의 로그를 받기만 하고, 그 뒤로는 primary 와 같음.
+// lease 를 쥔 뒤 replica_addr 가 있으면 지금 로그 전체를 standby 에게 보내 같은 상태에서 시작하게 함
+// (standby 가 넘겨받은 뒤 이전 primary 가 standby 로 다시 붙으면, ack 없이 남긴 레코드는 새 primary 의 로그로 덮어써짐)
+static int open_lease_and_replica(Coordinator *c, struct timespec *took_over) {
+    const CoordOptions *o = &c->opts;
+
+    // lease 없이 복제하면 standby 가 넘겨받은 뒤에도 이전 primary 가 계속 결정을 내릴 수 있음
+    if (o->replica_addr && !o->lease_file) {
+        fprintf(stderr, "[ERROR] replication to a standby needs a lease file\n");
+        return -1;
+    }
+    if (o->standby_port > 0) {
+        struct timespec lost_at;
+        if (!o->lease_file) {
+            fprintf(stderr, "[ERROR] standby mode needs a lease file\n");
+            return -1;
+        }
+        c->lease_fd = replica_standby(c->log_file, o->standby_port, o->lease_file, &lost_at);
+        if (c->lease_fd < 0) return -1;
+        // primary 가 이 standby 없이 기록한 결정이 있을 수 있음: presumed abort 로 recovery 하면 atomicity 가 깨짐
+        if (lease_is_degraded(c->lease_fd)) {
+            fprintf(stderr, "[ERROR] Lease %s is marked degraded: the primary logged records this standby never received. "
+                            "Not taking over; restart the primary on its own log.\n", o->lease_file);
+            return -1;
+        }
+        env->now(took_over);
+        printf("[STANDBY] Lease acquired %.3f ms after primary disconnected\n", elapsed_ms(&lost_at));
+    } else if (o->lease_file) {
+        c->lease_fd = lease_acquire(o->lease_file, 0);
+        if (c->lease_fd < 0) {
+            fprintf(stderr, "[ERROR] Lease %s is held by another coordinator\n", o->lease_file);
+            return -1;
+        }
+    }
+
+    if (o->replica_addr) {
+        c->degraded = lease_is_degraded(c->lease_fd);
+        attach_standby(c);
+        if (c->repl_fd < 0) {
+            fprintf(stderr, "[WARNING] Cannot reach standby %s. Running without replication until it is up.\n", o->replica_addr);
+            if (!c->degraded && mark_degraded(c) < 0) return -1;
+        }
+    }
+    return 0;
+}
+
+/* ---------- Public API ---------- */
+void coord_options_init(CoordOptions *opts) {
+    memset(opts, 0, sizeof(*opts));
+    opts->conf_file = "participants.conf";
+    opts->log_file = COORD_DEFAULT_LOG_FILE;
+    opts->workers = COORD_DEFAULT_WORKERS;
+}
+
+// coord_open 실패 경로와 coord_close 가 같이 씀 (worker 는 이미 끝났거나 없음)
+static void free_coordinator(Coordinator *c) {
+    ulog_close(c->ulog);
+    if (c->repl_fd >= 0) close(c->repl_fd);
+    if (c->lease_fd >= 0) close(c->lease_fd); // lease 는 로그를 모두 쓴 뒤에 놓음
+    if (c->event_fd >= 0) close(c->event_fd);
+    free(c->workers);
+    free(c);
+}
+
+Coordinator *coord_open(const CoordOptions *opts) {
+    Coordinator *c = calloc(1, sizeof(*c));
+    struct timespec took_over;
+    int i;
+    if (!c) { perror("calloc"); return NULL; }
+
+    c->opts = *opts;
+    snprintf(c->conf_file, sizeof(c->conf_file), "%s", opts->conf_file ? opts->conf_file : "participants.conf");
+    snprintf(c->log_file, sizeof(c->log_file), "%s", opts->log_file ? opts->log_file : COORD_DEFAULT_LOG_FILE);
+    c->next_txn_id = 1;
+    c->lease_fd = -1;
+    c->repl_fd = -1;
+    c->event_fd = -1;
+    pthread_mutex_init(&c->log_mu, NULL);
+    pthread_mutex_init(&c->repl_mu, NULL);
+    pthread_mutex_init(&c->mu, NULL);
+    pthread_cond_init(&c->work_cv, NULL);
+    pthread_mutex_init(&c->slot_mu, NULL);
+    {
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&c->slot_cv, &attr);
+        pthread_condattr_destroy(&attr);
+    }
+
+    if (load_participants(c) < 0) { free(c); return NULL; }
+    if (opts->epoch_ms > 0 && opts->tree_fanout > 0) {
+        fprintf(stderr, "[ERROR] epoch mode and tree mode cannot be combined\n");
+        free(c);
+        return NULL;
+    }
+
+    trace_init(opts->trace_file, "coordinator");
+
+    if (open_lease_and_replica(c, &took_over) < 0) { free_coordinator(c); return NULL; }
+
+    if (opts->log_backend == COORD_LOG_URING)
+        c->ulog = ulog_open(c->log_file, 0);
+
+    if (run_recovery(c) < 0) { free_coordinator(c); return NULL; }
+    if (opts->standby_port > 0) {
+        printf("[STANDBY] Took over as primary: recovery done %.3f ms after lease acquired\n", elapsed_ms(&took_over));
+        fflush(stdout);
+    }
+
+    c->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (c->event_fd < 0) { perror("eventfd"); free_coordinator(c); return NULL; }
+
+    c->worker_count = opts->workers > 0 ? opts->workers : COORD_DEFAULT_WORKERS;
+    c->workers = calloc(c->worker_count, sizeof(pthread_t));
+    if (!c->workers) { perror("calloc"); free_coordinator(c); return NULL; }
+    for (i = 0; i < c->worker_count; i++) {
+        if (pthread_create(&c->workers[i], NULL, opts->epoch_ms > 0 ? epoch_main : worker_main, c) != 0) {
+            perror("pthread_create");
+            c->worker_count = i; // 이미 만든 worker 만 멈추고 정리
+            coord_close(c);
+            return NULL;
+        }
+    }
+    return c;
+}
+
+// 이미 submit 된 txn 은 끝까지 진행하고, 남은 callback 까지 호출한 뒤 정리
+void coord_close(Coordinator *c) {
+    int i;
+    if (!c) return;
+
+    pthread_mutex_lock(&c->mu);
+    c->stopping = 1;
+    pthread_cond_broadcast(&c->work_cv);
+    pthread_mutex_unlock(&c->mu);
+
+    for (i = 0; i < c->worker_count; i++)
+        pthread_join(c->workers[i], NULL);
+    // 기다리지 않고 submit 한 COMPLETE 들이 끝난 뒤 poll 해야 그 실패도 on_error 로 전달됨
+    ulog_close(c->ulog);
+    c->ulog = NULL;
+    coord_poll(c);
+
+    trace_dump();
+    free_coordinator(c);
+}
+
+int coord_next_txn_id(Coordinator *c) {
+    pthread_mutex_lock(&c->mu);
+    int id = c->next_txn_id;
+    pthread_mutex_unlock(&c->mu);
+    return id;
+}
+
+int coord_participant_count(Coordinator *c) {
+    return c->participant_count;
+}
+
+CoordTxn *coord_begin(Coordinator *c) {
+    CoordTxn *t = calloc(1, sizeof(*t));
+    if (!t) return NULL;
+    t->coord = c;
+    pthread_mutex_lock(&c->mu);
+    t->txn_id = c->next_txn_id++;
+    pthread_mutex_unlock(&c->mu);
+    t->trace_id = trace_new_id();
+    if (c->opts.default_deadline_ms > 0)
+        coord_txn_deadline(t, c->opts.default_deadline_ms);
+    return t;
+}
+
+void coord_txn_free(CoordTxn *t) {
+    free(t);
+}
+
+int coord_txn_deadline(CoordTxn *t, int timeout_ms) {
+    if (timeout_ms <= 0) { t->has_deadline = 0; return 0; }
+    timespec_after_ms(CLOCK_MONOTONIC, &t->deadline, timeout_ms);
+    t->has_deadline = 1;
+    return 0;
+}
+
+int coord_txn_id(const CoordTxn *t) {
+    return t->txn_id;
+}
+
+int coord_txn_lock(CoordTxn *t, int key, int exclusive) {
+    if (t->lock_count >= MAX_TXN_LOCKS) return -1;
+    t->locks[t->lock_count].key = key;
+    t->locks[t->lock_count].exclusive = exclusive ? 1 : 0;
+    t->lock_count++;
+    return 0;
+}
+
+int coord_submit(CoordTxn *t, coord_done_fn cb, void *arg) {
+    Coordinator *c = t->coord;
+    t->cb = cb;
+    t->cb_arg = arg;
+    t->next = NULL;
+
+    pthread_mutex_lock(&c->mu);
+    if (c->stopping) { pthread_mutex_unlock(&c->mu); return COORD_SUBMIT_CLOSED; }
+    if (c->failed) { pthread_mutex_unlock(&c->mu); return COORD_SUBMIT_FAILED; }
+    // backpressure: 아직 시작 못 한 txn 이 max_queue 개면 거절 (txn 은 호출자 소유로 남음)
+    if (c->opts.max_queue > 0 && c->submit_len >= c->opts.max_queue) {
+        pthread_mutex_unlock(&c->mu);
+        return COORD_SUBMIT_BUSY;
+    }
+    if (c->submit_tail) c->submit_tail->next = t; else c->submit_head = t;
+    c->submit_tail = t;
+    c->submit_len++;
+    // epoch mode: 모으는 thread 가 없을 때 (새 epoch 시작) 와 epoch 가 꽉 찼을 때만 깨움
+    if (c->opts.epoch_ms <= 0)
+        pthread_cond_signal(&c->work_cv);
+    else if (!c->collecting || c->submit_len >= MAX_EPOCH_TXNS)
+        pthread_cond_broadcast(&c->work_cv);
+    pthread_mutex_unlock(&c->mu);
+    return COORD_SUBMIT_OK;
+}
+
+// 완료된 txn 이 있으면 readable 해짐 (poll/epoll 용)
+int coord_event_fd(Coordinator *c) {
+    return c->event_fd;
+}
+
+int coord_poll(Coordinator *c) {
+    uint64_t cnt;
+    char error[sizeof(c->error)];
+    int n = 0, report;
+
+    // 카운터는 리셋만 하고, 실제 완료 목록은 queue 에서 꺼냄
+    if (read(c->event_fd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN)
+        perror("eventfd read");
+
+    pthread_mutex_lock(&c->mu);
+    CoordTxn *t = c->done_head;
+    c->done_head = c->done_tail = NULL;
+    report = c->failed && !c->error_reported;
+    if (report) {
+        c->error_reported = 1;
+        memcpy(error, c->error, sizeof(error));
+    }
+    pthread_mutex_unlock(&c->mu);
+
+    if (report && c->opts.on_error) c->opts.on_error(error, c->opts.error_arg);
+
+    while (t) {
+        CoordTxn *next = t->next;
+        if (t->cb) t->cb(t->txn_id, t->decision, t->cb_arg);
+        free(t);
+        t = next;
+        n++;
+    }
+    return n;
+}
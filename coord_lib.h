@@ -0,0 +1,96 @@
+#ifndef COORD_LIB_H
+#define COORD_LIB_H
+
+/*
+ * Embeddable 2PC coordinator.
+ * coordinator 프로세스를 fork/exec 하지 않고 애플리케이션 안에서 직접 commit 을 진행한다.
+ *
+ *   Coordinator *c = coord_open(&opts);     // participant 로딩 + txn.log 복구
+ *   CoordTxn *t = coord_begin(c);
+ *   coord_txn_lock(t, 42, 1);
+ *   coord_txn_deadline(t, 200);             // 200ms 안에 PREPARE 를 못 보내면 ABORT
+ *   coord_submit(t, on_done, arg);          // 바로 반환 (non-blocking), 과부하면 COORD_SUBMIT_BUSY
+ *   ... poll(coord_event_fd(c)) ...
+ *   coord_poll(c);                          // 끝난 txn 의 on_done 호출
+ *   coord_close(c);
+ *
+ * 동시성 모델: coord_open 이 opts.workers 개 (기본 8) 의 고정 worker thread 를 만들고, worker 하나가
+ * txn 하나의 Phase 1/2 를 blocking RPC 와 fsync 로 끝까지 진행한다. 그래서 동시에 진행되는 txn 은
+ * 최대 workers 개이고 나머지는 submit queue 에서 기다린다 (epoch mode 는 worker 하나가 epoch 하나).
+ * coord_submit / coord_poll 은 blocking 하지 않으며, 결과 callback 과 on_error 는 항상
+ * coord_poll() 을 호출한 thread 에서 실행된다.
+ *
+ * 로그를 쓸 수 없는 등 더 진행할 수 없는 오류가 나면 프로세스를 끝내지 않고 coordinator 를 failed
+ * 상태로 바꾼다: 진행 중이던 txn 은 ABORT (결정 레코드를 못 쓴 COMMIT 은 COORD_DECISION_UNKNOWN),
+ * 이후 submit 은 COORD_SUBMIT_FAILED, on_error 가 한 번 호출된다. 재시작 recovery 가 나머지를 정리한다.
+ */
+
+#include "commit.h"
+
+#define COORD_DEFAULT_LOG_FILE "txn.log"
+#define COORD_DEFAULT_WORKERS 8
+
+typedef enum {
+    COORD_LOG_FSYNC = 0,     // fopen/fprintf/fsync (기본)
+    COORD_LOG_URING = 1      // io_uring WRITE + linked FDATASYNC, 여러 worker 의 fsync 가 동시에 진행
+} CoordLogBackend;
+
+typedef struct Coordinator Coordinator;
+typedef struct CoordTxn CoordTxn;
+
+// coord_submit 반환값
+#define COORD_SUBMIT_OK 0
+#define COORD_SUBMIT_CLOSED -1  // coord_close 진행 중
+#define COORD_SUBMIT_BUSY -2    // queue 가 가득 참 (backpressure). txn 은 그대로 남으므로 다시 submit 하거나 coord_txn_free
+#define COORD_SUBMIT_FAILED -3  // coordinator 가 failed 상태 (on_error). txn 은 호출자 소유로 남음
+
+// decision: 1 = COMMIT, 0 = ABORT, COORD_DECISION_UNKNOWN = one_phase 에서 결정을 맡긴
+// 마지막 participant 의 응답을 끝내 받지 못했거나, DECISION_COMMIT 을 로그에 쓰지 못함
+// (coordinator 재시작 recovery 가 로그와 STATUS 로 확인)
+#define COORD_DECISION_UNKNOWN -1
+typedef void (*coord_done_fn)(int txn_id, int decision, void *arg);
+// msg 는 callback 안에서만 유효
+typedef void (*coord_error_fn)(const char *msg, void *arg);
+
+typedef struct {
+    const char *conf_file;   // participant 목록 (host prog)
+    const char *log_file;    // coordinator decision log
+    int workers;             // worker thread 수 = 동시에 진행되는 txn (epoch mode 는 epoch) 수
+    CoordLogBackend log_backend;
+    int tree_fanout;         // 0 = flat 2PC, k > 0 = participant 들을 k-ary tree 로 묶어 진행
+    int epoch_ms;            // > 0 이면 epoch mode: 이 시간 동안 submit 된 txn 들을 한 번의 2PC 로 묶음
+    int max_queue;           // 시작 전 대기 txn 이 이만큼이면 coord_submit 이 COORD_SUBMIT_BUSY (0 = 제한 없음)
+    int participant_limit;   // participant 당 동시 진행 txn 수 (0 = 제한 없음, conf 의 3번째 열이 우선)
+    int default_deadline_ms; // coord_begin 때 붙는 deadline (0 = 없음)
+    int one_phase;           // flat mode 에서 마지막 participant 에게 PREPARE_COMMIT 으로 결정을 맡김 (last agent).
+                             // participant 가 하나면 round trip 한 번으로 끝나는 one-phase commit
+    const char *trace_file;  // NULL 이 아니면 span 을 Chrome trace JSON 으로 덤프 (coord_close 때)
+    const char *lease_file;  // 이 파일의 fcntl lock 을 쥔 coordinator 만 동작 (primary / standby 가 공유)
+    const char *replica_addr;// "host:port": 로그 레코드를 hot standby 에게 동기 복제 (lease_file 필요)
+    int standby_port;        // > 0 이면 hot standby: coord_open 은 이 port 로 primary 의 로그를 받다가
+                             // lease 를 넘겨받은 (primary 가 죽은) 뒤에 recovery 를 하고 반환
+    coord_error_fn on_error; // coordinator 가 failed 상태가 되면 coord_poll 에서 한 번 호출 (NULL 이면 stderr 만)
+    void *error_arg;
+    int fail_after_prepare;  // failure injection (테스트용, exit(99))
+    int fail_after_commit;
+} CoordOptions;
+
+void coord_options_init(CoordOptions *opts);
+
+Coordinator *coord_open(const CoordOptions *opts);
+void coord_close(Coordinator *c);
+int coord_next_txn_id(Coordinator *c);
+int coord_participant_count(Coordinator *c);
+
+CoordTxn *coord_begin(Coordinator *c);
+int coord_txn_id(const CoordTxn *t);
+int coord_txn_lock(CoordTxn *t, int key, int exclusive);
+// 지금부터 timeout_ms 안에 PREPARE 를 시작하지 못하면 participant 에게 보내지 않고 ABORT
+int coord_txn_deadline(CoordTxn *t, int timeout_ms);
+void coord_txn_free(CoordTxn *t);   // submit 하지 않은 (또는 BUSY 로 거절된) txn 정리
+int coord_submit(CoordTxn *t, coord_done_fn cb, void *arg);
+
+int coord_event_fd(Coordinator *c);
+int coord_poll(Coordinator *c);
+
+#endif /* COORD_LIB_H */
@@ -3,44 +3,35 @@
 #include <string.h>
 #include <unistd.h>
 #include <getopt.h>
-#include <rpc/rpc.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include "commit.h"
-
-#define LOG_FILE "txn.log"
-#define MAX_PARTICIPANTS 16
-#define MAX_HOST_LEN 256
-// RPC 타임아웃 5초
-#define TIMEOUT_SEC 5 
-#define MAX_TXNS 10 // 최대 복구 가능 트랜잭션 수
+#include <poll.h>
+#include "coord_lib.h"
 
 // --- 전역 변수 및 구조체 정의 ---
-typedef struct {
-    char host[MAX_HOST_LEN];
-    unsigned long prog_number;
-} Participant;
-
 typedef struct {
     int id;
     unsigned long prog_number;
     char coord_host[256];
     int fail_after_prepare;
     int fail_after_commit;
+    LockReq locks[MAX_TXN_LOCKS]; // 이번 txn 이 participant 에서 잡을 lock 들
+    int lock_count;
+    int tree_fanout;
+    CoordLogBackend log_backend;
+    char trace_file[256];
+    int epoch_ms;
+    int deadline_ms;
+    int one_phase;
+    char log_file[256];
+    char lease_file[256];
+    char replica_addr[256];
+    int standby_port;
+    int txns;
+    int workers;
+    int max_queue;
+    int participant_limit;
 } Config;
 
-typedef struct {
-    int txn_id;
-    char state[32];
-} TxnRecord;
-
 Config cfg;
-Participant participants[MAX_PARTICIPANTS];
-int participant_count = 0;
-// RPC 타임아웃 구조체 초기화.
-static struct timeval TIMEOUT = {TIMEOUT_SEC, 0};
-int next_txn_id = 1; // 트랜잭션 ID 관리
 int initial_txn_id = 1; // main에서 복구 전 ID를 저장하기 위한 변수
 
 // conf_file 전역 변수 선언
@@ -49,60 +40,8 @@ char conf_file[256] = "participants.conf";
 // --- 함수 선언 ---
 void print_usage(const char *prog);
 void parse_args(int argc, char *argv[], Config *cfgp);
-void load_participants(const char *filename);
-void write_log(int txn_id, const char *state);
-CLIENT *connect_to_participant(int i);
-void notify_participants(int txn_id, int decision);
-TxnRecord *read_all_txn_states(int *record_count);
-PrepareResult *prepare_rpc(int txn_id, CLIENT *clnt);
-int *commit_rpc(int txn_id, CLIENT *clnt);
-int *abort_rpc(int txn_id, CLIENT *clnt);
-int *status_rpc(int txn_id, CLIENT *clnt);
-
-
-/* ---------- Failure Injection / Logging ---------- */
-void maybe_fail(const char *phase) {
-    if ((strcmp(phase, "after_prepare") == 0 && cfg.fail_after_prepare) ||
-        (strcmp(phase, "after_commit") == 0 && cfg.fail_after_commit)) {
-        fprintf(stderr, "[FAILURE] Simulating crash during %s\n", phase);
-        exit(99);
-    }
-}
-void write_log(int txn_id, const char *state) {
-    FILE *f = fopen(LOG_FILE, "a+");
-    if (!f) { perror("fopen"); exit(1); }
-    fprintf(f, "%d %s\n", txn_id, state);
-    fflush(f);
-    fsync(fileno(f));
-    fclose(f);
-}
-
-/* ---------- Utility: Log File Reading for Recovery ---------- */
-TxnRecord *read_all_txn_states(int *record_count) {
-    FILE *f = fopen(LOG_FILE, "r");
-    if (!f) { *record_count = 0; return NULL; }
-
-    TxnRecord *records = calloc(MAX_TXNS, sizeof(TxnRecord));
-    if (!records) { perror("calloc"); fclose(f); exit(1); }
-
-    *record_count = 0;
-    char line[256];
-    int id;
-    char state[32];
 
-    while (fgets(line, sizeof(line), f)) {
-        if (sscanf(line, "%d %31s", &id, state) == 2 && id > 0 && id <= MAX_TXNS) {
-            records[id-1].txn_id = id;
-            strncpy(records[id-1].state, state, 31);
-            records[id-1].state[31] = '\0';
-            if (id > *record_count) *record_count = id;
-        }
-    }
-    fclose(f);
-    return records;
-}
-
-/* ---------- CLI Parsing / Participant Loading ---------- */
+/* ---------- CLI Parsing ---------- */
 
 void print_usage(const char *prog) {
     fprintf(stderr,
@@ -113,6 +52,22 @@ void print_usage(const char *prog) {
         "--conf <filename>    (participant list)\n"
         "--fail-after-prepare\n"
         "--fail-after-commit\n"
+        "--lock <key>         (exclusive lock, 반복 가능)\n"
+        "--lock-shared <key>  (shared lock, 반복 가능)\n"
+        "--tree-fanout <k>    (hierarchical 2PC, participant 들을 k-ary tree 로 묶음)\n"
+        "--log-backend <fsync|uring>\n"
+        "--trace <file>       (span 을 Chrome trace JSON 으로 덤프)\n"
+        "--epoch-ms <n>       (epoch mode: n ms 동안 모인 txn 들을 한 번의 2PC 로 처리)\n"
+        "--deadline-ms <n>    (n ms 안에 PREPARE 를 보내지 못하면 ABORT)\n"
+        "--one-phase          (마지막 participant 에게 결정을 맡김, participant 하나면 one-phase commit)\n"
+        "--log <file>         (decision log, 기본 txn.log)\n"
+        "--lease <file>       (이 파일의 lock 을 쥔 coordinator 만 동작, primary / standby 공유)\n"
+        "--replica <host:port> (hot standby 에게 로그를 동기 복제, --lease 필요)\n"
+        "--standby <port>     (hot standby: primary 가 죽어 lease 를 넘겨받으면 recovery 진행)\n"
+        "--txns <n>           (txn n 개를 submit 하고 모두 끝날 때까지 기다림, 기본 1)\n"
+        "--workers <n>        (동시에 진행하는 txn 수 = worker thread 수, 기본 1)\n"
+        "--max-queue <n>      (시작 전 대기 txn 이 n 개면 submit 이 BUSY, 0 = 제한 없음)\n"
+        "--participant-limit <n> (participant 당 동시 진행 txn 수, 0 = 제한 없음)\n"
         "-h,--help\n",
         prog);
 }
@@ -121,6 +76,8 @@ void parse_args(int argc, char *argv[], Config *cfgp) {
     memset(cfgp, 0, sizeof(*cfgp));
     strcpy(cfgp->coord_host, "localhost");
     cfgp->prog_number = 0; 
+    cfgp->txns = 1;
+    cfgp->workers = 1;
 
     static struct option long_opts[] = {
         {"id", required_argument, 0, 'i'},
@@ -129,6 +86,22 @@ void parse_args(int argc, char *argv[], Config *cfgp) {
         {"conf", required_argument, 0, 'f'},
         {"fail-after-prepare", no_argument, 0, 1},
         {"fail-after-commit", no_argument, 0, 2},
+        {"lock", required_argument, 0, 3},
+        {"lock-shared", required_argument, 0, 4},
+        {"tree-fanout", required_argument, 0, 5},
+        {"log-backend", required_argument, 0, 6},
+        {"trace", required_argument, 0, 7},
+        {"epoch-ms", required_argument, 0, 8},
+        {"deadline-ms", required_argument, 0, 9},
+        {"one-phase", no_argument, 0, 10},
+        {"log", required_argument, 0, 11},
+        {"lease", required_argument, 0, 12},
+        {"replica", required_argument, 0, 13},
+        {"standby", required_argument, 0, 14},
+        {"txns", required_argument, 0, 15},
+        {"workers", required_argument, 0, 16},
+        {"max-queue", required_argument, 0, 17},
+        {"participant-limit", required_argument, 0, 18},
         {"help", no_argument, 0, 'h'},
         {0,0,0,0}
     };
@@ -142,228 +115,125 @@ void parse_args(int argc, char *argv[], Config *cfgp) {
             case 'f': strncpy(conf_file, optarg, sizeof(conf_file)-1); break;
             case 1: cfgp->fail_after_prepare = 1; break;
             case 2: cfgp->fail_after_commit = 1; break;
+            case 3:
+            case 4:
+                if (cfgp->lock_count >= MAX_TXN_LOCKS) {
+                    fprintf(stderr, "[ERROR] at most %d locks per transaction\n", MAX_TXN_LOCKS);
+                    exit(1);
+                }
+                cfgp->locks[cfgp->lock_count].key = atoi(optarg);
+                cfgp->locks[cfgp->lock_count].exclusive = (opt == 3);
+                cfgp->lock_count++;
+                break;
+            case 5: cfgp->tree_fanout = atoi(optarg); break;
+            case 6:
+                if (strcmp(optarg, "uring") == 0) cfgp->log_backend = COORD_LOG_URING;
+                else if (strcmp(optarg, "fsync") == 0) cfgp->log_backend = COORD_LOG_FSYNC;
+                else { fprintf(stderr, "[ERROR] unknown --log-backend '%s'\n", optarg); exit(1); }
+                break;
+            case 7:
+                strncpy(cfgp->trace_file, optarg, sizeof(cfgp->trace_file)-1);
+                cfgp->trace_file[sizeof(cfgp->trace_file)-1] = '\0';
+                break;
+            case 8: cfgp->epoch_ms = atoi(optarg); break;
+            case 9: cfgp->deadline_ms = atoi(optarg); break;
+            case 10: cfgp->one_phase = 1; break;
+            case 11: strncpy(cfgp->log_file, optarg, sizeof(cfgp->log_file)-1); break;
+            case 12: strncpy(cfgp->lease_file, optarg, sizeof(cfgp->lease_file)-1); break;
+            case 13: strncpy(cfgp->replica_addr, optarg, sizeof(cfgp->replica_addr)-1); break;
+            case 14: cfgp->standby_port = atoi(optarg); break;
+            case 15: cfgp->txns = atoi(optarg); break;
+            case 16: cfgp->workers = atoi(optarg); break;
+            case 17: cfgp->max_queue = atoi(optarg); break;
+            case 18: cfgp->participant_limit = atoi(optarg); break;
             case 'h':
             default: print_usage(argv[0]); exit(opt=='h'?0:1);
         }
     }
 }
 
-void load_participants(const char *filename) {
-    FILE *f = fopen(filename, "r");
-    if (!f) { perror("fopen participants.conf"); exit(1); }
-    participant_count = 0;
-
-    while (fscanf(f, "%s %lx", participants[participant_count].host,
-                      &participants[participant_count].prog_number) == 2) {
-        participant_count++;
-        if (participant_count >= MAX_PARTICIPANTS) break;
-    }
-    fclose(f);
-
-    if (participant_count == 0) {
-        fprintf(stderr, "[ERROR] No participants found in %s\n", filename);
-        exit(1);
-    }
-
-    // cfg.prog_number가 0이면 첫 번째 participant prog_number로 채움
-    if (cfg.prog_number == 0) {
-        cfg.prog_number = participants[0].prog_number;
-    }
-
-    printf("Loaded %d participants from %s.\n", participant_count, filename);
-}
-
-/* ---------- RPC Calls ---------- */
-PrepareResult *prepare_rpc(int txn_id, CLIENT *clnt) {
-    TxnID arg;
-    arg.txn_id = txn_id;
-    return prepare_1(arg, clnt);
-}
-int *commit_rpc(int txn_id, CLIENT *clnt) {
-    TxnID arg;
-    arg.txn_id = txn_id;
-    return commit_1(arg, clnt);
-}
-int *abort_rpc(int txn_id, CLIENT *clnt) {
-    TxnID arg;
-    arg.txn_id = txn_id;
-    return abort_1(arg, clnt);
+/* ---------- Completion Callback ---------- */
+static void on_txn_done(int txn_id, int decision, void *arg) {
+    printf("Transaction %d completed with decision = %s\n", txn_id,
+           decision == COORD_DECISION_UNKNOWN ? "UNKNOWN" : decision ? "COMMIT" : "ABORT");
+    (*(int *)arg)++;
 }
-int *status_rpc(int txn_id, CLIENT *clnt) {
-    TxnID arg;
-    arg.txn_id = txn_id;
-    return status_1(arg, clnt);
-}
-
-/* ---------- Connection Helper ---------- */
-CLIENT *connect_to_participant(int i) {
-    int attempts = 0; const int max_attempts = 10; const int retry_delay_sec = 1;
-    CLIENT *clnt = NULL;
-
-    while (clnt == NULL && attempts < max_attempts) {
-        if (attempts > 0) {
-            fprintf(stderr, "[RETRY] P%d connection failed. Retrying in %d sec (Attempt %d/%d)...\n",
-                             i+1, retry_delay_sec, attempts + 1, max_attempts);
-            sleep(retry_delay_sec);
-        }
-        clnt = clnt_create(participants[i].host, participants[i].prog_number, COMMIT_VERS, "udp");
-        if (clnt) {
-             clnt_control(clnt, CLSET_TIMEOUT, (char *)&TIMEOUT);
-        }
-        attempts++;
-    }
 
-    if (!clnt) {
-        fprintf(stderr, "[ERROR] Connect FAILED to P%d (Prog: 0x%lx) after %d attempts. RPC Error: %s\n",
-                         i+1, participants[i].prog_number, max_attempts, clnt_spcreateerror("clnt_create"));
-    } else {
-        fprintf(stderr, "[DEBUG] Connect SUCCESS to P%d (Prog: 0x%lx) after %d attempt(s)\n",
-                         i+1, participants[i].prog_number, attempts);
-    }
-    return clnt;
-}
-
-/* ---------- Notify Helper ---------- */
-void notify_participants(int txn_id, int decision) {
-    CLIENT *clnts[MAX_PARTICIPANTS] = {0};
-    int i;
-    for (i = 0; i < participant_count; i++) {
-        clnts[i] = connect_to_participant(i);
-        if (!clnts[i]) {
-            fprintf(stderr, "[WARNING] Cannot notify P%d of decision. Recovery needed.\n", i+1);
-            continue;
-        }
-
-        if (decision) {
-            // 명세: maybe_fail("after_commit")은 COMMIT 통지 루프 안에 있어야 함.
-            maybe_fail("after_commit"); // COMMIT 통지 직전 또는 직후 (여기서는 통지 직전)
-            commit_rpc(txn_id, clnts[i]);
-        } else {
-            // ABORT는 충돌 주입 없음
-            abort_rpc(txn_id, clnts[i]);
-        }
-        clnt_destroy(clnts[i]);
-    }
-}
-
-/* ---------- Recovery Logic ---------- */
-void run_recovery() {
-    int max_id = 0;
-    TxnRecord *records = read_all_txn_states(&max_id);
-    int i;
-
-    printf("Starting Coordinator Recovery: Scanning %d transaction logs...\n", max_id);
-
-    if (!records) return;
-
-    for (i = 0; i < max_id; i++) {
-        int txn_id = records[i].txn_id;
-        const char *state = records[i].state;
-
-        if (txn_id == 0) continue;
-
-        if (strstr(state, "DECISION") != NULL && strcmp(state, "COMPLETE") != 0) {
-            int decision = strcmp(state, "DECISION_COMMIT") == 0;
-            printf("[RECOVERY] Txn %d: Found DECISION (%s) but no COMPLETE. Resending...\n", txn_id, state);
-
-            notify_participants(txn_id, decision);
-            write_log(txn_id, "COMPLETE");
-            printf("[RECOVERY] Txn %d: Recovered successfully.\n", txn_id);
-        } else if (strcmp(state, "START") == 0) {
-            printf("[RECOVERY] Txn %d: Found START but no DECISION. Deciding ABORT...\n", txn_id);
-
-            int decision = 0;
-            write_log(txn_id, "DECISION_ABORT");
-            notify_participants(txn_id, decision);
-            write_log(txn_id, "COMPLETE");
-            printf("[RECOVERY] Txn %d: Aborted and recovered successfully.\n", txn_id);
-        }
-
-        if (txn_id >= next_txn_id) {
-            next_txn_id = txn_id + 1;
-        }
-    }
-    free(records);
-    printf("Recovery finished. Next transaction ID: %d\n", next_txn_id);
-}
-
-/* ---------- Transaction Handling (일반 실행) ---------- */
-void handle_transaction(int txn_id) {
-    int decision = 1; // 1: COMMIT, 0: ABORT
-    CLIENT *clnts[MAX_PARTICIPANTS] = {0};
-    PrepareResult *res;
-    int i;
-
-    // 참가자 연결은 Phase 1 시작 전에 한 번만 시도 (원본 코드 유지)
-    for (i = 0; i < participant_count; i++) {
-        clnts[i] = connect_to_participant(i);
-        // 연결 실패 시 ABORT 결정은 하지만, PREPARE를 보내기 전에 fail_fast 하지 않음
-        if (!clnts[i]) {
-            decision = 0;
-            fprintf(stderr, "[TXN_ERROR] P%d not connected. DECISION=ABORT.\n", i+1);
-        }
-    }
-
-    write_log(txn_id, "START");
-
-    // Phase 1: Prepare
-    for (i = 0; i < participant_count; i++) {
-        if (!clnts[i]) {
-            // 이미 연결 실패로 decision=0이 되었고, 다음 참가자로 넘어감
-            continue; 
-        }
-
-        // PREPARE RPC 호출
-        res = prepare_rpc(txn_id, clnts[i]);
-        
-        // ⚠️ 명세: send PREPARE 직후 maybe_fail("after_prepare")
-        maybe_fail("after_prepare"); 
-
-        // 명세: if no reply or VOTE_ABORT received: decision = ABORT, break
-        if (!res || res->ok == 0) {
-            if (!res) {
-                fprintf(stderr, "[TXN_ERROR] P%d (0x%lx) failed to respond to PREPARE (Timeout/RPC error)\n",
-                                 i+1, participants[i].prog_number);
-            } else {
-                fprintf(stderr, "[TXN_ABORT] P%d (0x%lx) voted NO (Result: %s). DECISION=ABORT.\n",
-                                 i+1, participants[i].prog_number, res->info);
-            }
-
-            // ABORT 결정 및 루프 종료 (명세 준수)
-            decision = 0;
-            break; 
-        }
-    }
-
-    // Phase 1 투표 결과에 따른 결정 로깅
-    write_log(txn_id, decision ? "DECISION_COMMIT" : "DECISION_ABORT");
-
-    // Phase 2: Commit/Abort - 결정에 따라 모든 참가자에게 통지합니다.
-    // ⚠️ maybe_fail("after_commit")은 notify_participants 내에서 참가자별로 호출됨.
-    notify_participants(txn_id, decision);
-
-    write_log(txn_id, "COMPLETE");
-    printf("Transaction %d completed with decision = %s\n", txn_id, decision ? "COMMIT" : "ABORT");
-
-    for (i = 0; i < participant_count; i++)
-        if (clnts[i]) clnt_destroy(clnts[i]);
+static void on_coord_error(const char *msg, void *arg) {
+    fprintf(stderr, "[ERROR] Coordinator failed: %s\n", msg);
+    *(int *)arg = 1;
 }
 
 int main(int argc, char **argv) {
     parse_args(argc, argv, &cfg);
-    load_participants(conf_file);
 
-    initial_txn_id = next_txn_id;
-
-    run_recovery();
-
-    if (next_txn_id > initial_txn_id) {
+    CoordOptions opts;
+    coord_options_init(&opts);
+    opts.conf_file = conf_file;
+    opts.fail_after_prepare = cfg.fail_after_prepare;
+    opts.fail_after_commit = cfg.fail_after_commit;
+    opts.workers = cfg.workers;
+    opts.tree_fanout = cfg.tree_fanout;
+    opts.log_backend = cfg.log_backend;
+    opts.trace_file = cfg.trace_file[0] ? cfg.trace_file : NULL;
+    opts.epoch_ms = cfg.epoch_ms;
+    opts.default_deadline_ms = cfg.deadline_ms;
+    opts.max_queue = cfg.max_queue;
+    opts.participant_limit = cfg.participant_limit;
+    opts.one_phase = cfg.one_phase;
+    if (cfg.log_file[0]) opts.log_file = cfg.log_file;
+    opts.lease_file = cfg.lease_file[0] ? cfg.lease_file : NULL;
+    opts.replica_addr = cfg.replica_addr[0] ? cfg.replica_addr : NULL;
+    opts.standby_port = cfg.standby_port;
+    int failed = 0;
+    opts.on_error = on_coord_error;
+    opts.error_arg = &failed;
+
+    // participant 로딩과 run_recovery 는 coord_open 안에서 진행됨
+    Coordinator *coord = coord_open(&opts);
+    if (!coord) exit(1);
+
+    if (coord_next_txn_id(coord) > initial_txn_id) {
         printf("[INFO] Coordinator finished recovery of Txn %d. Not starting a new transaction.\n", initial_txn_id);
     } else {
-        printf("Starting new transaction %d...\n", next_txn_id);
-        handle_transaction(next_txn_id);
+        int submitted = 0, done = 0, i;
+        CoordTxn *txn = NULL;
+
+        // --txns 개를 submit. BUSY 면 그 txn 을 들고 있다가 완료가 하나 오면 다시 submit
+        while (submitted < cfg.txns || done < submitted) {
+            if (submitted < cfg.txns) {
+                if (!txn) {
+                    txn = coord_begin(coord);
+                    if (!txn) { perror("coord_begin"); cfg.txns = submitted; continue; }
+                    for (i = 0; i < cfg.lock_count; i++)
+                        coord_txn_lock(txn, cfg.locks[i].key, cfg.locks[i].exclusive);
+                    printf("Starting new transaction %d...\n", coord_txn_id(txn));
+                }
+                int rc = coord_submit(txn, on_txn_done, &done);
+                if (rc == COORD_SUBMIT_OK) {
+                    txn = NULL;
+                    submitted++;
+                    continue;
+                }
+                if (rc == COORD_SUBMIT_BUSY) {
+                    printf("[BUSY] Transaction %d: queue full, retrying after a completion\n", coord_txn_id(txn));
+                } else {
+                    // 거절된 txn 은 호출자 소유로 남으므로 직접 정리하고 더 submit 하지 않음
+                    fprintf(stderr, "[ERROR] Transaction %d was not submitted (%s)\n", coord_txn_id(txn),
+                            rc == COORD_SUBMIT_FAILED ? "coordinator failed" : "coordinator closed");
+                    coord_txn_free(txn);
+                    txn = NULL;
+                    cfg.txns = submitted;
+                    continue;
+                }
+            }
+            struct pollfd pfd = { coord_event_fd(coord), POLLIN, 0 };
+            if (poll(&pfd, 1, -1) > 0)
+                coord_poll(coord);
+        }
     }
 
+    coord_close(coord);
     printf("Coordinator finished.\n");
-    return 0;
+    return failed ? 1 : 0;
 }
@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include "env.h"
+
+static void os_now(struct timespec *ts) {
+    clock_gettime(CLOCK_MONOTONIC, ts);
+}
+
+static void os_sleep_ms(int ms) {
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+// O_APPEND 로 write 한 번: 여러 thread 가 같은 로그에 붙여도 레코드가 섞이지 않음.
+// 일부만 쓰였으면 레코드가 잘린 것이므로 실패로 돌려줌
+static int os_append(const char *path, const char *buf, size_t len) {
+    int fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0666);
+    int err = 0;
+    ssize_t n;
+    if (fd < 0) return -errno;
+    n = len > 0 ? write(fd, buf, len) : 0;
+    if (n < 0) err = errno;
+    else if ((size_t) n != len) err = EIO;
+    else if (fsync(fd) < 0) err = errno;
+    if (close(fd) < 0 && !err) err = errno;
+    return -err;
+}
+
+static FILE *os_open_read(const char *path) {
+    return fopen(path, "r");
+}
+
+static CLIENT *os_connect(const char *host, rpcprog_t prog, rpcvers_t vers, const char *proto) {
+    return clnt_create(host, prog, vers, proto);
+}
+
+static void os_crash_point(const char *site) {
+    (void) site;
+}
+
+static const Env os_env = {
+    os_now, os_sleep_ms, os_append, os_open_read, os_connect, os_crash_point
+};
+
+const Env *env = &os_env;
+
+void env_set(const Env *e) {
+    env = e ? e : &os_env;
+}
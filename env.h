@@ -0,0 +1,35 @@
+#ifndef ENV_H
+#define ENV_H
+
+/*
+ * 시간 / 디스크 / 네트워크 접근을 모은 interface.
+ * coord_lib.c, participant_lib.c, tree.c, lock_manager.c 는 clock_gettime(CLOCK_MONOTONIC), sleep,
+ * fopen + fsync, clnt_create 를 직접 부르지 않고 env 를 거친다. 기본값은 OS 를 그대로 쓰고,
+ * sim.c 는 virtual clock / in-memory disk / 메시지를 직접 전달하는 network 로 바꿔 끼워 같은 코드를 돌린다.
+ *
+ * env 밖에 남은 것: pthread_cond_timedwait 로 기다리는 곳 (participant limit slot, epoch 모으기) 은
+ * 실제 시간으로 기다리고, io_uring log, standby 복제 socket, trace timestamp 도 OS 를 직접 쓴다.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <rpc/rpc.h>
+
+typedef struct {
+    void (*now)(struct timespec *ts);   // CLOCK_MONOTONIC
+    void (*sleep_ms)(int ms);
+    // path 끝에 buf 를 붙이고 디스크에 남을 때까지 기다림 (없으면 만듦). 한 번의 호출은 다른 호출과
+    // 섞이지 않음. 실패하면 -errno
+    int (*append)(const char *path, const char *buf, size_t len);
+    FILE *(*open_read)(const char *path); // 없으면 NULL
+    CLIENT *(*connect)(const char *host, rpcprog_t prog, rpcvers_t vers, const char *proto);
+    // failure injection 지점 (maybe_fail 의 phase, 로그 기록 직후의 "log"). 기본 env 는 아무것도 하지 않음
+    void (*crash_point)(const char *site);
+} Env;
+
+extern const Env *env;
+
+// NULL 이면 기본 (OS) env 로 되돌림. thread 를 만들기 전에 바꿀 것
+void env_set(const Env *e);
+
+#endif /* ENV_H */
@@ -0,0 +1,276 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include "lock_manager.h"
+#include "env.h"
+
+typedef struct LockOwner {
+    int txn_id;
+    LockMode mode;
+    struct LockOwner *next;
+} LockOwner;
+
+// wait-die 에서 older 라서 기다리는 txn. since_ms 부터 wait_ms 가 지나면 TIMEOUT
+typedef struct LockWaiter {
+    int txn_id;
+    long long since_ms;
+    struct LockWaiter *next;
+} LockWaiter;
+
+typedef struct LockEntry {
+    int key;
+    LockWaiter *waiters;
+    LockOwner *owners;
+    struct LockEntry *next;
+} LockEntry;
+
+// txn 이 잡고 있거나 기다리는 key 목록 (release_all 용)
+typedef struct HeldKey {
+    int txn_id;
+    int key;
+    int waiting;      // 1 이면 아직 owner 가 아니라 대기 표시만 있음
+    struct HeldKey *next;
+} HeldKey;
+
+// stripe 하나가 cache line 하나 이상을 차지하도록 정렬 -> false sharing 방지
+typedef struct {
+    pthread_mutex_t mu;
+    LockEntry *head;
+} __attribute__((aligned(LM_CACHE_LINE))) LockStripe;
+
+typedef struct {
+    pthread_mutex_t mu;
+    HeldKey *head;
+} __attribute__((aligned(LM_CACHE_LINE))) TxnStripe;
+
+static LockStripe lock_stripes[LM_STRIPES];
+static TxnStripe txn_stripes[LM_STRIPES];
+static LockPolicy lm_policy = LM_NO_WAIT;
+static int lm_wait_ms = 0;
+
+static unsigned stripe_of(int v) {
+    return ((unsigned)v * 2654435761u >> 16) & (LM_STRIPES - 1);
+}
+
+static long long now_ms(void) {
+    struct timespec ts;
+    env->now(&ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* ---------- Init ---------- */
+void lm_init(LockPolicy policy, int wait_ms) {
+    int i;
+    for (i = 0; i < LM_STRIPES; i++) {
+        pthread_mutex_init(&lock_stripes[i].mu, NULL);
+        lock_stripes[i].head = NULL;
+        pthread_mutex_init(&txn_stripes[i].mu, NULL);
+        txn_stripes[i].head = NULL;
+    }
+    lm_policy = policy;
+    lm_wait_ms = wait_ms;
+}
+
+const char *lm_policy_name(LockPolicy policy) {
+    return policy == LM_WAIT_DIE ? "wait-die" : "no-wait";
+}
+
+/* ---------- Entry helpers (stripe mutex held) ---------- */
+static LockEntry *find_entry(LockStripe *s, int key, int create) {
+    LockEntry *e;
+    for (e = s->head; e; e = e->next)
+        if (e->key == key) return e;
+    if (!create) return NULL;
+
+    e = calloc(1, sizeof(*e));
+    if (!e) { perror("calloc"); exit(1); }
+    e->key = key;
+    e->next = s->head;
+    s->head = e;
+    return e;
+}
+
+static void drop_entry_if_unused(LockStripe *s, LockEntry *e) {
+    LockEntry **pp;
+    if (e->owners || e->waiters) return;
+    for (pp = &s->head; *pp; pp = &(*pp)->next) {
+        if (*pp == e) {
+            *pp = e->next;
+            free(e);
+            return;
+        }
+    }
+}
+
+static LockWaiter **find_waiter(LockEntry *e, int txn_id) {
+    LockWaiter **pp;
+    for (pp = &e->waiters; *pp; pp = &(*pp)->next)
+        if ((*pp)->txn_id == txn_id) return pp;
+    return NULL;
+}
+
+static void drop_waiter(LockEntry *e, int txn_id) {
+    LockWaiter **pp = find_waiter(e, txn_id), *dead;
+    if (!pp) return;
+    dead = *pp;
+    *pp = dead->next;
+    free(dead);
+}
+
+// 같은 (txn, key) 가 이미 있으면 waiting 만 갱신 (대기하던 key 를 얻었을 때)
+static void remember_held(int txn_id, int key, int waiting) {
+    TxnStripe *t = &txn_stripes[stripe_of(txn_id)];
+    HeldKey *h;
+    pthread_mutex_lock(&t->mu);
+    for (h = t->head; h; h = h->next) {
+        if (h->txn_id == txn_id && h->key == key) {
+            h->waiting = waiting;
+            pthread_mutex_unlock(&t->mu);
+            return;
+        }
+    }
+    h = malloc(sizeof(*h));
+    if (!h) { perror("malloc"); exit(1); }
+    h->txn_id = txn_id;
+    h->key = key;
+    h->waiting = waiting;
+    h->next = t->head;
+    t->head = h;
+    pthread_mutex_unlock(&t->mu);
+}
+
+/* ---------- Acquire ---------- */
+LockResult lm_acquire(int txn_id, int key, LockMode mode) {
+    LockStripe *s = &lock_stripes[stripe_of(key)];
+    LockEntry *e;
+    LockOwner *own = NULL, *o;
+    LockWaiter **wp, *w;
+    int conflict = 0, oldest_conflict = 0;
+
+    pthread_mutex_lock(&s->mu);
+    e = find_entry(s, key, 1);
+    for (o = e->owners; o; o = o->next) {
+        if (o->txn_id == txn_id) { own = o; continue; }
+        if (mode == LM_EXCLUSIVE || o->mode == LM_EXCLUSIVE) {
+            if (!conflict || o->txn_id < oldest_conflict) oldest_conflict = o->txn_id;
+            conflict = 1;
+        }
+    }
+    wp = find_waiter(e, txn_id);
+
+    // 이미 같은 이상의 모드로 보유 (PREPARE 재전송 등)
+    if (own && (own->mode == LM_EXCLUSIVE || mode == LM_SHARED)) {
+        pthread_mutex_unlock(&s->mu);
+        return LM_GRANTED;
+    }
+
+    if (!conflict) {
+        drop_waiter(e, txn_id);
+        if (own) {
+            own->mode = LM_EXCLUSIVE; // S -> X upgrade, held 목록은 이미 있음
+            pthread_mutex_unlock(&s->mu);
+            return LM_GRANTED;
+        }
+        own = malloc(sizeof(*own));
+        if (!own) { perror("malloc"); exit(1); }
+        own->txn_id = txn_id;
+        own->mode = mode;
+        own->next = e->owners;
+        e->owners = own;
+        pthread_mutex_unlock(&s->mu);
+        remember_held(txn_id, key, 0); // 대기하던 key 면 waiting -> held
+        return LM_GRANTED;
+    }
+
+    // no-wait 이거나, wait-die 에서 충돌 상대보다 younger 면 die
+    if (lm_policy == LM_NO_WAIT || txn_id > oldest_conflict) {
+        drop_waiter(e, txn_id);
+        drop_entry_if_unused(s, e);
+        pthread_mutex_unlock(&s->mu);
+        return LM_DIE;
+    }
+
+    // wait-die: older 는 대기 표시를 남기고 LM_WAIT. 처음 표시한 때부터 wait_ms 가 지나면 TIMEOUT
+    if (lm_wait_ms <= 0 || (wp && now_ms() - (*wp)->since_ms >= lm_wait_ms)) {
+        drop_waiter(e, txn_id);
+        drop_entry_if_unused(s, e);
+        pthread_mutex_unlock(&s->mu);
+        return LM_TIMEOUT;
+    }
+    if (wp) {
+        pthread_mutex_unlock(&s->mu);
+        return LM_WAIT;
+    }
+    w = malloc(sizeof(*w));
+    if (!w) { perror("malloc"); exit(1); }
+    w->txn_id = txn_id;
+    w->since_ms = now_ms();
+    w->next = e->waiters;
+    e->waiters = w;
+    pthread_mutex_unlock(&s->mu);
+    if (!own) remember_held(txn_id, key, 1);
+    return LM_WAIT;
+}
+
+/* ---------- Release ---------- */
+static void release_one(int txn_id, int key) {
+    LockStripe *s = &lock_stripes[stripe_of(key)];
+    LockEntry *e;
+    LockOwner **pp;
+
+    pthread_mutex_lock(&s->mu);
+    e = find_entry(s, key, 0);
+    if (e) {
+        for (pp = &e->owners; *pp; pp = &(*pp)->next) {
+            if ((*pp)->txn_id == txn_id) {
+                LockOwner *dead = *pp;
+                *pp = dead->next;
+                free(dead);
+                break;
+            }
+        }
+        drop_waiter(e, txn_id);
+        drop_entry_if_unused(s, e);
+    }
+    pthread_mutex_unlock(&s->mu);
+}
+
+void lm_release_all(int txn_id) {
+    TxnStripe *t = &txn_stripes[stripe_of(txn_id)];
+    HeldKey *mine = NULL, **pp, *h;
+
+    // txn stripe 에서 먼저 떼어낸 뒤 lock stripe 를 하나씩 잡음 (lock 순서 역전 방지)
+    pthread_mutex_lock(&t->mu);
+    pp = &t->head;
+    while (*pp) {
+        h = *pp;
+        if (h->txn_id == txn_id) {
+            *pp = h->next;
+            h->next = mine;
+            mine = h;
+        } else {
+            pp = &h->next;
+        }
+    }
+    pthread_mutex_unlock(&t->mu);
+
+    while (mine) {
+        h = mine;
+        mine = h->next;
+        release_one(txn_id, h->key);
+        free(h);
+    }
+}
+
+int lm_held_count(int txn_id) {
+    TxnStripe *t = &txn_stripes[stripe_of(txn_id)];
+    HeldKey *h;
+    int n = 0;
+
+    pthread_mutex_lock(&t->mu);
+    for (h = t->head; h; h = h->next)
+        if (h->txn_id == txn_id && !h->waiting) n++;
+    pthread_mutex_unlock(&t->mu);
+    return n;
+}
@@ -0,0 +1,41 @@
+#ifndef LOCK_MANAGER_H
+#define LOCK_MANAGER_H
+
+/*
+ * Participant lock table.
+ * key -> lock 은 cache-line 단위로 패딩된 stripe 들에 해시되어 분산되고,
+ * stripe 마다 mutex 를 따로 두어 서로 다른 key 끼리는 경합하지 않는다.
+ * deadlock 은 no-wait 또는 wait-die 정책으로 회피한다 (txn_id 가 작을수록 older).
+ * lm_acquire 는 blocking 하지 않는다: wait-die 에서 기다려야 하는 older txn 은 LM_WAIT 를 받고
+ * (그 key 에 대기 표시가 남고 이미 잡은 lock 은 유지됨) 호출자가 나중에 다시 시도한다.
+ * 대기 표시가 생긴 지 wait_ms 가 지나면 LM_TIMEOUT. svc_run 처럼 단일 thread 로 요청을 처리하는
+ * 쪽이 lock 을 기다리느라 다른 요청 (lock 을 풀어 줄 COMMIT/ABORT 포함) 을 막지 않게 하기 위함.
+ */
+
+#define LM_STRIPES 64
+#define LM_CACHE_LINE 64
+
+typedef enum {
+    LM_SHARED = 0,
+    LM_EXCLUSIVE = 1
+} LockMode;
+
+typedef enum {
+    LM_NO_WAIT = 0,   // 충돌 즉시 실패
+    LM_WAIT_DIE = 1   // older 는 대기 (LM_WAIT), younger 는 즉시 실패
+} LockPolicy;
+
+typedef enum {
+    LM_GRANTED = 0,
+    LM_DIE = 1,       // 충돌로 실패 (호출자는 txn 을 abort 해야 함)
+    LM_TIMEOUT = 2,   // wait-die 대기 중 wait_ms 초과
+    LM_WAIT = 3       // wait-die: older 라 기다려야 함. 잡은 lock 은 유지하고 나중에 다시 lm_acquire
+} LockResult;
+
+void lm_init(LockPolicy policy, int wait_ms);
+LockResult lm_acquire(int txn_id, int key, LockMode mode);
+void lm_release_all(int txn_id);       // 잡은 lock 과 대기 표시를 모두 정리
+int lm_held_count(int txn_id);         // 대기 중인 key 는 세지 않음
+const char *lm_policy_name(LockPolicy policy);
+
+#endif /* LOCK_MANAGER_H */
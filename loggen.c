@@ -0,0 +1,165 @@
+/*
+ * Synthetic log generator for recovery benchmarks.
+ * coordinator 의 txn.log 와 participant 들의 txn_<id>.log 를 서로 맞는 내용으로 만든다.
+ * txn 마다 종류를 고른다:
+ *   - complete   : START / DECISION_* / COMPLETE, participant 는 모두 결정을 기록
+ *   - undecided  : START / DECISION_* (COMPLETE 없음), participant 는 --in-doubt 확률로 PREPARED 에 머묾
+ *   - start-only : START 만, participant 는 --in-doubt 확률로 PREPARED, 아니면 기록 없음
+ * PREPARED 레코드에는 txn 마다 겹치지 않는 key 로 --locks 개의 X lock 을 붙여
+ * participant 재시작 때 lock 복원 비용까지 포함되게 한다. 같은 seed 는 항상 같은 로그를 만든다.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <getopt.h>
+
+#define LOGGEN_MAX_PARTICIPANTS 64
+
+typedef struct {
+    long txns;
+    int participants;
+    double start_only;   // START 만 남은 txn 비율
+    double undecided;    // DECISION 은 있고 COMPLETE 가 없는 txn 비율
+    double in_doubt;     // 미완료 txn 에서 participant 가 PREPARED 로 남아 있을 확률
+    double commit;       // 결정이 COMMIT 일 확률
+    int locks;
+    uint64_t seed;
+    const char *dir;
+} GenConfig;
+
+/* ---------- RNG (xorshift64*) ---------- */
+static uint64_t rng;
+
+static uint64_t rnd(void) {
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return rng * 2685821657736338717ULL;
+}
+
+static int chance(double p) {
+    return p > 0 && (rnd() >> 11) * (1.0 / 9007199254740992.0) < p;
+}
+
+/* ---------- Output ---------- */
+static FILE *open_log(const char *dir, const char *name) {
+    char path[512];
+    FILE *f;
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    f = fopen(path, "w");
+    if (!f) { perror(path); exit(1); }
+    setvbuf(f, NULL, _IOFBF, 1 << 20);
+    return f;
+}
+
+static void write_prepared(FILE *f, const GenConfig *g, long id) {
+    int j;
+    fprintf(f, "%ld PREPARED YES", id);
+    for (j = 0; j < g->locks; j++)
+        fprintf(f, " X:%ld", id * g->locks + j);
+    fputc('\n', f);
+}
+
+/* ---------- CLI ---------- */
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [OPTIONS]\n"
+        "--txns <n>            (txn 수, 기본 100000)\n"
+        "--participants <n>    (participant 수, 기본 3)\n"
+        "--start-only <p>      (START 만 남은 txn 비율, 기본 0.01)\n"
+        "--undecided <p>       (DECISION 뒤 COMPLETE 가 없는 txn 비율, 기본 0.01)\n"
+        "--in-doubt <p>        (미완료 txn 에서 participant 가 PREPARED 로 남을 확률, 기본 0.5)\n"
+        "--commit <p>          (COMMIT 결정 비율, 기본 0.9)\n"
+        "--locks <n>           (PREPARED 레코드당 lock 수, 기본 2)\n"
+        "--seed <n>\n"
+        "--dir <path>          (출력 디렉터리, 기본 .)\n"
+        "-h,--help\n",
+        prog);
+}
+
+int main(int argc, char **argv) {
+    GenConfig g = { 100000, 3, 0.01, 0.01, 0.5, 0.9, 2, 1, "." };
+    FILE *coord, *parts[LOGGEN_MAX_PARTICIPANTS];
+    long id, n_start = 0, n_undecided = 0, n_in_doubt = 0;
+    int p;
+
+    static struct option long_opts[] = {
+        {"txns", required_argument, 0, 'n'},
+        {"participants", required_argument, 0, 'p'},
+        {"start-only", required_argument, 0, 1},
+        {"undecided", required_argument, 0, 2},
+        {"in-doubt", required_argument, 0, 3},
+        {"commit", required_argument, 0, 4},
+        {"locks", required_argument, 0, 5},
+        {"seed", required_argument, 0, 's'},
+        {"dir", required_argument, 0, 'd'},
+        {"help", no_argument, 0, 'h'},
+        {0,0,0,0}
+    };
+
+    int opt, index = 0;
+    while ((opt = getopt_long(argc, argv, "n:p:s:d:h", long_opts, &index)) != -1) {
+        switch (opt) {
+            case 'n': g.txns = atol(optarg); break;
+            case 'p': g.participants = atoi(optarg); break;
+            case 1: g.start_only = atof(optarg); break;
+            case 2: g.undecided = atof(optarg); break;
+            case 3: g.in_doubt = atof(optarg); break;
+            case 4: g.commit = atof(optarg); break;
+            case 5: g.locks = atoi(optarg); break;
+            case 's': g.seed = strtoull(optarg, NULL, 0); break;
+            case 'd': g.dir = optarg; break;
+            case 'h':
+            default: print_usage(argv[0]); exit(opt=='h'?0:1);
+        }
+    }
+    if (g.participants < 1) g.participants = 1;
+    if (g.participants > LOGGEN_MAX_PARTICIPANTS) g.participants = LOGGEN_MAX_PARTICIPANTS;
+    if (g.locks < 0) g.locks = 0;
+    rng = g.seed * 0x9E3779B97F4A7C15ULL + 1;
+
+    coord = open_log(g.dir, "txn.log");
+    for (p = 0; p < g.participants; p++) {
+        char name[32];
+        snprintf(name, sizeof(name), "txn_%d.log", p + 1);
+        parts[p] = open_log(g.dir, name);
+    }
+
+    for (id = 1; id <= g.txns; id++) {
+        int start_only = chance(g.start_only);
+        int undecided = !start_only && chance(g.undecided);
+        int decision = !start_only && chance(g.commit);
+
+        fprintf(coord, "%ld START\n", id);
+        if (!start_only)
+            fprintf(coord, "%ld %s\n", id, decision ? "DECISION_COMMIT" : "DECISION_ABORT");
+        if (!start_only && !undecided)
+            fprintf(coord, "%ld COMPLETE\n", id);
+        n_start += start_only;
+        n_undecided += undecided;
+
+        for (p = 0; p < g.participants; p++) {
+            FILE *f = parts[p];
+            if (start_only || undecided) {
+                // 결정이 participant 까지 가지 못한 상태
+                if (chance(g.in_doubt)) {
+                    write_prepared(f, &g, id);
+                    n_in_doubt++;
+                    continue;
+                }
+                if (start_only) continue;
+            }
+            // COMMIT 이면 모두 PREPARED 였고, ABORT 면 일부만 PREPARED 까지 갔음
+            if (decision || chance(0.5)) write_prepared(f, &g, id);
+            fprintf(f, "%ld %s\n", id, decision ? "COMMITTED" : "ABORT");
+        }
+    }
+
+    fclose(coord);
+    for (p = 0; p < g.participants; p++) fclose(parts[p]);
+
+    printf("txns=%ld participants=%d start_only=%ld undecided=%ld in_doubt_records=%ld seed=%llu dir=%s\n",
+           g.txns, g.participants, n_start, n_undecided, n_in_doubt, (unsigned long long)g.seed, g.dir);
+    return 0;
+}
@@ -1,170 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
 #include <getopt.h>
 #include <rpc/rpc.h>
-#include <fcntl.h>
-#include <stdbool.h>
-#include <sys/types.h>
-#include <sys/stat.h>
+#include <signal.h>
+#include <time.h>
 #include "commit.h"
+#include "trace.h"
+#include "participant_lib.h"
 
-#define INFO_MSG_SIZE 256
-
-static char log_file[256];
-
-typedef struct {
-    int id;
-    unsigned long prog_number;
-    char coord_host[256];
-    int fail_on_prepare;
-    int fail_after_prepare;
-    int fail_on_commit;
-    int fail_on_abort;
-    int fail_after_commit;
-} Config;
-
-static Config cfg;
-
-/* ---------- Logging helpers ---------- */
-void write_log(int txn_id, const char *state, const char *vote) {
-    FILE *f = fopen(log_file, "a+");
-    if (!f) { perror("fopen"); exit(1); }
-
-    // Log "PREPARED YES/NO" or other simple states
-    if (strcmp(state, "PREPARED") == 0 && vote != NULL) {
-        fprintf(f, "%d %s %s\n", txn_id, state, vote);
-    }
-    else {
-        fprintf(f, "%d %s\n", txn_id, state);
-    }
-
-    fflush(f);
-    fsync(fileno(f));
-    fclose(f);
-}
-
-char *read_last_state(int txn_id) {
-    FILE *f = fopen(log_file, "r");
-    if (!f) return NULL;
-    static char last_state[INFO_MSG_SIZE];
-    last_state[0] = '\0';
-    char line[INFO_MSG_SIZE];
-    char state[INFO_MSG_SIZE];
-    char vote[INFO_MSG_SIZE];
-    int id;
-
-    // Find the last recorded state for the transaction ID
-    while (fgets(line, sizeof(line), f)) {
-        if (sscanf(line, "%d %255s %255s", &id, state, vote) >= 2 && id == txn_id) {
-            strncpy(last_state, state, sizeof(last_state) - 1);
-            last_state[sizeof(last_state) - 1] = '\0';
-        }
-    }
-
-    fclose(f);
-    return strlen(last_state) ? last_state : NULL;
-}
-
-/* ---------- Failure injection helper ---------- */
-void maybe_fail(const char *phase) {
-    
-    bool should_fail = false;
-
-    if ((strcmp(phase, "prepare") == 0 && cfg.fail_on_prepare) ||
-        (strcmp(phase, "after_prepare") == 0 && cfg.fail_after_prepare) ||
-        (strcmp(phase, "commit") == 0 && cfg.fail_on_commit) ||
-        (strcmp(phase, "abort") == 0 && cfg.fail_on_abort))
-    {
-        should_fail = true;
-    }
-
-    if (should_fail)
-    {
-        fprintf(stderr, "[FAILURE] P%d Simulating crash during %s\n", cfg.id, phase);
-        exit(99);
-    }
-}
-
-/* ---------- RPC handlers ---------- */
-PrepareResult *prepare_1_svc(TxnID arg, struct svc_req *rqstp) {
-    static PrepareResult result;
-    static char info_buf[INFO_MSG_SIZE];
-    result.info = info_buf;
-    info_buf[0] = '\0';
-
-    // 1. maybe_fail("prepare")
-    maybe_fail("prepare");
-
-    fprintf(stderr, "[DEBUG] P%d Received PREPARE for Txn %d\n", cfg.id, arg.txn_id);
-
-    // 2. Check for previous ABORT decision
-    char *prev = read_last_state(arg.txn_id);
-    if (prev && (strcmp(prev, "ABORT") == 0 || strcmp(prev, "ABORTED") == 0)) {
-        fprintf(stderr, "[DEBUG] P%d Voted ABORT (NO) due to previous ABORT log.\n", cfg.id);
-        result.ok = 0;
-        snprintf(result.info, sizeof(info_buf), "Voted ABORT (Previous log)");
-        return &result;
-    }
-
-    // 3. If can_commit(data) == TRUE: (No fail_on_prepare flag)
-    if (!cfg.fail_on_prepare) {
-
-        // Log PREPARED YES
-        write_log(arg.txn_id, "PREPARED", "YES");
-
-        // maybe_fail("after_prepare")
-        maybe_fail("after_prepare");
-
-        // return VOTE_COMMIT
-        result.ok = 1;
-        snprintf(result.info, sizeof(info_buf), "Prepared");
-        return &result;
-    }
-    // 4. Else (can't commit / fail_on_prepare is set): VOTE_ABORT
-    else {
-        // VOTE_ABORT 시 로그 기록을 생략합니다 (최종 ABORT 통지 시에만 로깅).
-
-        // return VOTE_ABORT
-        result.ok = 0;
-        snprintf(result.info, sizeof(info_buf), "Voted ABORT (Can't commit/Fail flag)");
-        return &result;
-    }
-}
-
-int *commit_1_svc(TxnID arg, struct svc_req *rqstp) {
-    static int ack = 1;
-
-    // maybe_fail("commit")
-    maybe_fail("commit");
-
-    // write_log("COMMIT", transaction_id)
-    write_log(arg.txn_id, "COMMITTED", NULL); 
-    return &ack;
-}
-
-int *abort_1_svc(TxnID arg, struct svc_req *rqstp) {
-    static int ack = 1;
-
-    // maybe_fail("abort")
-    maybe_fail("abort");
-
-    // write_log("ABORT", transaction_id) - 명세에 맞춰 "ABORT" 사용
-    write_log(arg.txn_id, "ABORT", NULL); 
-
-    return &ack;
-}
-
-int *status_1_svc(TxnID arg, struct svc_req *rqstp) {
-    static int status = 0;
-    char *prev = read_last_state(arg.txn_id);
-    if (!prev) status = 0;
-    else if (strcmp(prev, "COMMITTED") == 0) status = 1;
-    else if (strcmp(prev, "PREPARED") == 0) status = 2; 
-    else status = 0;
-    return &status;
-}
+static ParticipantConfig cfg;
 
 /* ---------- Command-line parsing ---------- */
 void print_usage(const char *prog) {
@@ -178,14 +23,21 @@ void print_usage(const char *prog) {
         "  --fail-after-prepare\n"
         "  --fail-on-commit\n"
         "  --fail-on-abort\n"
-        "  --fail-after-commit\n"
+        "  --fail-after-commit  (COMMITTED 기록 후 ack / subtree 전달 전에 crash)\n"
+        "  --lock-policy <no-wait|wait-die>\n"
+        "  --lock-wait-ms <n>   (wait-die 에서 older txn 의 최대 대기 시간)\n"
+        "  --log-backend <fsync|uring>\n"
+        "  --trace <file>       (span 을 Chrome trace JSON 으로 덤프)\n"
+        "  --recover-only       (로그 scan + lock 복원까지만 하고 시간 출력 후 종료, 벤치마크용)\n"
+        "  --drc-size <n>       (duplicate request cache 크기, 기본 1024, 0 = 끔)\n"
         "  -h, --help\n",
         prog);
 }
 
-void parse_args(int argc, char *argv[], Config *cfgp) {
+void parse_args(int argc, char *argv[], ParticipantConfig *cfgp) {
     memset(cfgp, 0, sizeof(*cfgp));
     strcpy(cfgp->coord_host, "localhost");
+    cfgp->drc_size = DRC_DEFAULT_SIZE;
 
     static struct option long_opts[] = {
         {"id", required_argument, 0, 'i'},
@@ -196,6 +48,12 @@ void parse_args(int argc, char *argv[], Config *cfgp) {
         {"fail-on-commit", no_argument, 0, 3},
         {"fail-after-commit", no_argument, 0, 4},
         {"fail-on-abort", no_argument, 0, 5},
+        {"lock-policy", required_argument, 0, 6},
+        {"lock-wait-ms", required_argument, 0, 7},
+        {"log-backend", required_argument, 0, 8},
+        {"trace", required_argument, 0, 9},
+        {"recover-only", no_argument, 0, 10},
+        {"drc-size", required_argument, 0, 11},
         {"help", no_argument, 0, 'h'},
         {0,0,0,0}
     };
@@ -218,6 +76,23 @@ void parse_args(int argc, char *argv[], Config *cfgp) {
             case 3: cfgp->fail_on_commit = 1; break;
             case 4: cfgp->fail_after_commit = 1; break;
             case 5: cfgp->fail_on_abort = 1; break;
+            case 6:
+                if (strcmp(optarg, "wait-die") == 0) cfgp->lock_policy = LM_WAIT_DIE;
+                else if (strcmp(optarg, "no-wait") == 0) cfgp->lock_policy = LM_NO_WAIT;
+                else { fprintf(stderr, "[ERROR] unknown --lock-policy '%s'\n", optarg); exit(1); }
+                break;
+            case 7: cfgp->lock_wait_ms = atoi(optarg); break;
+            case 8:
+                if (strcmp(optarg, "uring") == 0) cfgp->use_uring = 1;
+                else if (strcmp(optarg, "fsync") == 0) cfgp->use_uring = 0;
+                else { fprintf(stderr, "[ERROR] unknown --log-backend '%s'\n", optarg); exit(1); }
+                break;
+            case 9:
+                strncpy(cfgp->trace_file, optarg, sizeof(cfgp->trace_file)-1);
+                cfgp->trace_file[sizeof(cfgp->trace_file)-1] = '\0';
+                break;
+            case 10: cfgp->recover_only = 1; break;
+            case 11: cfgp->drc_size = atoi(optarg); break;
             case 'h':
             default:
                 print_usage(argv[0]);
@@ -229,87 +104,59 @@ void parse_args(int argc, char *argv[], Config *cfgp) {
         fprintf(stderr, "[ERROR] --prog <number> must be provided.\n");
         exit(1);
     }
-
-    snprintf(log_file, sizeof(log_file), "txn_%d.log", cfgp->id);
 }
 
-/* ---------- RPC dispatch glue ---------- */
-#ifndef SIG_PF
-#define SIG_PF void(*)(int)
-#endif
+// kill(SIGTERM) 으로 내려도 atexit 의 trace_dump 가 돌도록: handler 는 flag 만 세우고 participant_serve 가 보고 돌아옴
+static volatile sig_atomic_t stop_requested = 0;
 
-static PrepareResult *_prepare_1(TxnID *argp, struct svc_req *rqstp) { return prepare_1_svc(*argp, rqstp); }
-static int *_commit_1(TxnID *argp, struct svc_req *rqstp) { return commit_1_svc(*argp, rqstp); }
-static int *_abort_1(TxnID *argp, struct svc_req *rqstp) { return abort_1_svc(*argp, rqstp); }
-static int *_status_1(TxnID *argp, struct svc_req *rqstp) { return status_1_svc(*argp, rqstp); }
-
-static void
-commit_prog_1(struct svc_req *rqstp, register SVCXPRT *transp)
-{
-    union {
-        TxnID prepare_1_arg;
-        TxnID commit_1_arg;
-        TxnID abort_1_arg;
-        TxnID status_1_arg;
-    } argument;
-    char *result;
-    xdrproc_t _xdr_argument, _xdr_result;
-    char *(*local)(char *, struct svc_req *);
-
-    switch (rqstp->rq_proc) {
-    case NULLPROC:
-        (void) svc_sendreply (transp, (xdrproc_t) xdr_void, (char *)NULL);
-        return;
-    case PREPARE:
-        _xdr_argument = (xdrproc_t) xdr_TxnID; _xdr_result = (xdrproc_t) xdr_PrepareResult; local = (char *(*)(char *, struct svc_req *)) _prepare_1; break;
-    case COMMIT:
-        _xdr_argument = (xdrproc_t) xdr_TxnID; _xdr_result = (xdrproc_t) xdr_int; local = (char *(*)(char *, struct svc_req *)) _commit_1; break;
-    case ABORT:
-        _xdr_argument = (xdrproc_t) xdr_TxnID; _xdr_result = (xdrproc_t) xdr_int; local = (char *(*)(char *, struct svc_req *)) _abort_1; break;
-    case STATUS:
-        _xdr_argument = (xdrproc_t) xdr_TxnID; _xdr_result = (xdrproc_t) xdr_int; local = (char *(*)(char *, struct svc_req *)) _status_1; break;
-    default:
-        svcerr_noproc (transp); return;
-    }
+static void on_sigterm(int sig) {
+    (void) sig;
+    stop_requested = 1;
+}
 
-    memset ((char *)&argument, 0, sizeof (argument));
-    if (!svc_getargs (transp, (xdrproc_t) _xdr_argument, (caddr_t) &argument)) { svcerr_decode (transp); return; }
-    result = (*local)((char *)&argument, rqstp);
-    if (result != NULL && !svc_sendreply(transp, (xdrproc_t) _xdr_result, result)) { svcerr_systemerr (transp); }
-    if (!svc_freeargs (transp, (xdrproc_t) _xdr_argument, (caddr_t) &argument)) { fprintf (stderr, "%s", "unable to free arguments"); exit (1); }
-    return;
+static double elapsed_ms(const struct timespec *since) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1e3 + (now.tv_nsec - since->tv_nsec) / 1e6;
 }
 
 int main(int argc, char **argv) {
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
     parse_args(argc, argv, &cfg);
 
-    register SVCXPRT *transp;
-    pmap_unset(cfg.prog_number, COMMIT_VERS);
-
+    if (cfg.trace_file[0]) {
+        char name[32];
+        snprintf(name, sizeof(name), "participant %d", cfg.id);
+        trace_init(cfg.trace_file, name);
+    }
     {
-        FILE *f = fopen(log_file, "a+");
-        if (f) fclose(f);
-        else fprintf(stderr, "[WARN] P%d could not create log file '%s'\n", cfg.id, log_file);
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = on_sigterm;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGTERM, &sa, NULL);
     }
 
-    transp = svcudp_create(RPC_ANYSOCK);
-    if (!transp) { fprintf(stderr, "cannot create udp service.\n"); exit(1); }
-    if (!svc_register(transp, cfg.prog_number, COMMIT_VERS, commit_prog_1, IPPROTO_UDP)) {
-        fprintf(stderr, "unable to register (0x%lx, COMMIT_VERS, udp).\n", cfg.prog_number);
-        exit(1);
-    }
+    if (!cfg.recover_only)
+        pmap_unset(cfg.prog_number, COMMIT_VERS);
 
-    transp = svctcp_create(RPC_ANYSOCK, 0, 0);
-    if (!transp) { fprintf(stderr, "cannot create tcp service.\n"); exit(1); }
-    if (!svc_register(transp, cfg.prog_number, COMMIT_VERS, commit_prog_1, IPPROTO_TCP)) {
-        fprintf(stderr, "unable to register (0x%lx, COMMIT_VERS, tcp).\n", cfg.prog_number);
-        exit(1);
+    participant_init(&cfg);
+
+    if (cfg.recover_only) {
+        int txns, in_doubt;
+        participant_recovery_stats(&txns, &in_doubt);
+        printf("Participant %d recovery: %d txn(s), %d in doubt, %.3f ms\n", cfg.id, txns, in_doubt, elapsed_ms(&started));
+        participant_close();
+        return 0;
     }
 
-    printf("Participant %d (Prog: 0x%lx) running. Log file: %s\n",
-           cfg.id, cfg.prog_number, log_file);
+    participant_listen();
+
+    printf("Participant %d (Prog: 0x%lx) running. Log file: txn_%d.log (startup %.3f ms)\n",
+           cfg.id, cfg.prog_number, cfg.id, elapsed_ms(&started));
+    fflush(stdout);
 
-    svc_run();
-    fprintf(stderr, "svc_run returned unexpectedly\n");
-    exit(1);
+    participant_serve(&stop_requested);
+    return 0; // 응답한 레코드는 모두 기록을 마친 뒤라 ulog 는 닫지 않음 (tree mode 전달 thread 가 쓰고 있을 수 있음)
 }
@@ -0,0 +1,1444 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <rpc/rpc.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include "commit.h"
+#include "lock_manager.h"
+#include "tree.h"
+#include "uring_log.h"
+#include "trace.h"
+#include "xdr_fast.h"
+#include "env.h"
+#include "participant_lib.h"
+
+#define INFO_MSG_SIZE 256
+#define LOG_LINE_SIZE 512 // PREPARED 레코드에 lock 목록이 붙으므로 여유 있게
+#define DRC_MAX_REPLY 2048  // 가장 큰 응답 (EpochVotes, MAX_EPOCH_TXNS 개) 보다 큼
+
+static char log_file[256];
+static UringLog *ulog = NULL; // --log-backend uring
+static uint64_t cur_trace_id = 0; // 처리 중인 요청의 trace id (svc_run 은 단일 thread)
+
+static ParticipantConfig cfg;
+
+/* ---------- Logging helpers ---------- */
+// tree mode 의 결정 전달 thread 도 기록하므로 fsync 경로는 mutex 로 한 레코드씩 (ulog 는 thread-safe)
+static pthread_mutex_t log_mu = PTHREAD_MUTEX_INITIALIZER;
+
+// 이미 만들어 둔 여러 줄의 레코드를 한 번의 fsync 로 기록
+static void append_log(const char *buf, size_t len) {
+    int rc;
+    if (ulog) {
+        // 응답 전에 완료를 기다려야 함 (write+fdatasync 를 한 번에 submit)
+        rc = ulog_append_sync(ulog, buf, len);
+    } else {
+        pthread_mutex_lock(&log_mu);
+        rc = env->append(log_file, buf, len);
+        pthread_mutex_unlock(&log_mu);
+    }
+    if (rc < 0) { fprintf(stderr, "[ERROR] log append failed: %s\n", strerror(-rc)); exit(1); }
+    env->crash_point("log");
+}
+
+// "<id> <state> [<vote>]". PREPARED 의 vote 에는 lock / subtree 목록이 붙어 길 수 있음: line 에 넘치면 할당해서 돌려줌
+static char *format_record(char *line, size_t cap, int txn_id, const char *state, const char *vote, int *len) {
+    char *buf = line;
+    if (vote != NULL)
+        *len = snprintf(line, cap, "%d %s %s\n", txn_id, state, vote);
+    else
+        *len = snprintf(line, cap, "%d %s\n", txn_id, state);
+    if (*len >= (int) cap) {
+        buf = malloc(*len + 1);
+        if (!buf) { perror("malloc"); exit(1); }
+        snprintf(buf, *len + 1, "%d %s %s\n", txn_id, state, vote);
+    }
+    return buf;
+}
+
+void write_log(int txn_id, const char *state, const char *vote) {
+    uint64_t t0 = trace_now();
+    char line[LOG_LINE_SIZE], *buf;
+    int len;
+
+    buf = format_record(line, sizeof(line), txn_id, state, vote, &len);
+    append_log(buf, len);
+    if (buf != line) free(buf);
+    trace_span("log_fsync", txn_id, cur_trace_id, t0, state);
+}
+
+/* ---------- Deferred reply (io_uring) ---------- */
+// --log-backend uring 에서 UDP 로 온 PREPARE / COMMIT / ABORT 는 레코드를 submit 만 하고 handler 가 NULL 을
+// 돌려줌 (응답 없음). fdatasync 가 끝나면 completion thread 가 요청을 done 목록에 넣고 eventfd 로 participant_serve 를
+// 깨우며, svc thread 가 나머지 (lock 해제, DRC, 응답) 를 마친다. 기다리는 동안 svc thread 는 다른 txn 을 처리.
+// 응답은 TI-RPC 가 요청을 처리하는 동안에만 보낼 수 있으므로 xid 와 client 주소를 저장해 두고 직접 encode 해 보냄
+typedef struct Deferred {
+    rpcproc_t proc;
+    int txn_id;
+    uint64_t trace_id;
+    uint64_t submitted;           // trace: submit 시각
+    uint32_t xid;
+    struct sockaddr_storage addr; // 응답을 보낼 client
+    socklen_t addr_len;
+    int res;                      // 기록 결과 (completion thread 가 채움)
+    struct Deferred *next;        // pending 목록 (svc thread 만)
+    struct Deferred *done_next;   // done 목록 (done_mu)
+} Deferred;
+
+static __thread Deferred *cur_defer = NULL; // 지금 svc thread 가 처리 중인 요청을 미룰 수 있으면 그 요청
+static Deferred *deferred_pending = NULL;   // 기록 중인 요청 (svc thread 만)
+static Deferred *deferred_done = NULL;
+static pthread_mutex_t done_mu = PTHREAD_MUTEX_INITIALIZER;
+static int done_fd = -1;                    // eventfd, -1 이면 미루지 않음
+static SVCXPRT *udp_xprt = NULL;
+static unsigned long deferred_replies = 0;
+
+static void deferred_written(int res, void *arg) {
+    Deferred *d = arg;
+    uint64_t one = 1;
+    d->res = res;
+    pthread_mutex_lock(&done_mu);
+    d->done_next = deferred_done;
+    deferred_done = d;
+    pthread_mutex_unlock(&done_mu);
+    if (write(done_fd, &one, sizeof(one)) != sizeof(one)) perror("eventfd write");
+}
+
+// 지금 요청을 미룰 수 있으면 레코드를 submit 하고 1 (handler 는 NULL 을 돌려줌), 아니면 write_log 로 기록하고 0
+static int write_log_deferred(int txn_id, const char *state, const char *vote) {
+    Deferred *d = cur_defer;
+    char line[LOG_LINE_SIZE], *buf;
+    int len, rc;
+
+    if (!d) {
+        write_log(txn_id, state, vote);
+        return 0;
+    }
+    cur_defer = NULL;
+    d->trace_id = cur_trace_id;
+    d->submitted = trace_now();
+    buf = format_record(line, sizeof(line), txn_id, state, vote, &len);
+    rc = ulog_append(ulog, buf, len, deferred_written, d);
+    if (buf != line) free(buf);
+    if (rc < 0) { fprintf(stderr, "[ERROR] log append failed: %s\n", strerror(-rc)); exit(1); }
+    d->next = deferred_pending;
+    deferred_pending = d;
+    trace_span("log_submit", txn_id, cur_trace_id, d->submitted, state);
+    return 1;
+}
+
+// 여러 txn 의 같은 상태를 한 번의 fsync 로 기록 (recovery 의 DECIDE_BATCH)
+static void write_log_batch(const int *ids, int n, const char *state) {
+    uint64_t t0 = trace_now();
+    size_t cap = (size_t)n * 32, len = 0;
+    char *buf;
+    int i;
+    if (n <= 0) return;
+    buf = malloc(cap);
+    if (!buf) { perror("malloc"); exit(1); }
+    for (i = 0; i < n; i++)
+        len += snprintf(buf + len, cap - len, "%d %s\n", ids[i], state);
+    append_log(buf, len);
+    free(buf);
+    trace_span("log_fsync", ids[0], cur_trace_id, t0, state);
+}
+
+char *read_last_state(int txn_id) {
+    FILE *f = env->open_read(log_file);
+    if (!f) return NULL;
+    static char last_state[INFO_MSG_SIZE];
+    last_state[0] = '\0';
+    char *line = NULL;
+    size_t line_cap = 0;
+    char state[INFO_MSG_SIZE];
+    int id;
+
+    // Find the last recorded state for the transaction ID (tree mode 의 PREPARED 는 한 줄이 길 수 있어 getline)
+    while (getline(&line, &line_cap, f) > 0) {
+        if (sscanf(line, "%d %255s", &id, state) == 2 && id == txn_id) {
+            strncpy(last_state, state, sizeof(last_state) - 1);
+            last_state[sizeof(last_state) - 1] = '\0';
+        }
+    }
+
+    free(line);
+    fclose(f);
+    return strlen(last_state) ? last_state : NULL;
+}
+
+// 로그를 한 번 읽어 txn 별 마지막 상태를 모음. txn_id - 1 이 index (coordinator 의 read_all_txn_states 와 같은 방식)
+enum { TS_NONE = 0, TS_PREPARED, TS_RESOLVED };
+
+static char *read_all_states(int *max_id) {
+    FILE *f = env->open_read(log_file);
+    int cap = 64, id;
+    char *line = NULL;
+    size_t line_cap = 0;
+    char state[INFO_MSG_SIZE];
+    char *st = calloc(cap, 1);
+    if (!st) { perror("calloc"); exit(1); }
+    *max_id = 0;
+    if (!f) return st;
+
+    while (getline(&line, &line_cap, f) > 0) {
+        if (sscanf(line, "%d %255s", &id, state) != 2 || id <= 0) continue;
+        if (id > cap) {
+            int new_cap = cap;
+            while (new_cap < id) new_cap *= 2;
+            st = realloc(st, new_cap);
+            if (!st) { perror("realloc"); exit(1); }
+            memset(st + cap, 0, new_cap - cap);
+            cap = new_cap;
+        }
+        st[id-1] = strcmp(state, "PREPARED") == 0 ? TS_PREPARED : TS_RESOLVED;
+        if (id > *max_id) *max_id = id;
+    }
+    free(line);
+    fclose(f);
+    return st;
+}
+
+/* ---------- Subtree (tree 2PC) ---------- */
+// sub-coordinator 로 PREPARE 를 받은 txn 의 하위 participant 목록과 subtree 투표 상태.
+// 하위로의 PREPARE / COMMIT / ABORT 전달은 thread 에서 진행해 svc_run 을 막지 않는다:
+// 투표가 끝나기 전에 다시 온 PREPARE 에는 VOTE_RETRY 로 답하고, 결정은 받은 즉시 ack 한 뒤 내려보냄.
+// 목록은 PREPARED 레코드의 "T:<fanout> M:<prog>@<host>" 에도 남겨 재시작 후 다시 만든다.
+// 내려보내기를 마치면 "<id> COMMITTED FORWARDED" / "<id> ABORT FORWARDED" 를 기록
+enum { SUB_IDLE = 0, SUB_VOTING, SUB_YES, SUB_NO };
+
+typedef struct SubtreeEntry {
+    int txn_id;
+    int fanout;
+    int n;
+    Member *members;
+    LockReq locks[MAX_TXN_LOCKS]; // 하위에도 같은 lock 을 요청
+    u_int lock_count;
+    uint64_t trace_id;
+    int state;                    // SUB_IDLE (재시작 후 아직 투표 전) / VOTING / YES / NO
+    int decision;                 // 재시작 시 아직 내려보내지 못한 결정 (-1 = 없음)
+    char why[INFO_MSG_SIZE];
+    struct SubtreeEntry *next;
+} SubtreeEntry;
+
+static SubtreeEntry *subtrees = NULL;
+static pthread_mutex_t subtree_mu = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t subtree_cv = PTHREAD_COND_INITIALIZER; // VOTING 이 끝나면 broadcast
+
+static SubtreeEntry *new_subtree(int txn_id, int fanout, int n) {
+    SubtreeEntry *e = calloc(1, sizeof(*e));
+    if (!e) { perror("calloc"); exit(1); }
+    e->txn_id = txn_id;
+    e->fanout = fanout;
+    e->n = n;
+    e->decision = -1;
+    e->members = calloc(n ? n : 1, sizeof(Member));
+    if (!e->members) { perror("calloc"); exit(1); }
+    return e;
+}
+
+static void free_subtree(SubtreeEntry *e) {
+    int i;
+    for (i = 0; i < e->n; i++) free(e->members[i].host);
+    free(e->members);
+    free(e);
+}
+
+// subtree_mu 를 잡은 상태에서 호출. unlink 이면 목록에서 떼어냄
+static SubtreeEntry *find_subtree(int txn_id, int unlink) {
+    SubtreeEntry **pp, *e;
+    for (pp = &subtrees; *pp; pp = &(*pp)->next) {
+        if ((*pp)->txn_id != txn_id) continue;
+        e = *pp;
+        if (unlink) *pp = e->next;
+        return e;
+    }
+    return NULL;
+}
+
+static void *vote_subtree(void *arg) {
+    SubtreeEntry *e = arg;
+    PrepareArgs a;
+    char why[INFO_MSG_SIZE] = "";
+    int ok;
+
+    memset(&a, 0, sizeof(a));
+    a.txn_id = e->txn_id;
+    a.trace_id = e->trace_id;
+    a.fanout = e->fanout;
+    a.locks.locks_len = e->lock_count;
+    a.locks.locks_val = e->locks;
+    ok = tree_prepare(&a, e->members, e->n, why, sizeof(why));
+    if (!ok) fprintf(stderr, "[DEBUG] P%d Txn %d: subtree voted NO (%s).\n", cfg.id, e->txn_id, why);
+
+    pthread_mutex_lock(&subtree_mu);
+    e->state = ok ? SUB_YES : SUB_NO;
+    snprintf(e->why, sizeof(e->why), "%s", why);
+    pthread_cond_broadcast(&subtree_cv);
+    pthread_mutex_unlock(&subtree_mu);
+    return NULL;
+}
+
+// state 를 SUB_VOTING 으로 바꾼 뒤 (subtree_mu 없이) 호출. thread 를 만들지 못하면 여기서 진행
+static void start_thread(void *(*fn)(void *), void *arg) {
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, fn, arg) == 0) pthread_detach(tid);
+    else fn(arg);
+}
+
+// 이미 투표를 시작한 subtree 면 그 상태로 답하고 1. 처음 보는 txn 이면 0
+static int subtree_answer(int txn_id, PrepareResult *res, size_t info_len) {
+    SubtreeEntry *e;
+    int start = 0;
+
+    pthread_mutex_lock(&subtree_mu);
+    e = find_subtree(txn_id, 0);
+    if (!e) {
+        pthread_mutex_unlock(&subtree_mu);
+        return 0;
+    }
+    if (e->state == SUB_IDLE) { // 재시작 후 다시 온 PREPARE: PREPARED 레코드와 lock 은 이미 있음
+        e->state = SUB_VOTING;
+        start = 1;
+    }
+    res->ok = e->state == SUB_YES ? 1 : e->state == SUB_NO ? 0 : VOTE_RETRY;
+    if (res->ok == 0) snprintf(res->PrepareResult_u.info, info_len, "Subtree NO (%.200s)", e->why);
+    pthread_mutex_unlock(&subtree_mu);
+
+    if (start) start_thread(vote_subtree, e);
+    return 1;
+}
+
+// PREPARED 를 기록한 뒤 호출: 하위 PREPARE 를 thread 로 보냄
+static void start_subtree_vote(const PrepareArgs *arg) {
+    SubtreeEntry *e = new_subtree(arg->txn_id, arg->fanout, arg->subtree.subtree_len);
+    int i;
+    // svc_freeargs 가 원본을 해제하므로 복사해 둠
+    for (i = 0; i < e->n; i++) {
+        e->members[i].host = strdup(arg->subtree.subtree_val[i].host);
+        e->members[i].prog = arg->subtree.subtree_val[i].prog;
+    }
+    e->lock_count = arg->locks.locks_len < MAX_TXN_LOCKS ? arg->locks.locks_len : MAX_TXN_LOCKS;
+    memcpy(e->locks, arg->locks.locks_val, e->lock_count * sizeof(LockReq));
+    e->trace_id = cur_trace_id;
+    e->state = SUB_VOTING;
+
+    pthread_mutex_lock(&subtree_mu);
+    e->next = subtrees;
+    subtrees = e;
+    pthread_mutex_unlock(&subtree_mu);
+    start_thread(vote_subtree, e);
+}
+
+static void *forward_subtree(void *arg) {
+    SubtreeEntry *e = arg;
+    const char *state = e->decision ? "COMMITTED" : "ABORT";
+
+    // 투표가 진행 중이면 끝날 때까지 기다림 (vote thread 가 e 를 쓰고 있음)
+    pthread_mutex_lock(&subtree_mu);
+    while (e->state == SUB_VOTING) pthread_cond_wait(&subtree_cv, &subtree_mu);
+    pthread_mutex_unlock(&subtree_mu);
+
+    fprintf(stderr, "[DEBUG] P%d forwarding %s for Txn %d to %d subtree member(s)\n",
+                    cfg.id, e->decision ? "COMMIT" : "ABORT", e->txn_id, e->n);
+    tree_decide(e->txn_id, e->decision, e->members, e->n, e->fanout, e->trace_id);
+    write_log(e->txn_id, state, "FORWARDED");
+    free_subtree(e);
+    return NULL;
+}
+
+static void forward_decision(int txn_id, int decision) {
+    SubtreeEntry *e;
+    pthread_mutex_lock(&subtree_mu);
+    e = find_subtree(txn_id, 1);
+    pthread_mutex_unlock(&subtree_mu);
+    if (!e) return;
+    e->decision = decision;
+    e->trace_id = cur_trace_id;
+    start_thread(forward_subtree, e);
+}
+
+// PREPARED 레코드의 vote 뒤에 붙일 subtree 목록 " T:<fanout> M:<prog>@<host> ..." (malloc, 호출자가 해제)
+static char *format_subtree(const PrepareArgs *arg) {
+    size_t cap = 32, off;
+    u_int i;
+    char *buf;
+    for (i = 0; i < arg->subtree.subtree_len; i++) cap += strlen(arg->subtree.subtree_val[i].host) + 24;
+    buf = malloc(cap);
+    if (!buf) { perror("malloc"); exit(1); }
+    off = snprintf(buf, cap, " T:%d", arg->fanout);
+    for (i = 0; i < arg->subtree.subtree_len; i++) {
+        off += snprintf(buf + off, cap - off, " M:0x%x@%s", arg->subtree.subtree_val[i].prog, arg->subtree.subtree_val[i].host);
+    }
+    return buf;
+}
+
+// 재시작: PREPARED 레코드의 subtree 목록으로 entry 를 다시 만듦 (같은 txn 이 다시 나오면 새 것으로 교체)
+static void restore_subtree(int txn_id, int fanout, Member *members, int n, const LockReq *locks, u_int lock_count) {
+    SubtreeEntry *e = new_subtree(txn_id, fanout, n), *old;
+    memcpy(e->members, members, n * sizeof(Member));
+    e->lock_count = lock_count;
+    memcpy(e->locks, locks, lock_count * sizeof(LockReq));
+    old = find_subtree(txn_id, 1);
+    if (old) free_subtree(old);
+    e->next = subtrees;
+    subtrees = e;
+}
+
+// 재시작: 결정을 기록했지만 FORWARDED 가 없는 txn 은 아직 하위가 결정을 못 받았을 수 있음
+static void restore_subtree_decision(int txn_id, int decision, int forwarded) {
+    SubtreeEntry *e = find_subtree(txn_id, forwarded);
+    if (!e) return;
+    if (forwarded) free_subtree(e);
+    else e->decision = decision;
+}
+
+// 재시작 후 남은 결정을 내려보냄. 결정이 없는 entry 는 PREPARE 재전송 / 결정을 기다림
+static void resume_forwarding(void) {
+    SubtreeEntry **pp = &subtrees, *e;
+    int n = 0;
+    while (*pp) {
+        e = *pp;
+        if (e->decision < 0) { pp = &e->next; continue; }
+        *pp = e->next;
+        start_thread(forward_subtree, e);
+        n++;
+    }
+    if (n > 0) fprintf(stderr, "[RECOVERY] P%d resuming decision forwarding for %d subtree(s)\n", cfg.id, n);
+}
+
+/* ---------- Lock helpers ---------- */
+// PREPARED 레코드의 vote 뒤에 "X:<key>" / "S:<key>" 를 붙여 재시작 시 lock 을 복원할 수 있게 함
+static void format_vote_with_locks(char *buf, size_t len, const char *vote, const LockReq *locks, u_int n) {
+    size_t off = snprintf(buf, len, "%s", vote);
+    u_int i;
+    for (i = 0; i < n && off < len; i++)
+        off += snprintf(buf + off, len - off, " %c:%d", locks[i].exclusive ? 'X' : 'S', locks[i].key);
+}
+
+// 하나라도 실패하면 이미 잡은 lock 을 모두 풀고 실패한 key 를 돌려줌.
+// LM_WAIT (wait-die 에서 기다려야 함) 이면 잡은 lock 과 대기 표시를 그대로 두고 돌아옴:
+// 같은 PREPARE 가 다시 오면 이어서 잡고, 결정이 오거나 포기하면 lm_release_all
+static LockResult acquire_txn_locks(int txn_id, const LockReq *locks, u_int n, int *failed_key) {
+    u_int i;
+    for (i = 0; i < n; i++) {
+        const LockReq *req = &locks[i];
+        LockResult r = lm_acquire(txn_id, req->key, req->exclusive ? LM_EXCLUSIVE : LM_SHARED);
+        if (r != LM_GRANTED) {
+            if (r != LM_WAIT) lm_release_all(txn_id);
+            *failed_key = req->key;
+            return r;
+        }
+    }
+    return LM_GRANTED;
+}
+
+static const char *lock_result_name(LockResult r) {
+    switch (r) {
+    case LM_GRANTED: return "granted";
+    case LM_WAIT: return "wait";
+    default: return "conflict";
+    }
+}
+
+// 로그를 앞에서부터 재생: PREPARED 면 lock 획득, COMMITTED/ABORT 면 해제.
+// 끝까지 읽고 나면 아직 PREPARED 인 txn 의 lock 만 남는다. tree mode 의 subtree 목록도 같이 복원
+static void rebuild_locks_from_log(void) {
+    FILE *f = env->open_read(log_file);
+    if (!f) return;
+    char *line = NULL;
+    size_t line_cap = 0;
+    char state[INFO_MSG_SIZE];
+    int id, pos, restored = 0;
+    Member *members = NULL;
+    int member_cap = 0;
+
+    while (getline(&line, &line_cap, f) > 0) {
+        if (sscanf(line, "%d %255s %n", &id, state, &pos) < 2) continue;
+
+        if (strcmp(state, "COMMITTED") == 0 || strcmp(state, "ABORT") == 0) {
+            restored -= lm_held_count(id);
+            lm_release_all(id);
+            restore_subtree_decision(id, state[0] == 'C', strncmp(line + pos, "FORWARDED", 9) == 0);
+            continue;
+        }
+        if (strcmp(state, "PREPARED") != 0) continue;
+
+        LockReq locks[MAX_TXN_LOCKS];
+        u_int lock_count = 0;
+        int fanout = 0, n = 0;
+        char *tok = strtok(line + pos, " \n"); // vote (YES)
+        while (tok && (tok = strtok(NULL, " \n")) != NULL) {
+            char mode = tok[0];
+            char *at;
+            int key;
+            if (tok[1] != ':') continue;
+            if (mode == 'T') { fanout = atoi(tok + 2); continue; }
+            if (mode == 'M' && (at = strchr(tok, '@')) != NULL) {
+                if (n == member_cap) {
+                    member_cap = member_cap ? member_cap * 2 : 16;
+                    members = realloc(members, member_cap * sizeof(Member));
+                    if (!members) { perror("realloc"); exit(1); }
+                }
+                members[n].prog = strtoul(tok + 2, NULL, 0);
+                members[n].host = strdup(at + 1);
+                n++;
+                continue;
+            }
+            if ((mode != 'X' && mode != 'S') || sscanf(tok + 2, "%d", &key) != 1) continue;
+            if (lock_count < MAX_TXN_LOCKS) {
+                locks[lock_count].key = key;
+                locks[lock_count].exclusive = mode == 'X';
+                lock_count++;
+            }
+            if (lm_acquire(id, key, mode == 'X' ? LM_EXCLUSIVE : LM_SHARED) == LM_GRANTED)
+                restored++;
+            else
+                fprintf(stderr, "[WARN] P%d could not restore lock %c:%d for Txn %d\n", cfg.id, mode, key, id);
+        }
+        if (n > 0) restore_subtree(id, fanout, members, n, locks, lock_count); // host 는 entry 가 가져감
+    }
+    free(members);
+    free(line);
+    fclose(f);
+
+    if (restored > 0)
+        fprintf(stderr, "[RECOVERY] P%d restored %d lock(s) held by PREPARED transactions\n", cfg.id, restored);
+}
+
+/* ---------- Failure injection helper ---------- */
+void maybe_fail(const char *phase) {
+    bool should_fail = false;
+
+    env->crash_point(phase);
+
+    if ((strcmp(phase, "prepare") == 0 && cfg.fail_on_prepare) ||
+        (strcmp(phase, "after_prepare") == 0 && cfg.fail_after_prepare) ||
+        (strcmp(phase, "commit") == 0 && cfg.fail_on_commit) ||
+        (strcmp(phase, "abort") == 0 && cfg.fail_on_abort) ||
+        (strcmp(phase, "after_commit") == 0 && cfg.fail_after_commit))
+    {
+        should_fail = true;
+    }
+
+    if (should_fail)
+    {
+        fprintf(stderr, "[FAILURE] P%d Simulating crash during %s\n", cfg.id, phase);
+        exit(99);
+    }
+}
+
+/* ---------- Duplicate request cache ---------- */
+// UDP client 는 timeout 마다 같은 요청을 재전송하므로, 상태를 바꾸는 요청의 응답을 (txn_id, proc) 로
+// 기억해 두었다가 재전송에는 handler (write_log + fsync) 를 다시 돌리지 않고 저장된 응답을 그대로 보냄.
+// 크기가 고정된 direct-mapped table 이라 충돌하면 이전 entry 를 덮어씀 (그 요청은 다시 handler 를 거침).
+// 같은 (txn_id, proc) 는 언제 다시 와도 같은 결과이므로 (COMMIT/ABORT 재전송, 이미 기록된 PREPARE) xid 는 보지 않음.
+// 예외는 ABORT: 저장된 YES 가 ABORT 뒤에 늦게 온 PREPARE 에 나가면 안 되므로 drc_forget 으로 지움
+typedef struct {
+    int txn_id;
+    rpcproc_t proc;
+    u_int len;           // 0 = 비어 있음
+    char *reply;         // XDR 로 encode 된 응답
+} DrcEntry;
+
+// PREPARE_EPOCH 응답은 epoch_id 로 저장되므로, epoch 의 어느 txn 이 ABORT 되어도 찾을 수 있게 txn -> epoch 를 둠
+typedef struct {
+    int txn_id;          // 0 = 비어 있음
+    int epoch_id;
+} DrcEpochRef;
+
+static DrcEntry *drc = NULL;
+static DrcEpochRef *drc_epoch_of = NULL;
+static unsigned long drc_hits = 0;
+
+static DrcEntry *drc_slot(int txn_id, rpcproc_t proc) {
+    return &drc[((u_int) txn_id * 2654435761u ^ (u_int) proc) % (u_int) cfg.drc_size];
+}
+
+// 이미 encode 된 응답을 그대로 씀 (XDR 출력은 항상 4 byte 단위라 padding 없음)
+static bool_t xdr_drc_entry(XDR *xdrs, DrcEntry *e) {
+    return xdr_opaque(xdrs, e->reply, e->len);
+}
+
+// 재전송이면 저장된 응답을 보내고 1 을 돌려줌
+static int drc_reply(SVCXPRT *transp, int txn_id, rpcproc_t proc) {
+    DrcEntry *e;
+    if (!drc) return 0;
+    e = drc_slot(txn_id, proc);
+    if (e->len == 0 || e->txn_id != txn_id || e->proc != proc) return 0;
+
+    drc_hits++;
+    fprintf(stderr, "[DEBUG] P%d answered duplicate request (proc %lu) for Txn %d from cache (%lu hit(s))\n",
+                    cfg.id, (unsigned long) proc, txn_id, drc_hits);
+    if (!svc_sendreply(transp, (xdrproc_t) xdr_drc_entry, (caddr_t) e))
+        svcerr_systemerr(transp);
+    return 1;
+}
+
+static void drc_store(int txn_id, rpcproc_t proc, xdrproc_t xdr_result, void *result) {
+    char buf[DRC_MAX_REPLY];
+    DrcEntry *e;
+    XDR xdrs;
+    u_int len;
+    if (!drc) return;
+
+    xdrmem_create(&xdrs, buf, sizeof(buf), XDR_ENCODE);
+    if (!xdr_result(&xdrs, result)) { xdr_destroy(&xdrs); return; }
+    len = xdr_getpos(&xdrs);
+    xdr_destroy(&xdrs);
+
+    e = drc_slot(txn_id, proc);
+    if (e->len < len) {
+        free(e->reply);
+        e->reply = malloc(len);
+        if (!e->reply) { perror("malloc"); exit(1); }
+    }
+    memcpy(e->reply, buf, len);
+    e->txn_id = txn_id;
+    e->proc = proc;
+    e->len = len;
+}
+
+static DrcEpochRef *drc_epoch_slot(int txn_id) {
+    return &drc_epoch_of[((u_int) txn_id * 2654435761u) % (u_int) cfg.drc_size];
+}
+
+static void drc_drop(int txn_id, rpcproc_t proc) {
+    DrcEntry *e = drc_slot(txn_id, proc);
+    if (e->txn_id == txn_id && e->proc == proc) e->len = 0;
+}
+
+// PREPARE_EPOCH 응답을 저장한 뒤 epoch 의 txn 마다 epoch_id 를 기록. 다른 epoch 의 txn 을 덮어쓰면 그 txn 이
+// ABORT 될 때 찾을 수 없으므로 그 epoch 의 응답을 미리 지움 (재전송은 handler 를 다시 거침)
+static void drc_store_epoch(const PrepareEpochArgs *arg) {
+    u_int k;
+    if (!drc) return;
+    for (k = 0; k < arg->txns.txns_len; k++) {
+        DrcEpochRef *ref = drc_epoch_slot(arg->txns.txns_val[k].txn_id);
+        if (ref->txn_id != 0 && ref->epoch_id != arg->epoch_id) drc_drop(ref->epoch_id, PREPARE_EPOCH);
+        ref->txn_id = arg->txns.txns_val[k].txn_id;
+        ref->epoch_id = arg->epoch_id;
+    }
+}
+
+// txn 이 ABORT 로 끝나면 투표 응답을 지움 (그 txn 이 든 epoch 의 PREPARE_EPOCH 응답도).
+// 다음 PREPARE 는 handler 가 ABORT 로그를 보고 NO 로 답함
+static void drc_forget(int txn_id) {
+    DrcEpochRef *ref;
+    if (!drc) return;
+    drc_drop(txn_id, PREPARE);
+    drc_drop(txn_id, PREPARE_COMMIT);
+    ref = drc_epoch_slot(txn_id);
+    if (ref->txn_id == txn_id) {
+        drc_drop(ref->epoch_id, PREPARE_EPOCH);
+        ref->txn_id = 0;
+    }
+}
+
+// 재시작 (sim) 이면 이전 incarnation 의 cache 를 버림
+static void drc_free(void) {
+    int i;
+    if (!drc) return;
+    for (i = 0; i < cfg.drc_size; i++) free(drc[i].reply);
+    free(drc);
+    free(drc_epoch_of);
+    drc = NULL;
+    drc_epoch_of = NULL;
+}
+
+static void drc_init(void) {
+    if (cfg.drc_size <= 0) return;
+    drc = calloc(cfg.drc_size, sizeof(DrcEntry));
+    drc_epoch_of = calloc(cfg.drc_size, sizeof(DrcEpochRef));
+    if (!drc || !drc_epoch_of) { perror("calloc"); exit(1); }
+}
+
+/* ---------- RPC handlers ---------- */
+PrepareResult *prepare_1_svc(PrepareArgs arg, struct svc_req *rqstp) {
+    static PrepareResult result;
+    static char info_buf[INFO_MSG_SIZE];
+    result.PrepareResult_u.info = info_buf; // NO 일 때만 보냄
+
+    // 1. maybe_fail("prepare")
+    maybe_fail("prepare");
+
+    fprintf(stderr, "[DEBUG] P%d Received PREPARE for Txn %d\n", cfg.id, arg.txn_id);
+
+    // 2. Check for previous ABORT decision
+    char *prev = read_last_state(arg.txn_id);
+    if (prev && (strcmp(prev, "ABORT") == 0 || strcmp(prev, "ABORTED") == 0)) {
+        fprintf(stderr, "[DEBUG] P%d Voted ABORT (NO) due to previous ABORT log.\n", cfg.id);
+        result.ok = 0;
+        snprintf(result.PrepareResult_u.info, sizeof(info_buf), "Voted ABORT (Previous log)");
+        return &result;
+    }
+
+    // 이미 COMMITTED 인 txn 에 늦게 온 PREPARE (새 xid 라 DRC 에 없음): lock 을 다시 잡거나 PREPARED 를 덧붙이지 않고 YES
+    if (prev && strcmp(prev, "COMMITTED") == 0) {
+        fprintf(stderr, "[DEBUG] P%d Txn %d already COMMITTED, voting YES from the log.\n", cfg.id, arg.txn_id);
+        result.ok = 1;
+        return &result;
+    }
+
+    // tree mode: 이미 하위에 PREPARE 를 보낸 txn 이면 그 투표 (진행 중이면 RETRY)
+    if (arg.subtree.subtree_len > 0 && subtree_answer(arg.txn_id, &result, sizeof(info_buf)))
+        return &result;
+
+    // PREPARED YES 를 이미 기록한 txn (lock 은 쥐고 있거나 recovery 에서 복원함): 그 투표를 그대로 돌려줌
+    if (prev && strcmp(prev, "PREPARED") == 0 && arg.subtree.subtree_len == 0) {
+        fprintf(stderr, "[DEBUG] P%d Txn %d already PREPARED, voting YES from the log.\n", cfg.id, arg.txn_id);
+        result.ok = 1;
+        return &result;
+    }
+
+    // 3. If can_commit(data) == TRUE: (No fail_on_prepare flag)
+    if (!cfg.fail_on_prepare) {
+        int failed_key = 0;
+        uint64_t t0 = trace_now();
+        LockResult lr = acquire_txn_locks(arg.txn_id, arg.locks.locks_val, arg.locks.locks_len, &failed_key);
+        trace_span("lock_acquire", arg.txn_id, cur_trace_id, t0, lock_result_name(lr));
+        if (lr == LM_WAIT) {
+            // svc_run 을 막지 않도록 기다리지 않고 coordinator 에게 다시 보내라고 함 (로그 없음)
+            fprintf(stderr, "[DEBUG] P%d Txn %d waits for key %d (wait-die), asking to retry.\n", cfg.id, arg.txn_id, failed_key);
+            result.ok = VOTE_RETRY;
+            return &result;
+        }
+        if (lr != LM_GRANTED) {
+            fprintf(stderr, "[DEBUG] P%d Voted ABORT (NO): lock conflict on key %d (%s).\n",
+                            cfg.id, failed_key, lr == LM_TIMEOUT ? "wait timeout" : lm_policy_name(cfg.lock_policy));
+            result.ok = 0;
+            snprintf(result.PrepareResult_u.info, sizeof(info_buf), "Voted ABORT (Lock conflict on key %d)", failed_key);
+            return &result;
+        }
+
+        // Log PREPARED YES (+ lock 목록, tree mode 면 subtree 목록)
+        char vote_buf[LOG_LINE_SIZE];
+        format_vote_with_locks(vote_buf, sizeof(vote_buf), "YES", arg.locks.locks_val, arg.locks.locks_len);
+        if (arg.subtree.subtree_len > 0) {
+            char *sub = format_subtree(&arg), *vote = malloc(strlen(vote_buf) + strlen(sub) + 1);
+            if (!vote) { perror("malloc"); exit(1); }
+            strcat(strcpy(vote, vote_buf), sub);
+            write_log(arg.txn_id, "PREPARED", vote);
+            free(vote);
+            free(sub);
+        } else {
+            // 기록이 끝나면 participant_serve 가 maybe_fail("after_prepare") 뒤 YES 로 답함
+            if (write_log_deferred(arg.txn_id, "PREPARED", vote_buf)) return NULL;
+        }
+
+        // maybe_fail("after_prepare")
+        maybe_fail("after_prepare");
+
+        // tree mode: 하위 subtree 의 투표는 thread 에서 모으고, 다시 온 PREPARE 에 그 결과로 답함
+        if (arg.subtree.subtree_len > 0) {
+            start_subtree_vote(&arg);
+            result.ok = VOTE_RETRY;
+            return &result;
+        }
+
+        // return VOTE_COMMIT
+        result.ok = 1;
+        return &result;
+    }
+    // 4. Else (can't commit / fail_on_prepare is set): VOTE_ABORT
+    else {
+        // VOTE_ABORT 시 로그 기록을 생략합니다 (최종 ABORT 통지 시에만 로깅).
+
+        // return VOTE_ABORT
+        result.ok = 0;
+        snprintf(result.PrepareResult_u.info, sizeof(info_buf), "Voted ABORT (Can't commit/Fail flag)");
+        return &result;
+    }
+}
+
+// 결정 레코드가 디스크에 남은 뒤 (미룬 요청이면 participant_serve 에서) lock 을 놓고 subtree 로 내려보냄
+static void commit_done(int txn_id) {
+    lm_release_all(txn_id);
+    maybe_fail("after_commit"); // COMMITTED 기록 후, ack 와 subtree 로 내려보내기 전
+    forward_decision(txn_id, 1);
+}
+
+static void abort_done(int txn_id) {
+    lm_release_all(txn_id);
+    drc_forget(txn_id);
+    forward_decision(txn_id, 0);
+}
+
+int *commit_1_svc(TxnID arg, struct svc_req *rqstp) {
+    static int ack = 1;
+
+    // maybe_fail("commit")
+    maybe_fail("commit");
+
+    // write_log("COMMIT", transaction_id)
+    if (write_log_deferred(arg.txn_id, "COMMITTED", NULL)) return NULL;
+    commit_done(arg.txn_id);
+    return &ack;
+}
+
+int *abort_1_svc(TxnID arg, struct svc_req *rqstp) {
+    static int ack = 1;
+
+    // maybe_fail("abort")
+    maybe_fail("abort");
+
+    // write_log("ABORT", transaction_id) - 명세에 맞춰 "ABORT" 사용
+    if (write_log_deferred(arg.txn_id, "ABORT", NULL)) return NULL;
+    abort_done(arg.txn_id);
+    return &ack;
+}
+
+// one-phase / last agent: coordinator 가 결정을 맡김. PREPARED 를 거치지 않고 lock 을 잡을 수 있으면
+// 바로 COMMITTED 를 기록 (fsync 한 번). ABORT 도 기록해서 재전송이나 늦게 도착한 요청이 결과를 바꾸지 못하게 함
+PrepareResult *prepare_commit_1_svc(PrepareArgs arg, struct svc_req *rqstp) {
+    static PrepareResult result;
+    static char info_buf[INFO_MSG_SIZE];
+    int failed_key = 0;
+    LockResult lr;
+    uint64_t t0;
+    result.PrepareResult_u.info = info_buf; // NO 일 때만 보냄
+
+    maybe_fail("prepare");
+
+    fprintf(stderr, "[DEBUG] P%d Received PREPARE_COMMIT for Txn %d\n", cfg.id, arg.txn_id);
+
+    // 재전송: 이미 내린 결정을 그대로 돌려줌
+    char *prev = read_last_state(arg.txn_id);
+    if (prev && strcmp(prev, "COMMITTED") == 0) {
+        result.ok = 1;
+        return &result;
+    }
+    if (prev && (strcmp(prev, "ABORT") == 0 || strcmp(prev, "ABORTED") == 0)) {
+        result.ok = 0;
+        snprintf(result.PrepareResult_u.info, sizeof(info_buf), "Aborted (Previous log)");
+        return &result;
+    }
+
+    if (cfg.fail_on_prepare) {
+        write_log(arg.txn_id, "ABORT", NULL);
+        result.ok = 0;
+        snprintf(result.PrepareResult_u.info, sizeof(info_buf), "Aborted (Can't commit/Fail flag)");
+        return &result;
+    }
+
+    t0 = trace_now();
+    lr = acquire_txn_locks(arg.txn_id, arg.locks.locks_val, arg.locks.locks_len, &failed_key);
+    trace_span("lock_acquire", arg.txn_id, cur_trace_id, t0, lock_result_name(lr));
+    if (lr == LM_WAIT) {
+        fprintf(stderr, "[DEBUG] P%d Txn %d waits for key %d (wait-die), asking to retry.\n", cfg.id, arg.txn_id, failed_key);
+        result.ok = VOTE_RETRY;
+        return &result;
+    }
+    if (lr != LM_GRANTED) {
+        fprintf(stderr, "[DEBUG] P%d decided ABORT: lock conflict on key %d (%s).\n",
+                        cfg.id, failed_key, lr == LM_TIMEOUT ? "wait timeout" : lm_policy_name(cfg.lock_policy));
+        write_log(arg.txn_id, "ABORT", NULL);
+        result.ok = 0;
+        snprintf(result.PrepareResult_u.info, sizeof(info_buf), "Aborted (Lock conflict on key %d)", failed_key);
+        return &result;
+    }
+
+    maybe_fail("commit");
+    write_log(arg.txn_id, "COMMITTED", NULL);
+    lm_release_all(arg.txn_id);
+
+    result.ok = 1;
+    return &result;
+}
+
+int *status_1_svc(TxnID arg, struct svc_req *rqstp) {
+    static int status = 0;
+    char *prev = read_last_state(arg.txn_id);
+    if (!prev) status = 0;
+    else if (strcmp(prev, "COMMITTED") == 0) status = 1;
+    else if (strcmp(prev, "PREPARED") == 0) status = 2; 
+    else status = 0;
+    return &status;
+}
+
+/* ---------- Bulk recovery ---------- */
+// 마지막 상태가 PREPARED 인 txn 을 after 다음부터 MAX_INDOUBT 개까지
+InDoubtList *in_doubt_1_svc(int after, struct svc_req *rqstp) {
+    static InDoubtList result;
+    static int ids[MAX_INDOUBT];
+    int max_id, id, n = 0;
+    char *st = read_all_states(&max_id);
+
+    result.more = 0;
+    for (id = (after > 0 ? after : 0) + 1; id <= max_id; id++) {
+        if (st[id-1] != TS_PREPARED) continue;
+        if (n == MAX_INDOUBT) { result.more = 1; break; }
+        ids[n++] = id;
+    }
+    free(st);
+
+    fprintf(stderr, "[DEBUG] P%d reporting %d in-doubt txn(s) after Txn %d%s\n",
+                    cfg.id, n, after, result.more ? " (more)" : "");
+    result.txn_ids.txn_ids_len = n;
+    result.txn_ids.txn_ids_val = ids;
+    return &result;
+}
+
+// 이미 결정을 기록한 txn 은 건너뛰고, 나머지는 상태별로 한 번의 fsync 로 기록
+static int apply_decisions(const char *st, int max_id, const int *ids, u_int n, int decision) {
+    int *todo = malloc((n ? n : 1) * sizeof(int));
+    int count = 0;
+    u_int i;
+    if (!todo) { perror("malloc"); exit(1); }
+
+    for (i = 0; i < n; i++) {
+        int id = ids[i];
+        if (id <= 0) continue;
+        if (id <= max_id && st[id-1] == TS_RESOLVED) continue;
+        if (decision && (id > max_id || st[id-1] != TS_PREPARED)) continue; // PREPARED 가 아니면 COMMIT 할 것이 없음
+        todo[count++] = id;
+    }
+
+    write_log_batch(todo, count, decision ? "COMMITTED" : "ABORT");
+    for (i = 0; i < (u_int)count; i++) {
+        lm_release_all(todo[i]);
+        if (!decision) drc_forget(todo[i]);
+        forward_decision(todo[i], decision);
+    }
+    free(todo);
+    return count;
+}
+
+int *decide_batch_1_svc(DecisionBatch arg, struct svc_req *rqstp) {
+    static int applied;
+    int max_id;
+    char *st;
+
+    if (arg.commit_ids.commit_ids_len > 0) maybe_fail("commit");
+    if (arg.abort_ids.abort_ids_len > 0) maybe_fail("abort");
+
+    st = read_all_states(&max_id);
+    applied = apply_decisions(st, max_id, arg.commit_ids.commit_ids_val, arg.commit_ids.commit_ids_len, 1);
+    applied += apply_decisions(st, max_id, arg.abort_ids.abort_ids_val, arg.abort_ids.abort_ids_len, 0);
+    free(st);
+
+    fprintf(stderr, "[DEBUG] P%d applied %d batched decision(s) (%u COMMIT, %u ABORT requested)\n",
+                    cfg.id, applied, arg.commit_ids.commit_ids_len, arg.abort_ids.abort_ids_len);
+    return &applied;
+}
+
+/* ---------- Epoch mode ---------- */
+// epoch 의 txn 마다 vote 를 정하고, YES 인 txn 들의 PREPARED 레코드를 한 번의 fsync 로 기록
+EpochVotes *prepare_epoch_1_svc(PrepareEpochArgs arg, struct svc_req *rqstp) {
+    static EpochVotes result;
+    static int votes[MAX_EPOCH_TXNS];
+    u_int n = arg.txns.txns_len, k;
+    int max_id, yes = 0;
+    size_t len = 0, cap = (size_t)(n ? n : 1) * LOG_LINE_SIZE;
+    char *buf, *st;
+    char vote_buf[LOG_LINE_SIZE];
+    uint64_t t0;
+
+    maybe_fail("prepare");
+    fprintf(stderr, "[DEBUG] P%d Received PREPARE_EPOCH %d (%u txns)\n", cfg.id, arg.epoch_id, n);
+
+    buf = malloc(cap);
+    if (!buf) { perror("malloc"); exit(1); }
+    st = read_all_states(&max_id);
+    t0 = trace_now();
+    for (k = 0; k < n; k++) {
+        const EpochTxn *e = &arg.txns.txns_val[k];
+        int failed_key = 0;
+        LockResult lr;
+        int prev = e->txn_id > 0 && e->txn_id <= max_id ? st[e->txn_id-1] : TS_NONE;
+
+        votes[k] = 0;
+        if (cfg.fail_on_prepare || e->txn_id <= 0 || prev == TS_RESOLVED) continue;
+        if (prev == TS_PREPARED) { votes[k] = 1; yes++; continue; } // 재전송: 이미 기록됨
+        // epoch 은 한 번의 응답으로 모든 vote 를 돌려주므로 기다려야 하는 txn 도 NO
+        lr = acquire_txn_locks(e->txn_id, e->locks.locks_val, e->locks.locks_len, &failed_key);
+        if (lr != LM_GRANTED) {
+            if (lr == LM_WAIT) lm_release_all(e->txn_id);
+            fprintf(stderr, "[DEBUG] P%d Txn %d votes NO: lock conflict on key %d\n", cfg.id, e->txn_id, failed_key);
+            continue;
+        }
+        format_vote_with_locks(vote_buf, sizeof(vote_buf), "YES", e->locks.locks_val, e->locks.locks_len);
+        len += snprintf(buf + len, cap - len, "%d PREPARED %s\n", e->txn_id, vote_buf);
+        votes[k] = 1;
+        yes++;
+    }
+    free(st);
+    trace_span("lock_acquire", arg.epoch_id, cur_trace_id, t0, NULL);
+
+    if (len > 0) {
+        t0 = trace_now();
+        append_log(buf, len);
+        trace_span("log_fsync", arg.epoch_id, cur_trace_id, t0, "PREPARED");
+        maybe_fail("after_prepare");
+    }
+    free(buf);
+
+    fprintf(stderr, "[DEBUG] P%d epoch %d: %d YES / %u NO\n", cfg.id, arg.epoch_id, yes, n - yes);
+    result.votes.votes_len = n;
+    result.votes.votes_val = votes;
+    return &result;
+}
+
+/* ---------- RPC dispatch glue ---------- */
+#ifndef SIG_PF
+#define SIG_PF void(*)(int)
+#endif
+
+// tracing: 보낸 쪽 flow 를 닫고 handler 전체를 span 으로 기록
+static PrepareResult *_prepare_1(PrepareArgs *argp, struct svc_req *rqstp) {
+    uint64_t t0 = trace_now();
+    PrepareResult *r;
+    cur_trace_id = argp->trace_id;
+    trace_flow_end(argp->span_id, argp->txn_id, argp->trace_id);
+    r = prepare_1_svc(*argp, rqstp);
+    trace_span("prepare", argp->txn_id, argp->trace_id, t0, !r ? "DEFERRED" : r->ok == VOTE_RETRY ? "RETRY" : r->ok ? "YES" : "NO");
+    return r;
+}
+static int *_commit_1(TxnID *argp, struct svc_req *rqstp) {
+    uint64_t t0 = trace_now();
+    int *r;
+    cur_trace_id = argp->trace_id;
+    trace_flow_end(argp->span_id, argp->txn_id, argp->trace_id);
+    r = commit_1_svc(*argp, rqstp);
+    trace_span("commit", argp->txn_id, argp->trace_id, t0, NULL);
+    return r;
+}
+static int *_abort_1(TxnID *argp, struct svc_req *rqstp) {
+    uint64_t t0 = trace_now();
+    int *r;
+    cur_trace_id = argp->trace_id;
+    trace_flow_end(argp->span_id, argp->txn_id, argp->trace_id);
+    r = abort_1_svc(*argp, rqstp);
+    trace_span("abort", argp->txn_id, argp->trace_id, t0, NULL);
+    return r;
+}
+static int *_status_1(TxnID *argp, struct svc_req *rqstp) { return status_1_svc(*argp, rqstp); }
+static PrepareResult *_prepare_commit_1(PrepareArgs *argp, struct svc_req *rqstp) {
+    uint64_t t0 = trace_now();
+    PrepareResult *r;
+    cur_trace_id = argp->trace_id;
+    trace_flow_end(argp->span_id, argp->txn_id, argp->trace_id);
+    r = prepare_commit_1_svc(*argp, rqstp);
+    trace_span("prepare_commit", argp->txn_id, argp->trace_id, t0, r->ok == VOTE_RETRY ? "RETRY" : r->ok ? "COMMIT" : "ABORT");
+    return r;
+}
+static EpochVotes *_prepare_epoch_1(PrepareEpochArgs *argp, struct svc_req *rqstp) {
+    uint64_t t0 = trace_now();
+    EpochVotes *r;
+    cur_trace_id = argp->trace_id;
+    trace_flow_end(argp->span_id, argp->epoch_id, argp->trace_id);
+    r = prepare_epoch_1_svc(*argp, rqstp);
+    trace_span("prepare_epoch", argp->epoch_id, argp->trace_id, t0, NULL);
+    return r;
+}
+static InDoubtList *_in_doubt_1(int *argp, struct svc_req *rqstp) { return in_doubt_1_svc(*argp, rqstp); }
+static int *_decide_batch_1(DecisionBatch *argp, struct svc_req *rqstp) {
+    uint64_t t0 = trace_now();
+    int *r;
+    cur_trace_id = argp->trace_id;
+    trace_flow_end(argp->span_id, 0, argp->trace_id);
+    r = decide_batch_1_svc(*argp, rqstp);
+    trace_span("decide_batch", 0, argp->trace_id, t0, NULL);
+    return r;
+}
+
+// UDP 로 온 PREPARE / COMMIT / ABORT 이면 응답에 필요한 것 (xid, client 주소) 을 담아 handler 에 넘김
+static Deferred *defer_begin(struct svc_req *rqstp, SVCXPRT *transp, int txn_id) {
+    struct netbuf *caller;
+    Deferred *d;
+    if (done_fd < 0 || transp != udp_xprt || txn_id <= 0) return NULL;
+    caller = svc_getrpccaller(transp);
+    if (!caller || caller->len > sizeof(d->addr)) return NULL;
+
+    d = calloc(1, sizeof(*d));
+    if (!d) { perror("malloc"); exit(1); }
+    d->proc = rqstp->rq_proc;
+    d->txn_id = txn_id;
+    // svc_dg 는 받은 datagram 을 xp_p1 에 두고 그 자리에서 decode 함: 첫 4 byte 가 xid (libtirpc 내부 구조)
+    d->xid = ntohl(*(uint32_t *) transp->xp_p1);
+    memcpy(&d->addr, caller->buf, caller->len);
+    d->addr_len = caller->len;
+    return d;
+}
+
+// svc_sendreply 와 같은 accepted reply 를 직접 encode 해서 UDP socket 으로 보냄
+static void send_deferred_reply(const Deferred *d, xdrproc_t xdr_result, void *result) {
+    char buf[UDPMSGSIZE];
+    struct rpc_msg msg;
+    XDR xdrs;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.rm_xid = d->xid;
+    msg.rm_direction = REPLY;
+    msg.rm_reply.rp_stat = MSG_ACCEPTED;
+    msg.acpted_rply.ar_verf = _null_auth;
+    msg.acpted_rply.ar_stat = SUCCESS;
+    msg.acpted_rply.ar_results.where = result;
+    msg.acpted_rply.ar_results.proc = xdr_result;
+
+    xdrmem_create(&xdrs, buf, sizeof(buf), XDR_ENCODE);
+    if (!xdr_replymsg(&xdrs, &msg)) {
+        fprintf(stderr, "[ERROR] P%d could not encode the reply for Txn %d\n", cfg.id, d->txn_id);
+    } else if (sendto(udp_xprt->xp_fd, buf, xdr_getpos(&xdrs), 0,
+                      (const struct sockaddr *) &d->addr, d->addr_len) < 0) {
+        perror("sendto");
+    }
+    xdr_destroy(&xdrs);
+}
+
+// 기록을 마친 요청의 나머지: handler 가 write 뒤에 하던 일, DRC 저장, 응답
+static void finish_deferred(Deferred *d) {
+    static PrepareResult yes = { .ok = 1 };
+    static int ack = 1;
+
+    if (d->res < 0) {
+        fprintf(stderr, "[ERROR] log append failed: %s\n", strerror(-d->res));
+        exit(1);
+    }
+    cur_trace_id = d->trace_id;
+    trace_span("log_fsync", d->txn_id, d->trace_id, d->submitted, d->proc == PREPARE ? "PREPARED" : d->proc == COMMIT ? "COMMITTED" : "ABORT");
+    switch (d->proc) {
+    case PREPARE:
+        maybe_fail("after_prepare");
+        drc_store(d->txn_id, d->proc, (xdrproc_t) xdr_PrepareResult, &yes);
+        send_deferred_reply(d, (xdrproc_t) xdr_PrepareResult, &yes);
+        break;
+    default:
+        if (d->proc == COMMIT) commit_done(d->txn_id);
+        else abort_done(d->txn_id);
+        // ABORT 는 drc_forget 뒤라도 저장: 재전송에 다시 기록하지 않도록 (동기 경로와 같음)
+        drc_store(d->txn_id, d->proc, (xdrproc_t) xdr_int, &ack);
+        send_deferred_reply(d, (xdrproc_t) xdr_int, &ack);
+        break;
+    }
+    deferred_replies++;
+}
+
+// completion thread 가 넘긴 요청을 pending 에서 빼고 마무리
+static void drain_deferred(void) {
+    uint64_t n;
+    Deferred *done, **pp;
+
+    if (read(done_fd, &n, sizeof(n)) < 0 && errno != EAGAIN) perror("eventfd read");
+    pthread_mutex_lock(&done_mu);
+    done = deferred_done;
+    deferred_done = NULL;
+    pthread_mutex_unlock(&done_mu);
+
+    while (done) {
+        Deferred *d = done;
+        done = d->done_next;
+        for (pp = &deferred_pending; *pp != d; pp = &(*pp)->next) ;
+        *pp = d->next;
+        finish_deferred(d);
+        free(d);
+    }
+}
+
+// 기록 중인 요청이 모두 응답할 때까지 기다림: 로그 전체를 보는 요청 (IN_DOUBT, DECIDE_BATCH, PREPARE_EPOCH) 과 종료 전
+static void flush_deferred(void) {
+    struct pollfd pfd = { .fd = done_fd, .events = POLLIN };
+    while (deferred_pending) {
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) { perror("poll"); exit(1); }
+        drain_deferred();
+    }
+}
+
+// 같은 txn 의 레코드가 기록 중이면 그 응답을 먼저 보냄: 뒤에 온 요청 (재전송, 결정) 은 그 결과를 봐야 함
+static void flush_txn(int txn_id) {
+    Deferred *d;
+    for (d = deferred_pending; d; d = d->next)
+        if (d->txn_id == txn_id) { flush_deferred(); return; }
+}
+
+// 자주 오는 PREPARE / PREPARE_COMMIT: lock 목록은 고정 버퍼로 decode 하고 (tree mode 의 subtree 만 할당)
+// handler 를 직접 부름. 응답의 이유 문자열은 NO 일 때만 붙음
+static void serve_prepare(struct svc_req *rqstp, SVCXPRT *transp) {
+    static LockReq locks[MAX_TXN_LOCKS]; // svc_run 은 단일 thread
+    PrepareArgs arg;
+    PrepareResult *r;
+
+    memset(&arg, 0, sizeof(arg));
+    arg.locks.locks_val = locks;
+    if (!svc_getargs(transp, (xdrproc_t) xdr_PrepareArgs_fast, (caddr_t) &arg)) {
+        svcerr_decode(transp);
+        goto out;
+    }
+    flush_txn(arg.txn_id);
+    if (arg.txn_id <= 0 || !drc_reply(transp, arg.txn_id, rqstp->rq_proc)) {
+        if (rqstp->rq_proc == PREPARE) {
+            cur_defer = defer_begin(rqstp, transp, arg.txn_id);
+            r = _prepare_1(&arg, rqstp);
+            free(cur_defer); // 미뤘으면 write_log_deferred 가 가져가 NULL
+            cur_defer = NULL;
+        } else {
+            r = _prepare_commit_1(&arg, rqstp);
+        }
+        // NULL: YES 기록을 submit 함, 응답은 drain_deferred 가 보냄
+        // RETRY 는 저장하지 않음: 다시 온 PREPARE 는 lock 을 이어서 잡아야 함
+        if (r && arg.txn_id > 0 && r->ok != VOTE_RETRY) drc_store(arg.txn_id, rqstp->rq_proc, (xdrproc_t) xdr_PrepareResult, r);
+        if (r && !svc_sendreply(transp, (xdrproc_t) xdr_PrepareResult, (caddr_t) r)) svcerr_systemerr(transp);
+    }
+
+out:
+    // 고정 버퍼는 해제하지 않음. 할당된 것이 있으면 subtree 뿐
+    arg.locks.locks_val = NULL;
+    arg.locks.locks_len = 0;
+    if (arg.subtree.subtree_val) xdr_free((xdrproc_t) xdr_PrepareArgs, (char *) &arg);
+}
+
+// COMMIT / ABORT / STATUS: 인자가 TxnID 하나뿐이라 stack 에 decode 하고 해제할 것이 없음
+static void serve_txn(struct svc_req *rqstp, SVCXPRT *transp) {
+    rpcproc_t proc = rqstp->rq_proc;
+    int cached = proc != STATUS; // STATUS 는 읽기
+    TxnID arg;
+    int *r;
+
+    if (!svc_getargs(transp, (xdrproc_t) xdr_TxnID_fast, (caddr_t) &arg)) { svcerr_decode(transp); return; }
+    flush_txn(arg.txn_id);
+    if (cached && arg.txn_id > 0 && drc_reply(transp, arg.txn_id, proc)) return;
+
+    if (cached) cur_defer = defer_begin(rqstp, transp, arg.txn_id);
+    switch (proc) {
+    case COMMIT: r = _commit_1(&arg, rqstp); break;
+    case ABORT: r = _abort_1(&arg, rqstp); break;
+    default: r = _status_1(&arg, rqstp); break;
+    }
+    free(cur_defer);
+    cur_defer = NULL;
+    if (!r) return; // 결정 레코드를 submit 함, 응답은 drain_deferred 가 보냄
+    if (cached && arg.txn_id > 0) drc_store(arg.txn_id, proc, (xdrproc_t) xdr_int, r);
+    if (!svc_sendreply(transp, (xdrproc_t) xdr_int, (caddr_t) r)) svcerr_systemerr(transp);
+}
+
+void
+participant_dispatch(struct svc_req *rqstp, register SVCXPRT *transp)
+{
+    union {
+        int in_doubt_1_arg;
+        DecisionBatch decide_batch_1_arg;
+        PrepareEpochArgs prepare_epoch_1_arg;
+    } argument;
+    char *result;
+    xdrproc_t _xdr_argument, _xdr_result;
+    char *(*local)(char *, struct svc_req *);
+    int drc_txn;
+
+    switch (rqstp->rq_proc) {
+    case NULLPROC:
+        (void) svc_sendreply (transp, (xdrproc_t) xdr_void, (char *)NULL);
+        return;
+    // txn 마다 오는 요청은 generic 경로 (함수 포인터, svc_freeargs) 를 거치지 않음
+    case PREPARE:
+    case PREPARE_COMMIT:
+        serve_prepare(rqstp, transp);
+        return;
+    case COMMIT:
+    case ABORT:
+    case STATUS:
+        serve_txn(rqstp, transp);
+        return;
+    case IN_DOUBT:
+    case DECIDE_BATCH:
+    case PREPARE_EPOCH:
+        flush_deferred(); // 로그 전체 (또는 여러 txn) 를 보므로 기록 중인 레코드가 먼저 끝나야 함
+        break;
+    default:
+        svcerr_noproc (transp); return;
+    }
+    switch (rqstp->rq_proc) {
+    case IN_DOUBT:
+        _xdr_argument = (xdrproc_t) xdr_int; _xdr_result = (xdrproc_t) xdr_InDoubtList; local = (char *(*)(char *, struct svc_req *)) _in_doubt_1; break;
+    case DECIDE_BATCH:
+        _xdr_argument = (xdrproc_t) xdr_DecisionBatch; _xdr_result = (xdrproc_t) xdr_int; local = (char *(*)(char *, struct svc_req *)) _decide_batch_1; break;
+    case PREPARE_EPOCH:
+        _xdr_argument = (xdrproc_t) xdr_PrepareEpochArgs; _xdr_result = (xdrproc_t) xdr_EpochVotes; local = (char *(*)(char *, struct svc_req *)) _prepare_epoch_1; break;
+    default:
+        return; // 위 switch 에서 이미 답함
+    }
+
+    memset ((char *)&argument, 0, sizeof (argument));
+    if (!svc_getargs (transp, (xdrproc_t) _xdr_argument, (caddr_t) &argument)) { svcerr_decode (transp); return; }
+
+    // 상태를 바꾸는 txn 단위 요청만 cache (IN_DOUBT 는 읽기, DECIDE_BATCH 는 이미 결정된 txn 을 건너뜀)
+    drc_txn = rqstp->rq_proc == PREPARE_EPOCH ? argument.prepare_epoch_1_arg.epoch_id : 0;
+    if (drc_txn > 0 && drc_reply(transp, drc_txn, rqstp->rq_proc)) {
+        svc_freeargs (transp, (xdrproc_t) _xdr_argument, (caddr_t) &argument);
+        return;
+    }
+
+    result = (*local)((char *)&argument, rqstp);
+    if (result != NULL && drc_txn > 0) {
+        drc_store(drc_txn, rqstp->rq_proc, _xdr_result, result);
+        drc_store_epoch(&argument.prepare_epoch_1_arg);
+    }
+    if (result != NULL && !svc_sendreply(transp, (xdrproc_t) _xdr_result, result)) { svcerr_systemerr (transp); }
+    if (!svc_freeargs (transp, (xdrproc_t) _xdr_argument, (caddr_t) &argument)) { fprintf (stderr, "%s", "unable to free arguments"); exit (1); }
+    return;
+}
+
+// svc_run 대신: poll 이 signal 로 깨거나 (SA_RESTART 없음) 100ms 마다 *stop 을 확인.
+// svc_pollfd 뒤에 done_fd 를 붙여 기록을 마친 요청에도 깸 (svc_pollfd 는 TCP 연결마다 바뀌므로 매번 복사)
+void participant_serve(const volatile sig_atomic_t *stop) {
+    struct pollfd *fds = NULL;
+    int cap = 0;
+
+    while (!*stop) {
+        int nsvc = svc_max_pollfd, nfds = nsvc, n;
+        if (nsvc + 1 > cap) {
+            cap = nsvc + 1;
+            fds = realloc(fds, cap * sizeof(*fds));
+            if (!fds) { perror("realloc"); exit(1); }
+        }
+        memcpy(fds, svc_pollfd, nsvc * sizeof(*fds));
+        if (done_fd >= 0) {
+            fds[nfds].fd = done_fd;
+            fds[nfds].events = POLLIN;
+            fds[nfds++].revents = 0;
+        }
+        n = poll(fds, nfds, 100);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            exit(1);
+        }
+        if (nfds > nsvc && fds[nsvc].revents) {
+            drain_deferred();
+            n--;
+        }
+        if (n > 0) svc_getreq_poll(fds, n);
+    }
+    flush_deferred();
+    if (done_fd >= 0)
+        fprintf(stderr, "[INFO] P%d answered %lu request(s) after io_uring completion\n", cfg.id, deferred_replies);
+    fprintf(stderr, "[INFO] P%d stopping on SIGTERM\n", cfg.id);
+    free(fds);
+}
+
+/* ---------- Setup ---------- */
+// DRC 와 subtree 를 비움 (sim 의 재시작: 이전 incarnation 의 메모리 상태)
+static void reset_state(void) {
+    drc_free();
+    while (subtrees) {
+        SubtreeEntry *e = subtrees;
+        subtrees = e->next;
+        free_subtree(e);
+    }
+}
+
+void participant_init(const ParticipantConfig *config) {
+    int rc;
+
+    reset_state();
+    cfg = *config;
+    snprintf(log_file, sizeof(log_file), "txn_%d.log", cfg.id);
+    rc = env->append(log_file, "", 0); // 없으면 빈 로그를 만듦
+    if (rc < 0)
+        fprintf(stderr, "[WARN] P%d could not create log file '%s': %s\n", cfg.id, log_file, strerror(-rc));
+    if (cfg.use_uring && !ulog) ulog = ulog_open(log_file, 0);
+    lm_init(cfg.lock_policy, cfg.lock_wait_ms);
+    drc_init();
+    rebuild_locks_from_log();
+}
+
+void participant_recovery_stats(int *txns, int *in_doubt) {
+    int max_id, id;
+    char *st = read_all_states(&max_id);
+
+    *in_doubt = 0;
+    for (id = 1; id <= max_id; id++)
+        if (st[id - 1] == TS_PREPARED) (*in_doubt)++;
+    free(st);
+    *txns = max_id;
+}
+
+void participant_close(void) {
+    ulog_close(ulog);
+    ulog = NULL;
+}
+
+void participant_listen(void) {
+    SVCXPRT *transp = svcudp_create(RPC_ANYSOCK);
+    if (!transp) { fprintf(stderr, "cannot create udp service.\n"); exit(1); }
+    udp_xprt = transp;
+    if (ulog) {
+        done_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (done_fd < 0) { perror("eventfd"); exit(1); }
+    }
+    if (!svc_register(transp, cfg.prog_number, COMMIT_VERS, participant_dispatch, IPPROTO_UDP)) {
+        fprintf(stderr, "unable to register (0x%lx, COMMIT_VERS, udp).\n", cfg.prog_number);
+        exit(1);
+    }
+
+    transp = svctcp_create(RPC_ANYSOCK, 0, 0);
+    if (!transp) { fprintf(stderr, "cannot create tcp service.\n"); exit(1); }
+    if (!svc_register(transp, cfg.prog_number, COMMIT_VERS, participant_dispatch, IPPROTO_TCP)) {
+        fprintf(stderr, "unable to register (0x%lx, COMMIT_VERS, tcp).\n", cfg.prog_number);
+        exit(1);
+    }
+
+    resume_forwarding();
+}
+
+/* ---------- Per-participant state (sim) ---------- */
+struct ParticipantState {
+    ParticipantConfig cfg;
+    char log_file[256];
+    DrcEntry *drc;
+    DrcEpochRef *drc_epoch_of;
+    unsigned long drc_hits;
+    SubtreeEntry *subtrees;
+};
+
+static ParticipantState *active_state = NULL;
+
+ParticipantState *participant_state_new(void) {
+    ParticipantState *s = calloc(1, sizeof(*s));
+    if (!s) { perror("calloc"); exit(1); }
+    return s;
+}
+
+static void state_save(ParticipantState *s) {
+    s->cfg = cfg;
+    memcpy(s->log_file, log_file, sizeof(log_file));
+    s->drc = drc;
+    s->drc_epoch_of = drc_epoch_of;
+    s->drc_hits = drc_hits;
+    s->subtrees = subtrees;
+}
+
+static void state_load(const ParticipantState *s) {
+    cfg = s->cfg;
+    memcpy(log_file, s->log_file, sizeof(log_file));
+    drc = s->drc;
+    drc_epoch_of = s->drc_epoch_of;
+    drc_hits = s->drc_hits;
+    subtrees = s->subtrees;
+}
+
+void participant_switch(ParticipantState *s) {
+    if (s == active_state) return;
+    if (active_state) state_save(active_state);
+    state_load(s);
+    active_state = s;
+}
+
+void participant_state_free(ParticipantState *s) {
+    ParticipantState empty = { 0 };
+    if (!s) return;
+    participant_switch(s);
+    reset_state();
+    state_load(&empty);
+    active_state = NULL;
+    free(s);
+}
@@ -0,0 +1,59 @@
+#ifndef PARTICIPANT_LIB_H
+#define PARTICIPANT_LIB_H
+
+/*
+ * Participant 의 RPC handler 와 그 상태 (로그, lock 복원, duplicate request cache, tree mode subtree).
+ * participant.c 는 parse_args 와 main 만 가진 CLI 이고, sim.c 는 같은 participant_dispatch 를
+ * 메시지를 직접 전달하는 network 로 불러 한 프로세스 안에서 여러 participant 를 돌린다.
+ *
+ *   participant_init(&cfg);        // 로그 이름, lock / DRC 초기화, 로그로 lock 과 subtree 복원
+ *   participant_listen();          // UDP / TCP 등록 + 남은 결정 전달 재개
+ *   participant_serve(&stop);      // stop 이 설 때까지 요청 처리
+ *
+ * 상태는 프로세스 전역이다. sim 처럼 한 프로세스에 여러 participant 를 두려면 participant 마다
+ * ParticipantState 를 만들고 요청을 넘기기 전에 participant_switch 로 바꿔 끼운다
+ * (lock manager 는 프로세스에 하나뿐이라 바꾸지 않음).
+ */
+
+#include <signal.h>
+#include <rpc/rpc.h>
+#include "lock_manager.h"
+
+#define DRC_DEFAULT_SIZE 1024
+
+typedef struct {
+    int id;
+    unsigned long prog_number;
+    char coord_host[256];
+    int fail_on_prepare;
+    int fail_after_prepare;
+    int fail_on_commit;
+    int fail_on_abort;
+    int fail_after_commit;
+    LockPolicy lock_policy;
+    int lock_wait_ms;
+    int use_uring;
+    char trace_file[256];
+    int recover_only;
+    int drc_size;      // duplicate request cache 크기 (0 = 끔)
+} ParticipantConfig;
+
+// txn_<id>.log 를 만들고 lock manager 와 DRC 를 초기화한 뒤 로그를 재생 (재시작 복구).
+// 같은 상태에 다시 부르면 DRC 를 비우고 처음부터 다시 복구함 (sim 의 재시작)
+void participant_init(const ParticipantConfig *cfg);
+// --recover-only: 로그의 txn 수와 PREPARED 로 남은 수
+void participant_recovery_stats(int *txns, int *in_doubt);
+void participant_close(void);
+
+void participant_listen(void);
+// kill(SIGTERM) 의 handler 가 *stop 을 세우면 기록 중인 요청에 답한 뒤 돌아옴
+void participant_serve(const volatile sig_atomic_t *stop);
+void participant_dispatch(struct svc_req *rqstp, SVCXPRT *transp);
+
+typedef struct ParticipantState ParticipantState;
+ParticipantState *participant_state_new(void);
+// 지금 쓰는 상태를 원래 ParticipantState 에 돌려놓고 s 를 씀. 쓰고 있는 상태는 해제하지 말 것
+void participant_switch(ParticipantState *s);
+void participant_state_free(ParticipantState *s);
+
+#endif /* PARTICIPANT_LIB_H */
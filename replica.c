@@ -0,0 +1,304 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include "replica.h"
+
+#define REPLICA_ACK 'K'
+#define REPLICA_CHUNK (1 << 20) // frame 하나의 최대 크기 (큰 batch / snapshot 은 나눠 보냄)
+#define REPLICA_CONNECT_MS 200
+#define REPLICA_IO_SEC 5        // standby 가 이 시간 안에 ack 하지 않으면 끊긴 것으로 봄
+#define REPLICA_LEASE_POLL_MS 100 // 다시 붙기를 기다리는 standby 가 lease 를 다시 시도하는 주기
+
+/* ---------- Lease ---------- */
+// 내용은 "<holder pid>\n" 또는 "<holder pid> degraded\n". 같은 위치에 덮어쓴 뒤 자르므로 쓰는 도중 죽어도
+// 첫 줄의 degraded 표시가 사라지지 않음
+static int lease_write(int fd, int degraded) {
+    char line[48];
+    int len = snprintf(line, sizeof(line), "%d%s\n", (int) getpid(), degraded ? " degraded" : "");
+    if (pwrite(fd, line, len, 0) != len || ftruncate(fd, len) < 0) return -1;
+    return 0;
+}
+
+int lease_is_degraded(int fd) {
+    char buf[64], *nl;
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return 0;
+    buf[n] = '\0';
+    if ((nl = strchr(buf, '\n'))) *nl = '\0';
+    return strstr(buf, " degraded") != NULL;
+}
+
+int lease_set_degraded(int fd, int degraded) {
+    if (lease_write(fd, degraded) < 0 || fdatasync(fd) < 0) return -1;
+    return 0;
+}
+
+int lease_acquire(const char *path, int wait) {
+    struct flock fl;
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) { perror(path); return -1; }
+
+    memset(&fl, 0, sizeof(fl));
+    fl.l_type = F_WRLCK;
+    fl.l_whence = SEEK_SET; // l_start = l_len = 0: 파일 전체
+    while (fcntl(fd, wait ? F_SETLKW : F_SETLK, &fl) < 0) {
+        if (errno == EINTR) continue;
+        close(fd);
+        return -1;
+    }
+
+    // 사람이 볼 수 있게 holder pid 를 남김. degraded 표시는 이전 holder 가 남긴 그대로 둠
+    if (lease_write(fd, lease_is_degraded(fd)) < 0)
+        perror("lease pid");
+    return fd;
+}
+
+/* ---------- Frame I/O ---------- */
+static int write_all(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// 상대가 닫은 socket 에 쓰면 SIGPIPE 로 프로세스가 죽으므로 (primary 는 lease 까지 놓게 됨) MSG_NOSIGNAL 로 보냄
+static int send_all(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int read_all(int fd, void *buf, size_t len) {
+    char *p = buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// frame: type(1) + len(4, network order) + bytes. REPLICA_CHUNK 보다 크면 나머지는 APPEND frame 으로 이어서 보냄
+int replica_send(int fd, char type, const char *buf, size_t len) {
+    do {
+        size_t part = len < REPLICA_CHUNK ? len : REPLICA_CHUNK;
+        char hdr[5], ack;
+        uint32_t n = htonl((uint32_t) part);
+        hdr[0] = type;
+        memcpy(hdr + 1, &n, 4);
+        if (send_all(fd, hdr, sizeof(hdr)) < 0 || send_all(fd, buf, part) < 0) return -1;
+        if (read_all(fd, &ack, 1) < 0 || ack != REPLICA_ACK) return -1;
+        buf += part;
+        len -= part;
+        type = REPLICA_APPEND;
+    } while (len > 0);
+    return 0;
+}
+
+// 완결된 줄까지만 보냄: 다른 thread 가 쓰는 중인 마지막 줄은 그 thread 가 곧 APPEND 로 보냄
+// (겹치는 레코드가 두 번 들어갈 수는 있지만 txn 별 마지막 상태는 같음)
+int replica_send_file(int fd, const char *path) {
+    FILE *f = fopen(path, "r");
+    char *buf = NULL;
+    size_t len = 0, cap = 0, n;
+    int rc;
+
+    if (f) {
+        for (;;) {
+            if (cap - len < REPLICA_CHUNK) {
+                cap = cap ? cap * 2 : REPLICA_CHUNK * 2;
+                char *grown = realloc(buf, cap);
+                if (!grown) { perror("realloc"); free(buf); fclose(f); return -1; }
+                buf = grown;
+            }
+            n = fread(buf + len, 1, cap - len, f);
+            if (n == 0) break;
+            len += n;
+        }
+        fclose(f);
+    }
+    while (len > 0 && buf[len-1] != '\n') len--;
+
+    // 로그가 비어 있어도 SNAPSHOT 하나는 보내 standby 로그를 비움
+    rc = replica_send(fd, REPLICA_SNAPSHOT, buf ? buf : "", len);
+    free(buf);
+    return rc;
+}
+
+int replica_connect(const char *addr) {
+    struct addrinfo hints, *res, *ai;
+    char host[256];
+    const char *colon = strrchr(addr, ':');
+    int fd = -1, one = 1;
+
+    if (!colon || colon == addr || (size_t)(colon - addr) >= sizeof(host)) {
+        fprintf(stderr, "[ERROR] replica address '%s' must be host:port\n", addr);
+        return -1;
+    }
+    memcpy(host, addr, colon - addr);
+    host[colon - addr] = '\0';
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, colon + 1, &hints, &res) != 0) return -1;
+    // primary 는 commit 경로에서 다시 붙어보므로 죽은 host 에 오래 묶이지 않게 non-blocking connect
+    for (ai = res; ai; ai = ai->ai_next) {
+        struct pollfd pfd;
+        int err = 0;
+        socklen_t errlen = sizeof(err);
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) < 0) {
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            if (errno != EINPROGRESS || poll(&pfd, 1, REPLICA_CONNECT_MS) != 1 ||
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errlen) < 0 || err != 0) {
+                close(fd);
+                fd = -1;
+                continue;
+            }
+        }
+        fcntl(fd, F_SETFL, 0);
+        break;
+    }
+    freeaddrinfo(res);
+    if (fd >= 0) {
+        struct timeval tv = {REPLICA_IO_SEC, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        // 레코드마다 ack 를 기다리므로 작은 frame 이 Nagle 에 묶이지 않게 함
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+/* ---------- Standby ---------- */
+// frame 을 로그에 반영하고 fdatasync. 반영이 끝나야 ack 를 보냄
+static int apply_frame(int log_fd, char type, const char *buf, size_t len) {
+    if (type == REPLICA_SNAPSHOT && ftruncate(log_fd, 0) < 0) return -1;
+    if (write_all(log_fd, buf, len) < 0) return -1;
+    return fdatasync(log_fd);
+}
+
+// primary 연결 하나를 끊길 때까지 처리. SNAPSHOT 부터 받았으면 1 (로그가 primary 와 같음),
+// standby 로그를 쓰지 못하면 -1 (ack 하지 않고 끊으므로 primary 는 복제 없이 진행)
+static int receive_from_primary(int conn, int log_fd, char *buf) {
+    uint64_t frames = 0;
+    int synced = 0;
+    for (;;) {
+        char hdr[5], ack = REPLICA_ACK;
+        uint32_t n;
+        if (read_all(conn, hdr, sizeof(hdr)) < 0) break;
+        memcpy(&n, hdr + 1, 4);
+        n = ntohl(n);
+        if (n > REPLICA_CHUNK || read_all(conn, buf, n) < 0) break;
+        if (hdr[0] == REPLICA_SNAPSHOT) synced = 1;
+        if (!synced) break; // 중간부터 붙은 연결은 믿을 수 없음
+        if (apply_frame(log_fd, hdr[0], buf, n) < 0) { perror("standby log"); return -1; }
+        if (send_all(conn, &ack, 1) < 0) break;
+        frames++;
+    }
+    fprintf(stderr, "[STANDBY] primary disconnected after %llu frame(s)\n", (unsigned long long) frames);
+    return synced;
+}
+
+// primary 가 죽으면 연결이 끊기는 것과 거의 동시에 커널이 lock 을 풀어줌.
+// grace 안에 lease 를 못 잡으면 primary 는 살아 있고 연결만 끊긴 것
+static int try_lease(const char *path, int grace_ms) {
+    int waited, fd;
+    for (waited = 0; waited <= grace_ms; waited++) {
+        if ((fd = lease_acquire(path, 0)) >= 0) return fd;
+        usleep(1000);
+    }
+    return -1;
+}
+
+int replica_standby(const char *log_file, int port, const char *lease_path, struct timespec *lost_at) {
+    struct sockaddr_in sa;
+    int one = 1, listen_fd, log_fd, lease_fd = -1, synced = 0;
+    char *buf;
+
+    memset(lost_at, 0, sizeof(*lost_at));
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) { perror("socket"); return -1; }
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    sa.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(listen_fd, (struct sockaddr *) &sa, sizeof(sa)) < 0 || listen(listen_fd, 4) < 0) {
+        perror("standby listen");
+        close(listen_fd);
+        return -1;
+    }
+    log_fd = open(log_file, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    buf = malloc(REPLICA_CHUNK);
+    if (log_fd < 0 || !buf) {
+        perror(log_file);
+        if (log_fd >= 0) close(log_fd);
+        free(buf);
+        close(listen_fd);
+        return -1;
+    }
+
+    printf("[STANDBY] Receiving log on port %d, lease %s\n", port, lease_path);
+    fflush(stdout);
+
+    // 동기화된 primary 를 잃었을 때만 lease 를 시도. 한 번도 동기화하지 못한 로그로는 넘겨받지 않음.
+    // primary 가 lease 를 쥔 채 다시 붙지 않고 죽을 수도 있으므로, 동기화된 뒤에는 연결을 기다리면서 lease 도 계속 시도
+    while (lease_fd < 0) {
+        if (synced) {
+            struct pollfd pfd = { listen_fd, POLLIN, 0 };
+            int ready = poll(&pfd, 1, REPLICA_LEASE_POLL_MS);
+            if (ready < 0 && errno != EINTR) { perror("poll"); break; }
+            if (ready == 0) lease_fd = lease_acquire(lease_path, 0);
+            if (ready <= 0) continue;
+        }
+        int conn = accept(listen_fd, NULL, NULL);
+        if (conn < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            break;
+        }
+        fprintf(stderr, "[STANDBY] primary connected\n");
+        int rc = receive_from_primary(conn, log_fd, buf);
+        clock_gettime(CLOCK_MONOTONIC, lost_at);
+        close(conn);
+        if (rc < 0) break;
+        if (rc > 0) synced = 1;
+        if (!synced) continue;
+        lease_fd = try_lease(lease_path, 500);
+        if (lease_fd < 0)
+            fprintf(stderr, "[STANDBY] primary still holds the lease. Waiting for it to reconnect or release the lease.\n");
+    }
+
+    free(buf);
+    close(log_fd);
+    close(listen_fd);
+    return lease_fd;
+}
@@ -0,0 +1,41 @@
+#ifndef REPLICA_H
+#define REPLICA_H
+
+/*
+ * Hot-standby coordinator 용 decision log 복제와 lease.
+ * primary 는 txn.log 에 기록한 바이트를 그대로 frame 으로 standby 에게 보내고, standby 가 자기 로그에
+ * 기록 + fdatasync 한 뒤 보내는 ack 를 받아야 다음으로 진행한다 (동기 복제). primary 는 standby 가 없거나
+ * 끊기면 lease 파일에 degraded 를 표시 (fdatasync) 한 뒤에 복제 없이 진행하고, 다시 붙어 로그 전체(SNAPSHOT)를
+ * 보내고 나면 표시를 지운다. standby 는 SNAPSHOT 으로 동기화된 뒤에 primary 를 잃었을 때만 lease 를 시도하고,
+ * 잡은 lease 에 degraded 가 남아 있으면 (자기에게 없는 결정이 있을 수 있으므로) 넘겨받지 않는다.
+ * lease 는 파일 전체에 거는 fcntl write lock. primary 프로세스가 죽으면 커널이 바로 풀어주므로
+ * 연결이 끊긴 standby 가 곧바로 넘겨받는다 (같은 host 또는 lock 을 지원하는 공유 파일시스템).
+ */
+
+#include <stddef.h>
+#include <time.h>
+
+// frame 종류
+#define REPLICA_SNAPSHOT 'S' // standby 로그를 비우고 이 내용으로 시작 (연결 직후 primary 로그 전체)
+#define REPLICA_APPEND 'A'   // 이어 붙이기
+
+// 성공하면 lock 을 쥔 fd (닫으면 풀림), 이미 다른 프로세스가 쥐고 있고 wait == 0 이면 -1
+int lease_acquire(const char *path, int wait);
+// lease 를 쥔 primary 가 standby 와 동기화되지 않은 채 기록하고 있는지. set 은 fdatasync 까지 마치면 0
+int lease_is_degraded(int fd);
+int lease_set_degraded(int fd, int degraded);
+
+// "host:port" 로 TCP 연결 (connect 는 최대 200ms), 실패하면 -1
+int replica_connect(const char *addr);
+// frame 하나를 보내고 standby 의 ack 까지 기다림. 0 = 성공, -1 = 연결 끊김
+int replica_send(int fd, char type, const char *buf, size_t len);
+// path 의 현재 내용 전체 (완결된 줄까지) 를 SNAPSHOT 으로 보냄
+int replica_send_file(int fd, const char *path);
+
+// standby: port 에서 primary 의 frame 을 받아 log_file 에 기록. SNAPSHOT 부터 받은 primary 와의 연결이
+// 끊기면 lease 를 시도해서 잡으면 (primary 종료) lease fd 를 반환, 못 잡으면 (primary 는 살아 있음) 다시 연결을
+// 기다리면서 lease 도 주기적으로 다시 시도함. lost_at 에는 마지막으로 primary 연결이 끊긴 시각 (CLOCK_MONOTONIC).
+// listen / 로그 열기 / standby 로그 기록이 실패하면 -1 (lease 는 쥐지 않음)
+int replica_standby(const char *log_file, int port, const char *lease_path, struct timespec *lost_at);
+
+#endif /* REPLICA_H */
@@ -0,0 +1,819 @@
+/*
+ * Deterministic simulation harness.
+ * 실제 coord_lib.c 와 participant_lib.c 를 한 프로세스 안에서 simulated env (env.h) 위에 돌린다.
+ * - clock: virtual clock. sleep 과 RPC 대기는 시간을 건너뛰기만 함
+ * - network: env->connect 가 돌려주는 CLIENT 는 요청을 XDR 로 encode 해 가짜 SVCXPRT 로
+ *            participant_dispatch 에 직접 넘기고 응답을 decode 함. 요청 / 응답 drop, 지연, 중복
+ *            (복사본은 나중에 도착해 다른 요청과 순서가 바뀜). 잃은 요청은 CLSET_TIMEOUT 뒤 RPC_TIMEDOUT
+ * - disk: node 별 in-memory 로그. env->crash_point 가 불리는 곳 (maybe_fail 의 phase 와 로그 레코드 직후)
+ *         마다 crash point 번호가 매겨지고, 시나리오가 고른 번호에서 그 node 가 죽는다. 로그 직후에 죽으면
+ *         마지막 레코드가 디스크에 남지 않았을 수도 있음 (lost)
+ * participant 는 죽으면 0.1~5초 뒤 다시 participant_init 으로 로그를 재생한다. coordinator 는 thread 를
+ * 멈출 수 없으므로 죽은 뒤로는 로그 append 가 실패하고 RPC 가 나가지 않고 sleep 이 바로 돌아오게 해서
+ * 자기 오류 경로로 빠져나오게 한 뒤 (밖에 남기는 것이 없음), coord_close 하고 같은 시간 뒤 coord_open
+ * (recovery) 으로 다시 띄운다 (로그가 있으면 coordinator.c 처럼 복구만 함).
+ * 같은 seed 는 항상 같은 실행을 만든다: worker 는 하나이고 한 번에 한 thread 만 돈다.
+ * 끝나면 atomicity 와 in-doubt 시간 (latency bound) 을 검사.
+ *
+ * 시나리오는 lock 없는 txn 하나를 flat 2PC 로 보낸다. lock manager 는 프로세스에 하나뿐이라 participant 끼리
+ * 공유되므로 lock 은 쓰지 않고, one-phase / epoch / tree mode / standby / io_uring log 는 다루지 않는다.
+ * notify 가 실패해 "Recovery needed" 로 끝난 participant 는 PREPARED 로 남고 unresolved_in_doubt 로 센다.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <getopt.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <setjmp.h>
+#include <unistd.h>
+#include <time.h>
+#include <rpc/rpc.h>
+#include "coord_lib.h"
+#include "participant_lib.h"
+#include "env.h"
+
+#define SIM_MAX_PARTICIPANTS 8
+#define SIM_MAX_CRASHES 3
+#define SIM_MAX_MSG 16384          // DECIDE_BATCH / IN_DOUBT 응답 (MAX_INDOUBT 개) 보다 큼
+#define SIM_MAX_PACKETS 256
+#define SIM_PROG_BASE 0x20000000
+
+#define MS 1000ULL
+#define SEC (1000ULL * MS)
+
+typedef struct {
+    char *data;
+    size_t len, cap;
+    size_t last_len;           // 마지막 append 의 길이 (crash 때 잃을 수 있음)
+} SimFile;
+
+typedef struct {
+    int up;
+    unsigned incarnation;      // 죽을 때마다 증가: 이전 incarnation 으로 연결한 client 의 요청은 닿지 않음
+    uint64_t restart_at;
+    ParticipantConfig cfg;
+    ParticipantState *state;
+    SimFile log;               // 0 = txn.log, p = txn_<p>.log
+    uint64_t prepared_at;      // in-doubt 시작 시각 (txn 1)
+    uint64_t resolved_at;
+    uint64_t undo[3];          // 마지막 append 전의 prepared_at / resolved_at / completed_at
+} Node;
+
+// 나중에 도착하는 요청 (중복된 복사본, timeout 보다 늦은 요청). 응답은 버림
+typedef struct {
+    uint64_t at, seq;
+    int node;
+    unsigned incarnation;
+    rpcproc_t proc;
+    char *buf;
+    u_int len;
+} Packet;
+
+typedef struct SimClient {
+    CLIENT clnt;
+    int node;
+    unsigned incarnation;
+    uint64_t timeout;          // CLSET_TIMEOUT (0 = clnt_call 의 인자)
+    enum clnt_stat stat;
+    struct SimClient *next;    // 시나리오 끝에 남은 것 (crash 로 clnt_destroy 하지 못한 것) 을 해제
+} SimClient;
+
+// participant_dispatch 에 넘기는 transport: 요청 buffer 에서 decode 하고 응답을 encode 해 둠
+typedef struct {
+    SVCXPRT xprt;
+    const char *req;
+    u_int req_len;
+    int replied;
+    enum clnt_stat stat;
+    u_int reply_len;
+    char reply[SIM_MAX_MSG];
+} SimXprt;
+
+typedef struct {
+    int participants;
+    double drop, dup;
+    uint64_t min_delay, max_delay;
+    uint64_t min_fsync, max_fsync;
+    uint64_t max_indoubt;
+    int crash_sites[SIM_MAX_CRASHES];
+    int crash_lost[SIM_MAX_CRASHES];  // 로그 직후의 crash 면 마지막 레코드를 잃음
+    int ncrash;
+} Scenario;
+
+typedef struct {
+    uint64_t now;
+    uint64_t seq;
+    uint64_t rng;
+    Scenario sc;
+    Node nodes[SIM_MAX_PARTICIPANTS + 1]; // 0 = coordinator
+    SimFile conf;
+    Packet packets[SIM_MAX_PACKETS];
+    int npackets;
+    SimClient *clients;
+    int cur_node;              // 지금 코드를 돌리는 node (crash point 와 fsync 시간을 누구에게 매길지)
+    jmp_buf *crash_jmp;        // participant 가 죽으면 요청 전달 지점으로
+    int coord_dead;            // coordinator 가 죽음: coord_close 까지 밖으로 아무것도 내보내지 않음
+    int site;                  // 지금까지 지난 crash point 수
+    int crashes;
+    uint64_t completed_at;
+    int verbose;
+    FILE *out;                 // 결과 출력 (-v 가 아니면 stdout / stderr 는 /dev/null)
+} Sim;
+
+typedef struct {
+    long runs, commits, aborts, crashes;
+    long atomicity_violations, unresolved, latency_violations;
+    uint64_t max_indoubt, max_complete;
+} Stats;
+
+static Sim sim;
+
+/* ---------- RNG (xorshift64*) ---------- */
+static uint64_t rnd(void) {
+    sim.rng ^= sim.rng >> 12;
+    sim.rng ^= sim.rng << 25;
+    sim.rng ^= sim.rng >> 27;
+    return sim.rng * 2685821657736338717ULL;
+}
+
+static uint64_t rnd_range(uint64_t lo, uint64_t hi) {
+    return hi <= lo ? lo : lo + rnd() % (hi - lo + 1);
+}
+
+static int chance(double p) {
+    return p > 0 && (double)(rnd() >> 11) / (double)(1ULL << 53) < p;
+}
+
+static void sim_log(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+static void sim_log(const char *fmt, ...) {
+    va_list ap;
+    if (!sim.verbose) return;
+    printf("%8.3fms  ", sim.now / 1000.0);
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+    putchar('\n');
+}
+
+static const char *proc_name(rpcproc_t proc) {
+    switch (proc) {
+    case PREPARE: return "PREPARE";
+    case COMMIT: return "COMMIT";
+    case ABORT: return "ABORT";
+    case STATUS: return "STATUS";
+    case IN_DOUBT: return "IN_DOUBT";
+    case DECIDE_BATCH: return "DECIDE_BATCH";
+    case PREPARE_EPOCH: return "PREPARE_EPOCH";
+    case PREPARE_COMMIT: return "PREPARE_COMMIT";
+    default: return "NULLPROC";
+    }
+}
+
+// buf 의 줄 중에 "1 <state>" 가 있는지 (txn 1 만 보냄)
+static int has_record(const char *buf, size_t len, const char *state) {
+    const char *p = buf, *end = buf + len;
+    size_t n = strlen(state);
+    while (p < end) {
+        const char *nl = memchr(p, '\n', end - p);
+        if (!nl) nl = end;
+        if ((size_t)(nl - p) >= n + 2 && p[0] == '1' && p[1] == ' ' && strncmp(p + 2, state, n) == 0 &&
+            (p + 2 + n == nl || p[2 + n] == ' '))
+            return 1;
+        p = nl + 1;
+    }
+    return 0;
+}
+
+/* ---------- Participant ---------- */
+static void start_participant(int p) {
+    Node *n = &sim.nodes[p];
+    int prev = sim.cur_node;
+    n->up = 1;
+    participant_switch(n->state);
+    sim.cur_node = p;
+    participant_init(&n->cfg);
+    sim.cur_node = prev;
+}
+
+// 죽은 participant 는 누가 연결하거나 요청이 도착할 때 restart 시각이 지났으면 다시 뜸
+static void maybe_restart(int p) {
+    Node *n = &sim.nodes[p];
+    if (n->up || sim.now < n->restart_at) return;
+    sim_log("P%d restarted", p);
+    start_participant(p);
+}
+
+static bool_t xp_getargs(SVCXPRT *xprt, xdrproc_t xdr_args, void *args) {
+    SimXprt *x = (SimXprt *) xprt;
+    XDR xdrs;
+    bool_t ok;
+    xdrmem_create(&xdrs, (char *) x->req, x->req_len, XDR_DECODE);
+    ok = xdr_args(&xdrs, args);
+    xdr_destroy(&xdrs);
+    return ok;
+}
+
+static bool_t xp_freeargs(SVCXPRT *xprt, xdrproc_t xdr_args, void *args) {
+    (void) xprt;
+    xdr_free(xdr_args, args);
+    return TRUE;
+}
+
+// svc_sendreply / svcerr_* 가 부름
+static bool_t xp_reply(SVCXPRT *xprt, struct rpc_msg *msg) {
+    SimXprt *x = (SimXprt *) xprt;
+    XDR xdrs;
+    bool_t ok;
+
+    x->replied = 1;
+    if (msg->rm_reply.rp_stat != MSG_ACCEPTED) { x->stat = RPC_AUTHERROR; return TRUE; }
+    switch (msg->acpted_rply.ar_stat) {
+    case SUCCESS: break;
+    case PROG_UNAVAIL: x->stat = RPC_PROGUNAVAIL; return TRUE;
+    case PROG_MISMATCH: x->stat = RPC_PROGVERSMISMATCH; return TRUE;
+    case PROC_UNAVAIL: x->stat = RPC_PROCUNAVAIL; return TRUE;
+    case GARBAGE_ARGS: x->stat = RPC_CANTDECODEARGS; return TRUE;
+    default: x->stat = RPC_SYSTEMERROR; return TRUE;
+    }
+    xdrmem_create(&xdrs, x->reply, sizeof(x->reply), XDR_ENCODE);
+    ok = msg->acpted_rply.ar_results.proc(&xdrs, msg->acpted_rply.ar_results.where);
+    x->reply_len = xdr_getpos(&xdrs);
+    xdr_destroy(&xdrs);
+    x->stat = ok ? RPC_SUCCESS : RPC_SYSTEMERROR;
+    return ok;
+}
+
+static const struct xp_ops sim_xp_ops = { NULL, NULL, xp_getargs, xp_reply, xp_freeargs, NULL };
+
+// 요청을 participant 에게 전달. 죽어 있거나 (재시작했으면 이전 주소로 보낸 것이라) 받지 못했거나,
+// 처리하다 죽었거나 응답하지 않았으면 0
+static int deliver(int p, unsigned incarnation, rpcproc_t proc, const char *req, u_int len, SimXprt *x) {
+    Node *n = &sim.nodes[p];
+    struct svc_req rq;
+    jmp_buf here, *saved = sim.crash_jmp;
+    int prev = sim.cur_node;
+    volatile int ok = 0;
+
+    maybe_restart(p);
+    if (!n->up || n->incarnation != incarnation) return 0;
+
+    memset(x, 0, offsetof(SimXprt, reply));
+    x->xprt.xp_ops = &sim_xp_ops;
+    x->xprt.xp_verf = _null_auth;
+    x->req = req;
+    x->req_len = len;
+    memset(&rq, 0, sizeof(rq));
+    rq.rq_prog = n->cfg.prog_number;
+    rq.rq_vers = COMMIT_VERS;
+    rq.rq_proc = proc;
+    rq.rq_xprt = &x->xprt;
+
+    participant_switch(n->state);
+    sim.cur_node = p;
+    sim.crash_jmp = &here;
+    if (setjmp(here) == 0) {
+        participant_dispatch(&rq, &x->xprt);
+        ok = x->replied;
+    }
+    sim.cur_node = prev;
+    sim.crash_jmp = saved;
+    return ok;
+}
+
+/* ---------- Network ---------- */
+static uint64_t net_delay(void) {
+    return rnd_range(sim.sc.min_delay, sim.sc.max_delay);
+}
+
+static void queue_packet(const SimClient *sc, rpcproc_t proc, const char *buf, u_int len, uint64_t at) {
+    Packet *pk;
+    if (sim.npackets >= SIM_MAX_PACKETS) { fprintf(sim.out, "[SIM] packet queue overflow\n"); exit(2); }
+    pk = &sim.packets[sim.npackets++];
+    pk->at = at;
+    pk->seq = sim.seq++;
+    pk->node = sc->node;
+    pk->incarnation = sc->incarnation;
+    pk->proc = proc;
+    pk->buf = malloc(len);
+    if (!pk->buf) { perror("malloc"); exit(2); }
+    memcpy(pk->buf, buf, len);
+    pk->len = len;
+}
+
+static int next_packet(void) {
+    int i, first = -1;
+    for (i = 0; i < sim.npackets; i++) {
+        const Packet *a = &sim.packets[i], *b = &sim.packets[first < 0 ? i : first];
+        if (first < 0 || a->at < b->at || (a->at == b->at && a->seq < b->seq)) first = i;
+    }
+    return first;
+}
+
+// 시간을 t 까지 진행하면서 그 사이에 도착하는 packet 을 전달
+static void advance_to(uint64_t t) {
+    static SimXprt x;
+    int i;
+    while ((i = next_packet()) >= 0 && sim.packets[i].at <= t) {
+        Packet pk = sim.packets[i];
+        sim.packets[i] = sim.packets[--sim.npackets];
+        if (pk.at > sim.now) sim.now = pk.at;
+        sim_log("late %s -> P%d", proc_name(pk.proc), pk.node);
+        deliver(pk.node, pk.incarnation, pk.proc, pk.buf, pk.len, &x);
+        free(pk.buf);
+    }
+    if (t > sim.now) sim.now = t;
+}
+
+static uint64_t tv_us(struct timeval tv) {
+    return (uint64_t) tv.tv_sec * SEC + tv.tv_usec;
+}
+
+static enum clnt_stat timed_out(SimClient *sc, uint64_t deadline) {
+    advance_to(deadline);
+    sim_log("coord: RPC to P%d timed out", sc->node);
+    return sc->stat = RPC_TIMEDOUT;
+}
+
+static enum clnt_stat sim_call(CLIENT *cl, rpcproc_t proc, xdrproc_t xargs, void *args,
+                               xdrproc_t xres, void *res, struct timeval tmo) {
+    static char req[SIM_MAX_MSG]; // 한 번에 한 thread 만 RPC 를 보냄
+    static SimXprt x;
+    SimClient *sc = (SimClient *) cl;
+    uint64_t deadline = sim.now + (sc->timeout ? sc->timeout : tv_us(tmo)), arrive;
+    XDR xdrs;
+    u_int len;
+    bool_t ok;
+
+    if (sim.coord_dead) return sc->stat = RPC_TIMEDOUT;
+
+    xdrmem_create(&xdrs, req, sizeof(req), XDR_ENCODE);
+    ok = xargs(&xdrs, args);
+    len = xdr_getpos(&xdrs);
+    xdr_destroy(&xdrs);
+    if (!ok) return sc->stat = RPC_CANTENCODEARGS;
+
+    if (chance(sim.sc.dup)) queue_packet(sc, proc, req, len, sim.now + net_delay());
+    if (chance(sim.sc.drop)) {
+        sim_log("drop %s -> P%d", proc_name(proc), sc->node);
+        return timed_out(sc, deadline);
+    }
+    arrive = sim.now + net_delay();
+    if (arrive > deadline) {
+        queue_packet(sc, proc, req, len, arrive);
+        return timed_out(sc, deadline);
+    }
+    advance_to(arrive);
+    sim_log("%s -> P%d", proc_name(proc), sc->node);
+    if (!deliver(sc->node, sc->incarnation, proc, req, len, &x)) return timed_out(sc, deadline);
+
+    if (chance(sim.sc.drop)) {
+        sim_log("drop reply P%d ->", sc->node);
+        return timed_out(sc, deadline);
+    }
+    arrive = sim.now + net_delay();
+    if (arrive > deadline) return timed_out(sc, deadline);
+    advance_to(arrive);
+    if (x.stat != RPC_SUCCESS) return sc->stat = x.stat;
+
+    xdrmem_create(&xdrs, x.reply, x.reply_len, XDR_DECODE);
+    ok = xres(&xdrs, res);
+    xdr_destroy(&xdrs);
+    return sc->stat = ok ? RPC_SUCCESS : RPC_CANTDECODERES;
+}
+
+static void sim_abort(CLIENT *cl) {
+    (void) cl;
+}
+
+static void sim_geterr(CLIENT *cl, struct rpc_err *err) {
+    memset(err, 0, sizeof(*err));
+    err->re_status = ((SimClient *) cl)->stat;
+}
+
+static bool_t sim_freeres(CLIENT *cl, xdrproc_t xres, void *res) {
+    (void) cl;
+    xdr_free(xres, res);
+    return TRUE;
+}
+
+static void sim_destroy(CLIENT *cl) {
+    SimClient **pp;
+    for (pp = &sim.clients; *pp; pp = &(*pp)->next) {
+        if (&(*pp)->clnt != cl) continue;
+        *pp = (*pp)->next;
+        break;
+    }
+    free(cl);
+}
+
+static bool_t sim_control(CLIENT *cl, u_int req, void *info) {
+    if (req != CLSET_TIMEOUT) return FALSE;
+    ((SimClient *) cl)->timeout = tv_us(*(struct timeval *) info);
+    return TRUE;
+}
+
+static struct clnt_ops sim_clnt_ops = { sim_call, sim_abort, sim_geterr, sim_freeres, sim_destroy, sim_control };
+
+/* ---------- Env ---------- */
+static void sim_now(struct timespec *ts) {
+    ts->tv_sec = sim.now / SEC;
+    ts->tv_nsec = (long)(sim.now % SEC) * 1000;
+}
+
+static void sim_sleep_ms(int ms) {
+    if (sim.coord_dead && sim.cur_node == 0) return;
+    if (sim.cur_node > 0) sim.now += (uint64_t) ms * MS; // participant 안에서는 다른 요청을 끼워넣지 않음
+    else advance_to(sim.now + (uint64_t) ms * MS);
+}
+
+static SimFile *file_of(const char *path, int *node) {
+    int p;
+    *node = -1;
+    if (strcmp(path, "participants.conf") == 0) return &sim.conf;
+    if (strcmp(path, COORD_DEFAULT_LOG_FILE) == 0) p = 0;
+    else if (sscanf(path, "txn_%d.log", &p) != 1 || p < 1 || p > sim.sc.participants) return NULL;
+    *node = p;
+    return &sim.nodes[p].log;
+}
+
+static int sim_append(const char *path, const char *buf, size_t len) {
+    int node;
+    SimFile *f = file_of(path, &node);
+    Node *n;
+    if (!f || node < 0) return -EIO;
+    if (sim.coord_dead && sim.cur_node == 0) return -EIO;
+    n = &sim.nodes[node];
+
+    if (f->len + len > f->cap) {
+        size_t cap = f->cap ? f->cap * 2 : 256;
+        while (cap < f->len + len) cap *= 2;
+        f->data = realloc(f->data, cap);
+        if (!f->data) { perror("realloc"); exit(2); }
+        f->cap = cap;
+    }
+    memcpy(f->data + f->len, buf, len);
+    f->len += len;
+    f->last_len = len;
+    if (len == 0) return 0;
+
+    n->undo[0] = n->prepared_at;
+    n->undo[1] = n->resolved_at;
+    n->undo[2] = sim.completed_at;
+    // fsync 시간. participant 는 요청을 처리하는 도중이므로 다른 packet 을 끼워넣지 않음
+    if (sim.cur_node > 0) sim.now += rnd_range(sim.sc.min_fsync, sim.sc.max_fsync);
+    else advance_to(sim.now + rnd_range(sim.sc.min_fsync, sim.sc.max_fsync));
+
+    if (node > 0) {
+        if (!n->prepared_at && has_record(buf, len, "PREPARED")) n->prepared_at = sim.now;
+        if (n->prepared_at && !n->resolved_at && (has_record(buf, len, "COMMITTED") || has_record(buf, len, "ABORT")))
+            n->resolved_at = sim.now;
+    } else if (has_record(buf, len, "COMPLETE")) {
+        sim.completed_at = sim.now;
+    }
+    if (sim.verbose) {
+        const char *p = buf, *end = buf + len, *nl;
+        for (; p < end; p = nl + 1) {
+            nl = memchr(p, '\n', end - p);
+            if (!nl) nl = end;
+            sim_log("node %d log: %.*s", node, (int)(nl - p), p);
+        }
+    }
+    return 0;
+}
+
+// 비어 있으면 없는 것과 같이 NULL (로그를 읽는 곳은 둘을 똑같이 다룸)
+static FILE *sim_open_read(const char *path) {
+    int node;
+    SimFile *f = file_of(path, &node);
+    if (!f || f->len == 0) { errno = ENOENT; return NULL; }
+    return fmemopen(f->data, f->len, "r");
+}
+
+static CLIENT *sim_connect(const char *host, rpcprog_t prog, rpcvers_t vers, const char *proto) {
+    int p = (int)(prog - SIM_PROG_BASE);
+    SimClient *sc;
+    (void) host; (void) vers; (void) proto;
+
+    if (p < 1 || p > sim.sc.participants) { rpc_createerr.cf_stat = RPC_UNKNOWNHOST; return NULL; }
+    if (sim.coord_dead) { rpc_createerr.cf_stat = RPC_PROGNOTREGISTERED; return NULL; }
+    maybe_restart(p);
+    if (!sim.nodes[p].up) { rpc_createerr.cf_stat = RPC_PROGNOTREGISTERED; return NULL; }
+
+    sc = calloc(1, sizeof(*sc));
+    if (!sc) { perror("calloc"); exit(2); }
+    sc->clnt.cl_ops = &sim_clnt_ops;
+    sc->node = p;
+    sc->incarnation = sim.nodes[p].incarnation;
+    sc->stat = RPC_SUCCESS;
+    sc->next = sim.clients;
+    sim.clients = sc;
+    return &sc->clnt;
+}
+
+static void sim_crash_point(const char *site) {
+    int k, node = sim.cur_node;
+    Node *n = &sim.nodes[node];
+
+    if (node == 0 && sim.coord_dead) return;
+    sim.site++;
+    for (k = 0; k < sim.sc.ncrash; k++)
+        if (sim.sc.crash_sites[k] == sim.site) break;
+    if (k == sim.sc.ncrash) return;
+
+    if (strcmp(site, "log") == 0 && sim.sc.crash_lost[k]) {
+        n->log.len -= n->log.last_len;
+        n->log.last_len = 0;
+        n->prepared_at = n->undo[0];
+        n->resolved_at = n->undo[1];
+        sim.completed_at = n->undo[2];
+    }
+    sim_log("[CRASH] node %d at site %d (%s%s)", node, sim.site, site,
+            strcmp(site, "log") == 0 && sim.sc.crash_lost[k] ? ", record lost" : "");
+    sim.crashes++;
+
+    if (node > 0) {
+        n->up = 0;
+        n->incarnation++;
+        n->restart_at = sim.now + rnd_range(100 * MS, 5 * SEC);
+        longjmp(*sim.crash_jmp, 1);
+    }
+    sim.coord_dead = 1;
+}
+
+static const Env sim_env = {
+    sim_now, sim_sleep_ms, sim_append, sim_open_read, sim_connect, sim_crash_point
+};
+
+/* ---------- Coordinator ---------- */
+static void on_done(int txn_id, int decision, void *arg) {
+    *(int *) arg = 1;
+    sim_log("coord: Txn %d done (%s)", txn_id,
+            decision == COORD_DECISION_UNKNOWN ? "UNKNOWN" : decision ? "COMMIT" : "ABORT");
+}
+
+// coordinator 프로세스 한 번: coord_open (로그가 있으면 recovery) 부터 coord_close 까지. 도중에 죽었으면 1
+static int run_coordinator(void) {
+    CoordOptions opts;
+    Coordinator *c;
+    int done = 0;
+
+    sim.coord_dead = 0;
+    coord_options_init(&opts);
+    opts.workers = 1;
+    c = coord_open(&opts);
+    if (!c) {
+        if (sim.coord_dead) return 1; // recovery 중에 죽어 로그를 쓰지 못함
+        fprintf(sim.out, "[SIM] coord_open failed\n");
+        exit(2);
+    }
+
+    // coordinator.c 와 같이 로그에 txn 이 있으면 복구만 함
+    if (coord_next_txn_id(c) == 1) {
+        if (coord_submit(coord_begin(c), on_done, &done) != COORD_SUBMIT_OK) {
+            fprintf(sim.out, "[SIM] coord_submit failed\n");
+            exit(2);
+        }
+    } else {
+        done = 1;
+    }
+    while (!done) {
+        struct pollfd pfd = { coord_event_fd(c), POLLIN, 0 };
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) { perror("poll"); exit(2); }
+        coord_poll(c);
+    }
+    coord_close(c);
+    return sim.coord_dead;
+}
+
+/* ---------- Scenario ---------- */
+static void make_scenario(const Scenario *base, int max_crashes) {
+    int k;
+    sim.sc = *base;
+    if (sim.sc.participants <= 0)
+        sim.sc.participants = (int)rnd_range(1, 5);
+    // crash point 번호는 정상 실행 한 번이 지나는 site 수 (3 + 8 * participants) 정도 범위에서 고름
+    sim.sc.ncrash = (int)rnd_range(0, max_crashes);
+    for (k = 0; k < sim.sc.ncrash; k++) {
+        sim.sc.crash_sites[k] = (int)rnd_range(1, 4 + 8 * sim.sc.participants);
+        sim.sc.crash_lost[k] = (int)(rnd() & 1);
+    }
+}
+
+static void check(uint64_t seed, Stats *st) {
+    const SimFile *clog = &sim.nodes[0].log;
+    int coord_commit = has_record(clog->data, clog->len, "DECISION_COMMIT");
+    int coord_abort = has_record(clog->data, clog->len, "DECISION_ABORT");
+    int p, committed = 0, aborted = 0, all_yes = 1;
+    char why[128] = "";
+
+    for (p = 1; p <= sim.sc.participants; p++) {
+        Node *n = &sim.nodes[p];
+        int c = has_record(n->log.data, n->log.len, "COMMITTED");
+        int a = has_record(n->log.data, n->log.len, "ABORT");
+        int y = has_record(n->log.data, n->log.len, "PREPARED");
+        committed += c;
+        aborted += a;
+        if (!y) all_yes = 0;
+
+        if (y && !c && !a) {
+            st->unresolved++;
+            if (sim.verbose) printf("  P%d still PREPARED (in doubt)\n", p);
+        } else if (n->prepared_at && n->resolved_at) {
+            uint64_t d = n->resolved_at - n->prepared_at;
+            if (d > st->max_indoubt) st->max_indoubt = d;
+            if (sim.sc.max_indoubt && d > sim.sc.max_indoubt) {
+                st->latency_violations++;
+                if (sim.verbose) printf("  P%d in doubt for %.3fms\n", p, d / 1000.0);
+            }
+        }
+    }
+
+    if (committed && aborted) snprintf(why, sizeof(why), "participants disagree (%d COMMITTED, %d ABORT)", committed, aborted);
+    else if (committed && !coord_commit) snprintf(why, sizeof(why), "COMMITTED without DECISION_COMMIT");
+    else if (aborted && coord_commit) snprintf(why, sizeof(why), "ABORT after DECISION_COMMIT");
+    else if (coord_commit && !all_yes) snprintf(why, sizeof(why), "DECISION_COMMIT without all PREPARED");
+    else if (coord_commit && coord_abort) snprintf(why, sizeof(why), "both DECISION_COMMIT and DECISION_ABORT logged");
+
+    if (why[0]) {
+        st->atomicity_violations++;
+        fprintf(sim.out, "[VIOLATION] seed=%llu: %s\n", (unsigned long long)seed, why);
+    }
+    if (coord_commit) st->commits++; else st->aborts++;
+    if (sim.completed_at > st->max_complete) st->max_complete = sim.completed_at;
+    st->crashes += sim.crashes;
+}
+
+static void reset(void) {
+    int p;
+    while (sim.clients) sim_destroy(&sim.clients->clnt);
+    for (p = 0; p <= SIM_MAX_PARTICIPANTS; p++) {
+        participant_state_free(sim.nodes[p].state);
+        free(sim.nodes[p].log.data);
+    }
+    free(sim.conf.data);
+    while (sim.npackets > 0) free(sim.packets[--sim.npackets].buf);
+    memset(sim.nodes, 0, sizeof(sim.nodes));
+    memset(&sim.conf, 0, sizeof(sim.conf));
+}
+
+static void run_one(uint64_t seed, const Scenario *base, int max_crashes, Stats *st) {
+    char line[64];
+    int p, len;
+
+    sim.now = 0;
+    sim.seq = 0;
+    sim.site = 0;
+    sim.crashes = 0;
+    sim.completed_at = 0;
+    sim.cur_node = 0;
+    sim.rng = seed * 0x9E3779B97F4A7C15ULL + 1;
+    make_scenario(base, max_crashes);
+
+    if (sim.verbose)
+        printf("seed=%llu participants=%d crashes=%d\n", (unsigned long long)seed, sim.sc.participants, sim.sc.ncrash);
+
+    for (p = 1; p <= sim.sc.participants; p++) {
+        Node *n = &sim.nodes[p];
+        len = snprintf(line, sizeof(line), "sim 0x%x\n", SIM_PROG_BASE + p);
+        sim.conf.data = realloc(sim.conf.data, sim.conf.len + len);
+        if (!sim.conf.data) { perror("realloc"); exit(2); }
+        memcpy(sim.conf.data + sim.conf.len, line, len);
+        sim.conf.len += len;
+
+        strcpy(n->cfg.coord_host, "sim");
+        n->cfg.id = p;
+        n->cfg.prog_number = SIM_PROG_BASE + p;
+        n->cfg.lock_policy = LM_NO_WAIT;
+        n->cfg.drc_size = DRC_DEFAULT_SIZE;
+        n->state = participant_state_new();
+        start_participant(p);
+    }
+
+    // coordinator 가 죽으면 (recovery 중이든 txn 진행 중이든) 잠시 뒤 같은 로그로 다시 띄움
+    while (run_coordinator()) {
+        advance_to(sim.now + rnd_range(100 * MS, 5 * SEC));
+        sim_log("coordinator restarted");
+    }
+    // 남은 중복 packet 까지 도착시킨 뒤 검사
+    while ((p = next_packet()) >= 0) advance_to(sim.packets[p].at);
+
+    check(seed, st);
+    st->runs++;
+    reset();
+}
+
+/* ---------- CLI ---------- */
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [OPTIONS]\n"
+        "--seed <n>            (첫 seed, 기본 1)\n"
+        "--runs <n>            (시나리오 수, 기본 1000)\n"
+        "--participants <n>    (기본: 시나리오마다 1~5, 최대 8)\n"
+        "--drop <p>            (요청 / 응답 drop 확률)\n"
+        "--dup <p>             (요청 중복 확률)\n"
+        "--delay-ms <min,max>  (네트워크 지연, 기본 0.1,5)\n"
+        "--fsync-ms <min,max>  (로그 append 지연, 기본 0.1,2)\n"
+        "--crashes <n>         (시나리오당 최대 crash 수, 기본 2, 최대 3)\n"
+        "--max-indoubt-ms <n>  (PREPARED -> 결정까지 허용 시간, 0 = 검사 안 함)\n"
+        "--strict              (in-doubt 로 남은 participant 나 latency 초과도 실패 처리)\n"
+        "-v,--verbose          (이벤트와 coordinator / participant 출력, 단일 seed 재현용)\n"
+        "-h,--help\n",
+        prog);
+}
+
+static void parse_range_ms(const char *arg, uint64_t *lo, uint64_t *hi) {
+    double a = 0, b = 0;
+    if (sscanf(arg, "%lf,%lf", &a, &b) != 2) b = a;
+    *lo = (uint64_t)(a * 1000);
+    *hi = (uint64_t)(b * 1000);
+}
+
+int main(int argc, char **argv) {
+    Scenario base;
+    Stats st;
+    uint64_t seed = 1;
+    long runs = 1000, i;
+    int max_crashes = 2, strict = 0;
+    struct timespec t0, t1;
+
+    memset(&base, 0, sizeof(base));
+    memset(&st, 0, sizeof(st));
+    base.min_delay = 100; base.max_delay = 5 * MS;
+    base.min_fsync = 100; base.max_fsync = 2 * MS;
+
+    static struct option long_opts[] = {
+        {"seed", required_argument, 0, 's'},
+        {"runs", required_argument, 0, 'n'},
+        {"participants", required_argument, 0, 'p'},
+        {"drop", required_argument, 0, 1},
+        {"dup", required_argument, 0, 2},
+        {"delay-ms", required_argument, 0, 3},
+        {"fsync-ms", required_argument, 0, 4},
+        {"crashes", required_argument, 0, 5},
+        {"max-indoubt-ms", required_argument, 0, 7},
+        {"strict", no_argument, 0, 8},
+        {"verbose", no_argument, 0, 'v'},
+        {"help", no_argument, 0, 'h'},
+        {0,0,0,0}
+    };
+
+    int opt, index = 0;
+    while ((opt = getopt_long(argc, argv, "s:n:p:vh", long_opts, &index)) != -1) {
+        switch (opt) {
+            case 's': seed = strtoull(optarg, NULL, 0); break;
+            case 'n': runs = atol(optarg); break;
+            case 'p': base.participants = atoi(optarg); break;
+            case 1: base.drop = atof(optarg); break;
+            case 2: base.dup = atof(optarg); break;
+            case 3: parse_range_ms(optarg, &base.min_delay, &base.max_delay); break;
+            case 4: parse_range_ms(optarg, &base.min_fsync, &base.max_fsync); break;
+            case 5: max_crashes = atoi(optarg); break;
+            case 7: base.max_indoubt = (uint64_t)atol(optarg) * MS; break;
+            case 8: strict = 1; break;
+            case 'v': sim.verbose = 1; break;
+            case 'h':
+            default: print_usage(argv[0]); exit(opt=='h'?0:1);
+        }
+    }
+    if (base.participants > SIM_MAX_PARTICIPANTS) base.participants = SIM_MAX_PARTICIPANTS;
+    if (max_crashes > SIM_MAX_CRASHES) max_crashes = SIM_MAX_CRASHES;
+
+    // coord_lib / participant 의 출력은 -v 일 때만 보임
+    if (sim.verbose) {
+        sim.out = stdout;
+        setvbuf(stdout, NULL, _IONBF, 0);
+    } else {
+        int null_fd = open("/dev/null", O_WRONLY);
+        sim.out = fdopen(dup(STDOUT_FILENO), "w");
+        if (null_fd < 0 || !sim.out) { perror("open"); exit(2); }
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        close(null_fd);
+        setvbuf(stderr, NULL, _IOFBF, 1 << 16);
+    }
+    env_set(&sim_env);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < runs; i++)
+        run_one(seed + i, &base, max_crashes, &st);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    fprintf(sim.out, "runs=%ld seeds=%llu..%llu commit=%ld abort=%ld crashes=%ld\n",
+            st.runs, (unsigned long long)seed, (unsigned long long)(seed + runs - 1),
+            st.commits, st.aborts, st.crashes);
+    fprintf(sim.out, "atomicity_violations=%ld unresolved_in_doubt=%ld latency_violations=%ld\n",
+            st.atomicity_violations, st.unresolved, st.latency_violations);
+    fprintf(sim.out, "max_in_doubt=%.3fms max_complete=%.3fms wall=%.3fs (%.0f runs/s)\n",
+            st.max_indoubt / 1000.0, st.max_complete / 1000.0, wall, wall > 0 ? st.runs / wall : 0.0);
+    fflush(sim.out);
+
+    if (st.atomicity_violations) return 1;
+    if (strict && (st.unresolved || st.latency_violations)) return 1;
+    return 0;
+}
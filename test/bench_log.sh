@@ -0,0 +1,56 @@
+#!/bin/bash
+# Participant log backend 벤치마크: 같은 coordinator 부하 (TXNS 개, WORKERS 개 동시) 를 participant 의
+# --log-backend fsync 와 uring 으로 돌려 txn/s 를 비교한다. uring 이면 participant 가 fdatasync 를 기다리는 동안
+# 다른 worker 의 요청을 처리하므로 WORKERS 가 클수록 차이가 남
+# fdatasync 가 요청 처리 CPU 보다 오래 걸려야 차이가 보이므로 LOG_DIR 을 실제 디스크에 두고 돌릴 것
+# 환경 변수로 조절: TXNS, WORKERS, P (participant 수), LOG_DIR. MIN_SPEEDUP 을 주면 uring / fsync 가 그보다 작을 때 exit 1
+TXNS=${TXNS:-2000}
+WORKERS=${WORKERS:-16}
+P=${P:-3}
+BIN=$(pwd)
+LOG_DIR=${LOG_DIR:-./logs/bench_log}
+rm -rf $LOG_DIR
+mkdir -p $LOG_DIR
+
+cd $LOG_DIR
+rm -f participants.conf
+for i in $(seq 1 $P); do
+    echo "localhost $(printf 0x%x $((0x20000000 + i)))" >> participants.conf
+done
+
+# run <backend>: participant 를 띄우고 coordinator 가 TXNS 개를 끝내는 시간을 재서 txn/s 를 출력
+run() {
+    local PIDS="" i t0 t1
+    rm -f txn.log txn_*.log
+    for i in $(seq 1 $P); do
+        $BIN/participant --id $i --prog $(printf 0x%x $((0x20000000 + i))) --log-backend $1 > participant${i}_$1.out 2>&1 &
+        PIDS="$PIDS $!"
+    done
+    sleep 2 # give participants time to register
+    t0=$(date +%s.%N)
+    $BIN/coordinator --conf participants.conf --log-backend uring --txns $TXNS --workers $WORKERS > coordinator_$1.out 2>&1
+    t1=$(date +%s.%N)
+    kill $PIDS 2>/dev/null
+    wait $PIDS 2>/dev/null
+    # worker 들의 stdout 줄이 섞일 수 있으므로 participant 로그로 확인
+    if [ "$(grep -c ' COMMITTED$' txn_1.log)" -ne "$TXNS" ]; then
+        echo "$1: not every txn committed, see $LOG_DIR/coordinator_$1.out" >&2
+        exit 1
+    fi
+    awk -v n=$TXNS -v a=$t0 -v b=$t1 'BEGIN { printf "%.1f", n / (b - a) }'
+}
+
+FSYNC_TPS=$(run fsync) || exit 1
+URING_TPS=$(run uring) || exit 1
+if grep -q "falling back" participant1_uring.out; then
+    echo "io_uring is not available here, uring ran on the fsync fallback"
+    exit 1
+fi
+SPEEDUP=$(awk -v a=$FSYNC_TPS -v b=$URING_TPS 'BEGIN { printf "%.2f", b / a }')
+
+echo "log txns=$TXNS workers=$WORKERS participants=$P fsync_tps=$FSYNC_TPS uring_tps=$URING_TPS speedup=$SPEEDUP"
+
+if [ -n "$MIN_SPEEDUP" ] && awk -v a=$SPEEDUP -v b=$MIN_SPEEDUP 'BEGIN { exit !(a < b) }'; then
+    echo "speedup $SPEEDUP is below MIN_SPEEDUP=$MIN_SPEEDUP"
+    exit 1
+fi
@@ -0,0 +1,60 @@
+#!/bin/bash
+# Recovery benchmark: loggen 으로 만든 로그로 participant 재시작과 coordinator recovery 시간을 잰다
+# 환경 변수로 조절: TXNS, P (participant 수), START_ONLY, UNDECIDED, IN_DOUBT, LOCKS, SEED
+# MAX_RTO_MS 를 주면 (participant 재시작 최댓값 + coordinator recovery) 가 넘을 때 exit 1
+TXNS=${TXNS:-100000}
+P=${P:-3}
+START_ONLY=${START_ONLY:-0.01}
+UNDECIDED=${UNDECIDED:-0.01}
+IN_DOUBT=${IN_DOUBT:-0.5}
+LOCKS=${LOCKS:-2}
+SEED=${SEED:-1}
+BIN=$(pwd)
+LOG_DIR="./logs/bench_recovery"
+rm -rf $LOG_DIR
+mkdir -p $LOG_DIR
+
+cd $LOG_DIR
+echo "Generating logs..."
+$BIN/loggen --txns $TXNS --participants $P --start-only $START_ONLY --undecided $UNDECIDED \
+            --in-doubt $IN_DOUBT --locks $LOCKS --seed $SEED || exit 1
+
+# participant 재시작: 로그 scan + lock 복원 (--recover-only 는 RPC 등록 전에 끝남)
+PART_MS=0
+for i in $(seq 1 $P); do
+    ms=$($BIN/participant --id $i --prog $(printf 0x%x $((0x20000000 + i))) --recover-only 2>/dev/null |
+         sed -n 's/.* \([0-9.]*\) ms$/\1/p')
+    echo "P$i restart: $ms ms"
+    PART_MS=$(awk -v a=$PART_MS -v b=$ms 'BEGIN { print (b > a) ? b : a }')
+done
+
+# coordinator recovery: participant 들을 띄워 IN_DOUBT / DECIDE_BATCH 까지 포함해서 잰다
+rm -f participants.conf
+PIDS=""
+for i in $(seq 1 $P); do
+    prog=$(printf 0x%x $((0x20000000 + i)))
+    echo "localhost $prog" >> participants.conf
+    $BIN/participant --id $i --prog $prog > participant$i.out 2>&1 &
+    PIDS="$PIDS $!"
+done
+sleep 2 # give participants time to register
+$BIN/coordinator --conf participants.conf > coordinator.out 2>&1
+kill $PIDS 2>/dev/null
+wait $PIDS 2>/dev/null
+
+COORD=$(grep "Recovery finished" coordinator.out)
+SCAN_MS=$(echo "$COORD" | sed -n 's/.*log scan \([0-9.]*\) ms.*/\1/p')
+COORD_MS=$(echo "$COORD" | sed -n 's/.*total \([0-9.]*\) ms.*/\1/p')
+if [ -z "$COORD_MS" ]; then
+    echo "coordinator did not finish recovery, see $LOG_DIR/coordinator.out"
+    exit 1
+fi
+RTO_MS=$(awk -v a=$PART_MS -v b=$COORD_MS 'BEGIN { printf "%.3f", a + b }')
+
+echo "recovery txns=$TXNS participants=$P start_only=$START_ONLY undecided=$UNDECIDED in_doubt=$IN_DOUBT" \
+     "participant_ms=$PART_MS coord_scan_ms=$SCAN_MS coord_ms=$COORD_MS rto_ms=$RTO_MS"
+
+if [ -n "$MAX_RTO_MS" ] && awk -v a=$RTO_MS -v b=$MAX_RTO_MS 'BEGIN { exit !(a > b) }'; then
+    echo "RTO $RTO_MS ms exceeds MAX_RTO_MS=$MAX_RTO_MS"
+    exit 1
+fi
@@ -0,0 +1,26 @@
+# test/testN.sh 가 LOG_DIR 을 정한 뒤 source 하는 공통 함수
+
+# 실패를 알리고 띄워 둔 participant (PIDS) 와 그 밖의 process (BG_PIDS) 를 내림
+fail() { echo "[FAIL] $*"; kill $PIDS $BG_PIDS 2>/dev/null; exit 1; }
+
+stop_participants() {
+    kill $PIDS 2>/dev/null
+    wait $PIDS 2>/dev/null
+    PIDS=""
+}
+
+# start_participants <tag> [participant 옵션...]
+# 단계마다 txn id 가 1 부터 다시 시작하므로 participant 도 새로 띄움 (이전 단계의 로그와 DRC 를 비움).
+# 미리 넣어 둔 로그를 남기려면 KEEP_LOGS=1. 띄울 id 는 PARTICIPANT_IDS (기본 "1 2 3"),
+# participant i 의 prog 는 PROG_BASE + i (기본 0x20000000), 출력은 $LOG_DIR/participant<i>_<tag>.log
+start_participants() {
+    local tag=$1 i
+    shift
+    stop_participants
+    [ -n "$KEEP_LOGS" ] || rm -f txn.log txn_*.log
+    for i in ${PARTICIPANT_IDS:-1 2 3}; do
+        ./participant --id $i --prog $(printf 0x%x $((${PROG_BASE:-0x20000000} + i))) "$@" > $LOG_DIR/participant${i}_$tag.log 2>&1 &
+        PIDS="$PIDS $!"
+    done
+    sleep 1
+}
@@ -0,0 +1,42 @@
+#!/bin/bash
+# Test Case 10: Admission control - max_queue 의 BUSY, participant 당 slot 제한, PREPARE 전 deadline 만료
+LOG_DIR="./logs/test10"
+mkdir -p $LOG_DIR
+rm -f txn.log txn_*.log
+
+. "$(dirname "$0")/lib.sh"
+
+echo "Starting participants..."
+start_participants busy
+
+echo "Starting coordinator (max queue 1, 1 worker, 4 txns)..."
+./coordinator --conf participants.conf --txns 4 --workers 1 --max-queue 1 > $LOG_DIR/coordinator_busy.log 2>&1 || fail "coordinator exited with $?"
+grep -q "^\[BUSY\]" $LOG_DIR/coordinator_busy.log || fail "no submit was rejected with BUSY"
+[ "$(grep -c 'completed with decision = COMMIT' $LOG_DIR/coordinator_busy.log)" -eq 4 ] || fail "BUSY txns were not resubmitted"
+mv txn.log $LOG_DIR/txn_busy.log
+start_participants limit
+
+echo "Starting coordinator (participant limit 1, 4 workers, 4 txns)..."
+./coordinator --conf participants.conf --txns 4 --workers 4 --participant-limit 1 > $LOG_DIR/coordinator_limit.log 2>&1 || fail "coordinator exited with $?"
+[ "$(grep -c 'completed with decision = COMMIT' $LOG_DIR/coordinator_limit.log)" -eq 4 ] || fail "expected 4 COMMIT callbacks"
+# slot 이 하나뿐이면 participant 로그에서 txn 이 겹치지 않음: PREPARED 다음 줄은 항상 같은 txn 의 COMMITTED
+for i in 1 2 3; do
+    awk '$2 == "PREPARED" { if (open) exit 1; open = $1 } $2 == "COMMITTED" { if ($1 != open) exit 1; open = "" }' txn_$i.log ||
+        fail "P$i ran two txns at once despite --participant-limit 1"
+done
+mv txn.log $LOG_DIR/txn_limit.log
+start_participants deadline
+
+echo "Starting coordinator (unreachable participant, deadline 500ms)..."
+CONF=$LOG_DIR/participants_unreachable.conf
+printf "localhost 0x20000001\nlocalhost 0x20000009\n" > $CONF
+./coordinator --conf $CONF --deadline-ms 500 > $LOG_DIR/coordinator_deadline.log 2>&1
+grep -q "deadline passed before PREPARE" $LOG_DIR/coordinator_deadline.log || fail "deadline did not abort the txn"
+grep -q "completed with decision = ABORT" $LOG_DIR/coordinator_deadline.log || fail "expected an ABORT callback"
+[ ! -s txn.log ] || fail "txn.log should have no records for a txn aborted before START"
+[ ! -s txn_1.log ] || fail "P1 should not have received PREPARE"
+rm -f txn.log
+
+sleep 1
+kill $PIDS
+echo "Test Case 10 passed. Logs in $LOG_DIR"
@@ -0,0 +1,75 @@
+#!/bin/bash
+# Test Case 11: Lock conflict - wait-die 대기가 participant 의 요청 처리를 막지 않는지, no-wait 충돌, epoch 의 die / 대기 txn
+LOG_DIR="./logs/test11"
+mkdir -p $LOG_DIR
+rm -f txn.log txn_*.log
+
+. "$(dirname "$0")/lib.sh"
+
+# start_locked <tag> <lock policy> <wait ms> [P1 로그에 미리 넣을 레코드]
+start_locked() {
+    stop_participants
+    rm -f txn.log txn_*.log
+    [ -n "$4" ] && echo "$4" > txn_1.log
+    KEEP_LOGS=1 start_participants $1 --lock-policy $2 --lock-wait-ms $3
+}
+
+now_ms() { echo $(( $(date +%s%N) / 1000000 )); }
+
+# 1. txn 2 (PREPARED, X:5) 가 lock 을 쥔 채 재시작된 P1 에 txn 1 (older) 이 X:5 를 요청하면 기다려야 함.
+#    기다리는 동안에도 P1 은 다른 coordinator 의 recovery (txn 2 ABORT) 를 처리해야 txn 1 이 COMMIT 됨
+start_locked wait wait-die 3000 "2 PREPARED YES X:5"
+grep -q "restored 1 lock" $LOG_DIR/participant1_wait.log || fail "P1 did not restore the lock of txn 2"
+echo "Starting coordinator A (txn 1, X:5)..."
+./coordinator --conf participants.conf --lock 5 --log $LOG_DIR/txn_a.log > $LOG_DIR/coordinator_a.log 2>&1 &
+COORD_A=$!
+sleep 1
+echo "Starting coordinator B (recovery of txn 2)..."
+echo "2 START" > txn.log
+./coordinator --conf participants.conf > $LOG_DIR/coordinator_b.log 2>&1 || fail "recovery coordinator exited with $?"
+wait $COORD_A || fail "coordinator A exited with $?"
+grep -q "completed with decision = COMMIT" $LOG_DIR/coordinator_a.log || fail "txn 1 did not commit after txn 2 was aborted"
+grep -q "Txn 1 waits for key 5" $LOG_DIR/participant1_wait.log || fail "txn 1 did not wait for key 5"
+awk '$1 == 2 && $2 == "ABORT" { a = NR } $1 == 1 && $2 == "PREPARED" { p = NR } END { exit !(a && p > a) }' txn_1.log ||
+    fail "txn 1 was PREPARED before txn 2 released its lock"
+mv txn.log $LOG_DIR/txn_b.log
+
+# 2. 아무도 lock 을 풀어 주지 않으면 --lock-wait-ms 뒤 NO
+start_locked timeout wait-die 500 "2 PREPARED YES X:5"
+echo "Starting coordinator (txn 1, lock held until timeout)..."
+./coordinator --conf participants.conf --lock 5 > $LOG_DIR/coordinator_timeout.log 2>&1 || fail "coordinator exited with $?"
+grep -q "completed with decision = ABORT" $LOG_DIR/coordinator_timeout.log || fail "txn 1 did not abort after the wait timeout"
+grep -q "lock conflict on key 5 (wait timeout)" $LOG_DIR/participant1_timeout.log || fail "P1 did not time out the wait"
+mv txn.log $LOG_DIR/txn_timeout.log
+
+# 3. no-wait 는 기다리지 않고 바로 NO
+start_locked nowait no-wait 0 "2 PREPARED YES X:5"
+echo "Starting coordinator (txn 1, no-wait conflict)..."
+./coordinator --conf participants.conf --lock 5 > $LOG_DIR/coordinator_nowait.log 2>&1 || fail "coordinator exited with $?"
+grep -q "completed with decision = ABORT" $LOG_DIR/coordinator_nowait.log || fail "txn 1 did not abort on a no-wait conflict"
+grep -q "lock conflict on key 5 (no-wait)" $LOG_DIR/participant1_nowait.log || fail "P1 did not report the no-wait conflict"
+grep -q "waits for key" $LOG_DIR/participant1_nowait.log && fail "no-wait policy waited"
+mv txn.log $LOG_DIR/txn_nowait.log
+
+# 4. epoch: 같은 epoch 의 txn 1, 2 가 X:5 를 요청하면 younger 인 txn 2 가 die
+start_locked die wait-die 3000
+echo "Starting coordinator (epoch, 2 txns on X:5)..."
+./coordinator --conf participants.conf --lock 5 --epoch-ms 200 --txns 2 --workers 2 > $LOG_DIR/coordinator_die.log 2>&1 || fail "coordinator exited with $?"
+grep -q "Transaction 1 completed with decision = COMMIT" $LOG_DIR/coordinator_die.log || fail "older txn 1 did not commit"
+grep -q "Transaction 2 completed with decision = ABORT" $LOG_DIR/coordinator_die.log || fail "younger txn 2 did not die"
+grep -q "Txn 2 votes NO: lock conflict on key 5" $LOG_DIR/participant1_die.log || fail "P1 did not vote NO for txn 2"
+mv txn.log $LOG_DIR/txn_die.log
+
+# 5. epoch: 기다려야 하는 older txn 도 PREPARE_EPOCH 안에서 기다리지 않고 NO
+start_locked epochwait wait-die 3000 "3 PREPARED YES X:5"
+echo "Starting coordinator (epoch, txn 1 behind txn 3)..."
+t0=$(now_ms)
+./coordinator --conf participants.conf --lock 5 --epoch-ms 100 > $LOG_DIR/coordinator_epochwait.log 2>&1 || fail "coordinator exited with $?"
+elapsed=$(( $(now_ms) - t0 ))
+grep -q "completed with decision = ABORT" $LOG_DIR/coordinator_epochwait.log || fail "txn 1 did not abort in epoch mode"
+[ $elapsed -lt 2000 ] || fail "PREPARE_EPOCH waited for the lock (${elapsed}ms)"
+mv txn.log $LOG_DIR/txn_epochwait.log
+
+sleep 1
+kill $PIDS
+echo "Test Case 11 passed. Logs in $LOG_DIR"
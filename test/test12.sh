@@ -0,0 +1,66 @@
+#!/bin/bash
+# Test Case 12: Tree 2PC restart - sub-coordinator 가 죽었다 살아나도 PREPARED 레코드의 subtree 목록으로 결정을 내려보냄
+LOG_DIR="./logs/test12"
+mkdir -p $LOG_DIR
+rm -f txn.log txn_*.log
+
+. "$(dirname "$0")/lib.sh"
+
+# fanout 2, participant 3 개: P1 / P2 (sub-coordinator) -> P3
+CONF=$LOG_DIR/participants_tree.conf
+rm -f $CONF
+for i in 1 2 3; do echo "localhost 0x2000002$i" >> $CONF; done
+
+PROG_BASE=0x20000020
+
+# start_tree <tag> [P2 의 failure 옵션]: P1 / P3 은 start_participants 로, 죽었다 살아날 P2 는 따로 (BG_PIDS)
+start_tree() {
+    kill $BG_PIDS 2>/dev/null
+    wait $BG_PIDS 2>/dev/null
+    PARTICIPANT_IDS="1 3" start_participants $1
+    ./participant --id 2 --prog 0x20000022 $2 > $LOG_DIR/participant2_$1.log 2>&1 &
+    P2=$!
+    BG_PIDS=$P2
+    sleep 1
+}
+
+restart_p2() {
+    wait $P2
+    ./participant --id 2 --prog 0x20000022 > $LOG_DIR/participant2_$1.log 2>&1 &
+    P2=$!
+    BG_PIDS=$P2
+    sleep 3
+}
+
+# 1. P2 가 COMMITTED 를 기록한 뒤 하위로 내려보내기 전에 crash -> 재시작하면 FORWARDED 가 없는 결정을 다시 내려보냄
+start_tree commit --fail-after-commit
+echo "Starting coordinator (tree fanout 2, P2 crashes after COMMITTED)..."
+./coordinator --conf $CONF --tree-fanout 2 > $LOG_DIR/coordinator_commit.log 2>&1
+grep -q "completed with decision = COMMIT" $LOG_DIR/coordinator_commit.log || fail "txn 1 did not commit"
+grep -q "^1 PREPARED YES T:2 M:0x20000023@localhost$" txn_2.log || fail "P2 did not log its subtree in the PREPARED record"
+grep -q "FORWARDED" txn_2.log && fail "P2 forwarded before the crash"
+restart_p2 commit_restart
+grep -q "resuming decision forwarding for 1 subtree" $LOG_DIR/participant2_commit_restart.log || fail "P2 did not resume forwarding"
+grep -q "^1 COMMITTED FORWARDED$" txn_2.log || fail "P2 did not record the forwarded COMMIT"
+grep -q "^1 COMMITTED$" txn_3.log || fail "P3 did not commit"
+mv txn.log $LOG_DIR/txn_commit.log
+
+# 2. P2 가 PREPARED 를 기록한 뒤 하위에 PREPARE 를 보내기 전에 crash -> coordinator 는 ABORT.
+#    재시작한 P2 는 결정 전 entry 를 복원해 두고, recovery 의 DECIDE_BATCH 로 받은 ABORT 를 P3 에게 내려보냄
+start_tree prepare --fail-after-prepare
+echo "Starting coordinator (tree fanout 2, P2 crashes after PREPARED)..."
+./coordinator --conf $CONF --tree-fanout 2 > $LOG_DIR/coordinator_prepare.log 2>&1
+grep -q "completed with decision = ABORT" $LOG_DIR/coordinator_prepare.log || fail "txn 1 did not abort"
+restart_p2 prepare_restart
+grep -q "resuming decision forwarding" $LOG_DIR/participant2_prepare_restart.log && fail "P2 forwarded a decision it never received"
+echo "Starting coordinator (recovery)..."
+./coordinator --conf $CONF --tree-fanout 2 > $LOG_DIR/coordinator_recovery.log 2>&1
+sleep 2
+grep -q "forwarding ABORT for Txn 1 to 1 subtree member" $LOG_DIR/participant2_prepare_restart.log || fail "P2 did not forward the recovered ABORT"
+grep -q "^1 ABORT FORWARDED$" txn_2.log || fail "P2 did not record the forwarded ABORT"
+grep -q "^1 ABORT$" txn_3.log || fail "P3 did not abort"
+mv txn.log $LOG_DIR/txn_prepare.log
+
+sleep 1
+kill $PIDS $P2
+echo "Test Case 12 passed. Logs in $LOG_DIR"
@@ -0,0 +1,51 @@
+#!/bin/bash
+# Test Case 13: Log backend - --log-backend uring (COMPLETE 는 기다리지 않음, participant 는 fsync 완료에서 응답) 과 URING_LOG_DISABLE 로 강제한 fsync fallback
+LOG_DIR="./logs/test13"
+mkdir -p $LOG_DIR
+rm -f txn.log txn_*.log
+
+. "$(dirname "$0")/lib.sh"
+
+# run_backend <tag>: txn 6 개 (worker 3 개) 와 epoch 모드 txn 4 개가 모두 기록되는지
+run_backend() {
+    ./coordinator --conf participants.conf --log-backend uring --txns 6 --workers 3 > $LOG_DIR/coordinator_$1.log 2>&1 || fail "coordinator exited with $?"
+    [ "$(grep -c 'completed with decision = COMMIT' $LOG_DIR/coordinator_$1.log)" -eq 6 ] || fail "$1: expected 6 COMMIT callbacks"
+    [ "$(grep -c '^[0-9]* START$' txn.log)" -eq 6 ] || fail "$1: expected 6 START records"
+    [ "$(grep -c '^[0-9]* DECISION_COMMIT$' txn.log)" -eq 6 ] || fail "$1: expected 6 DECISION_COMMIT records"
+    [ "$(grep -c '^[0-9]* COMPLETE$' txn.log)" -eq 6 ] || fail "$1: expected 6 COMPLETE records"
+    for i in 1 2 3; do
+        [ "$(grep -c ' COMMITTED$' txn_$i.log)" -eq 6 ] || fail "$1: P$i did not commit all 6 txns"
+    done
+    mv txn.log $LOG_DIR/txn_$1.log
+    start_participants ${1}_epoch --log-backend uring
+    ./coordinator --conf participants.conf --log-backend uring --epoch-ms 100 --txns 4 --workers 2 > $LOG_DIR/coordinator_${1}_epoch.log 2>&1 || fail "epoch coordinator exited with $?"
+    [ "$(grep -c 'completed with decision = COMMIT' $LOG_DIR/coordinator_${1}_epoch.log)" -eq 4 ] || fail "$1: expected 4 epoch COMMIT callbacks"
+    [ "$(grep -c 'EPOCH_START' txn.log)" -eq "$(grep -c 'EPOCH_COMPLETE' txn.log)" ] || fail "$1: EPOCH_COMPLETE missing"
+    mv txn.log $LOG_DIR/txn_${1}_epoch.log
+}
+
+echo "Starting participants..."
+start_participants uring --log-backend uring
+if grep -q "falling back" $LOG_DIR/participant1_uring.log; then
+    echo "[SKIP] io_uring is not available here, only the fallback is checked"
+else
+    echo "Starting coordinator (io_uring log)..."
+    run_backend uring
+    grep -q "falling back" $LOG_DIR/coordinator_uring.log && fail "coordinator fell back to fsync"
+    # run_backend 가 epoch 단계 전에 내린 participant: PREPARE / COMMIT 응답은 io_uring completion 뒤에 나갔어야 함
+    for i in 1 2 3; do
+        n=$(sed -n "s/.*P$i answered \([0-9]*\) request(s) after io_uring completion.*/\1/p" $LOG_DIR/participant${i}_uring.log)
+        [ "${n:-0}" -ge 12 ] || fail "P$i answered ${n:-0} request(s) from the io_uring completion path, expected 12"
+    done
+fi
+
+echo "Starting coordinator (URING_LOG_DISABLE)..."
+export URING_LOG_DISABLE=1
+start_participants fallback --log-backend uring
+grep -q "falling back to fsync log" $LOG_DIR/participant1_fallback.log || fail "participant did not fall back"
+run_backend fallback
+grep -q "disabled by URING_LOG_DISABLE, falling back to fsync log" $LOG_DIR/coordinator_fallback.log || fail "coordinator did not fall back"
+
+sleep 1
+kill $PIDS
+echo "Test Case 13 passed. Logs in $LOG_DIR"
@@ -0,0 +1,69 @@
+#!/bin/bash
+# Test Case 15: Recovery paging - coordinator 가 죽은 뒤 in-doubt txn 이 IN_DOUBT 한 page (MAX_INDOUBT) 를 넘을 때
+# 모든 page 가 정리되는지, 같은 결정을 다시 보내도 (DECIDE_BATCH 재전송) participant 레코드가 늘지 않는지
+LOG_DIR="./logs/test15"
+mkdir -p $LOG_DIR
+rm -f txn.log txn_*.log
+
+N=1100    # MAX_INDOUBT (1024) 보다 많게
+FIRST=1024
+
+. "$(dirname "$0")/lib.sh"
+
+CONF=$LOG_DIR/participants.conf
+rm -f $CONF
+for i in 1 2 3; do echo "localhost 0x2000003$i" >> $CONF; done
+
+# 미리 만들어 둔 로그로 recovery 하므로 start_participants 가 로그를 지우지 않게 함
+PROG_BASE=0x20000030
+KEEP_LOGS=1
+
+# count <log> <state>: state 레코드 수, dup <log>: 결정 레코드가 두 번 이상 있는 txn 수
+count() { grep -c "^[0-9]* $2$" $1; }
+dup() { awk '$2 == "COMMITTED" || $2 == "ABORT" { n[$1]++ } END { d = 0; for (i in n) if (n[i] > 1) d++; print d }' $1; }
+
+# 1. 결정 전/후에 죽은 coordinator 의 로그: 짝수 txn 은 DECISION_COMMIT 까지, 홀수 txn 은 START 만.
+#    participant 는 모두 PREPARED 이고, P1 은 죽기 전 첫 DECIDE_BATCH page (1..1024) 를 이미 받았음
+seq 1 $N | awk '{ print $1 " START"; if ($1 % 2 == 0) print $1 " DECISION_COMMIT" }' > txn.log
+for i in 1 2 3; do seq 1 $N | awk '{ print $1 " PREPARED YES" }' > txn_$i.log; done
+seq 1 $FIRST | awk '{ print $1 " " ($1 % 2 == 0 ? "COMMITTED" : "ABORT") }' >> txn_1.log
+
+start_participants paging
+echo "Starting coordinator (recovery of $N in-doubt txns)..."
+./coordinator --conf $CONF > $LOG_DIR/coordinator_paging.log 2>&1 || fail "recovery coordinator exited with $?"
+grep -q "Recovery finished" $LOG_DIR/coordinator_paging.log || fail "recovery did not finish"
+for i in 2 3; do
+    grep -q "P$i reporting $FIRST in-doubt txn(s) after Txn 0 (more)" $LOG_DIR/participant${i}_paging.log ||
+        fail "P$i did not page the in-doubt list"
+    grep -q "P$i reporting $((N - FIRST)) in-doubt txn(s) after Txn $FIRST$" $LOG_DIR/participant${i}_paging.log ||
+        fail "P$i did not report the second page"
+    grep -q "P$i: $N in-doubt txn(s), sent $((N / 2)) COMMIT / $((N / 2)) ABORT" $LOG_DIR/coordinator_paging.log ||
+        fail "coordinator did not resolve every page of P$i"
+done
+grep -q "P1: $((N - FIRST)) in-doubt txn(s)" $LOG_DIR/coordinator_paging.log || fail "P1 reported already decided txns"
+for i in 1 2 3; do
+    [ "$(count txn_$i.log COMMITTED)" -eq $((N / 2)) ] || fail "P$i COMMITTED count is not $((N / 2))"
+    [ "$(count txn_$i.log ABORT)" -eq $((N / 2)) ] || fail "P$i ABORT count is not $((N / 2))"
+    [ "$(dup txn_$i.log)" -eq 0 ] || fail "P$i logged a decision twice"
+done
+[ "$(count txn.log COMPLETE)" -eq $N ] || fail "coordinator did not COMPLETE every txn"
+cp txn_1.log $LOG_DIR/txn_1_paging.log
+
+# 2. COMPLETE 를 쓰기 전에 다시 죽었다고 보고 같은 recovery 를 반복: abort fence 의 DECIDE_BATCH 가 같은 ABORT 를 다시 보내도
+#    participant 는 이미 결정된 txn 을 건너뜀
+grep -v " COMPLETE$" txn.log > $LOG_DIR/txn_rerun.log
+mv $LOG_DIR/txn_rerun.log txn.log
+start_participants rerun
+echo "Starting coordinator (recovery rerun)..."
+./coordinator --conf $CONF > $LOG_DIR/coordinator_rerun.log 2>&1 || fail "rerun coordinator exited with $?"
+for i in 1 2 3; do
+    grep -q "P$i: 0 in-doubt txn(s), sent 0 COMMIT / 0 ABORT" $LOG_DIR/coordinator_rerun.log || fail "P$i still had in-doubt txns"
+    [ "$(count txn_$i.log COMMITTED)" -eq $((N / 2)) ] || fail "P$i COMMITTED count changed on rerun"
+    [ "$(count txn_$i.log ABORT)" -eq $((N / 2)) ] || fail "P$i ABORT count changed on rerun"
+    [ "$(dup txn_$i.log)" -eq 0 ] || fail "P$i logged a decision twice on rerun"
+done
+mv txn.log $LOG_DIR/txn_rerun.log
+
+sleep 1
+kill $PIDS
+echo "Test Case 15 passed. Logs in $LOG_DIR"
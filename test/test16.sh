@@ -0,0 +1,77 @@
+#!/bin/bash
+# Test Case 16: Epoch mode - txn 여러 개가 E<id> 레코드 한 벌로 기록되는지, crash 뒤 E 레코드로 recovery 하는지,
+# participant slot 을 기다리는 epoch 가 txn deadline 에 ABORT 되는지
+LOG_DIR="./logs/test16"
+mkdir -p $LOG_DIR
+rm -f txn.log txn_*.log
+
+. "$(dirname "$0")/lib.sh"
+
+count() { grep -c "^[0-9]* $2$" $1; }
+
+# 1. txn 4 개가 한 epoch: coordinator 로그는 START / DECISION / COMPLETE 세 줄, participant 는 txn 마다 PREPARED / COMMITTED
+start_participants format
+echo "Starting coordinator (epoch, 4 txns)..."
+./coordinator --conf participants.conf --epoch-ms 100 --txns 4 --workers 1 > $LOG_DIR/coordinator_format.log 2>&1 || fail "coordinator exited with $?"
+[ "$(grep -c 'completed with decision = COMMIT' $LOG_DIR/coordinator_format.log)" -eq 4 ] || fail "expected 4 COMMIT callbacks"
+[ "$(wc -l < txn.log)" -eq 3 ] || fail "expected 3 coordinator records for one epoch"
+grep -q "^E1 EPOCH_START 1 2 3 4$" txn.log || fail "missing EPOCH_START record"
+grep -q "^E1 EPOCH_DECISION C:1 C:2 C:3 C:4$" txn.log || fail "missing EPOCH_DECISION record"
+grep -q "^E1 EPOCH_COMPLETE 1 2 3 4$" txn.log || fail "missing EPOCH_COMPLETE record"
+for i in 1 2 3; do
+    [ "$(grep -c '^[0-9]* PREPARED YES$' txn_$i.log)" -eq 4 ] || fail "P$i did not prepare 4 txns"
+    [ "$(count txn_$i.log COMMITTED)" -eq 4 ] || fail "P$i did not commit 4 txns"
+done
+mv txn.log $LOG_DIR/txn_format.log
+
+# 2. EPOCH_DECISION 뒤 DECIDE_BATCH 전에 crash -> recovery 가 E 레코드를 txn 별 DECISION_COMMIT 으로 읽고 COMMIT 을 보냄
+start_participants commit
+echo "Starting coordinator (epoch, crash after EPOCH_DECISION)..."
+./coordinator --conf participants.conf --epoch-ms 100 --txns 4 --fail-after-commit > $LOG_DIR/coordinator_commit.log 2>&1
+grep -q "^E1 EPOCH_DECISION C:1 C:2 C:3 C:4$" txn.log || fail "crash happened before EPOCH_DECISION"
+grep -q "EPOCH_COMPLETE" txn.log && fail "EPOCH_COMPLETE written before the crash"
+echo "Starting coordinator (recovery)..."
+./coordinator --conf participants.conf > $LOG_DIR/coordinator_commit_recovery.log 2>&1 || fail "recovery coordinator exited with $?"
+for t in 1 2 3 4; do
+    grep -q "Txn $t: Found DECISION (DECISION_COMMIT)" $LOG_DIR/coordinator_commit_recovery.log || fail "recovery did not read the decision of txn $t"
+    grep -q "^$t COMPLETE$" txn.log || fail "recovery did not COMPLETE txn $t"
+done
+for i in 1 2 3; do
+    [ "$(count txn_$i.log COMMITTED)" -eq 4 ] || fail "P$i did not commit the recovered epoch"
+done
+mv txn.log $LOG_DIR/txn_commit.log
+
+# 3. P1 의 PREPARE_EPOCH 뒤 crash -> EPOCH_START 만 남으므로 recovery 는 모든 txn 을 ABORT
+start_participants prepare
+echo "Starting coordinator (epoch, crash after PREPARE_EPOCH)..."
+./coordinator --conf participants.conf --epoch-ms 100 --txns 4 --fail-after-prepare > $LOG_DIR/coordinator_prepare.log 2>&1
+[ "$(count txn_1.log 'PREPARED YES')" -eq 4 ] || fail "P1 did not prepare the epoch before the crash"
+echo "Starting coordinator (recovery)..."
+./coordinator --conf participants.conf > $LOG_DIR/coordinator_prepare_recovery.log 2>&1 || fail "recovery coordinator exited with $?"
+for t in 1 2 3 4; do
+    grep -q "Txn $t: Found START but no DECISION" $LOG_DIR/coordinator_prepare_recovery.log || fail "recovery did not abort txn $t"
+done
+[ "$(count txn_1.log ABORT)" -eq 4 ] || fail "P1 did not abort the recovered epoch"
+mv txn.log $LOG_DIR/txn_prepare.log
+
+# 4. slot 1 개, 연결되지 않는 participant: 첫 epoch (256 txn) 가 연결 재시도 (약 10초) 동안 slot 을 쥐고 있어도
+#    다음 epoch 는 txn deadline (1초) 에 ABORT 되어야 함. 첫 epoch 도 연결 뒤 deadline 이 지났으므로 PREPARE_EPOCH 없이 ABORT
+start_participants slot
+CONF=$LOG_DIR/participants_unreachable.conf
+printf "localhost 0x20000001\nlocalhost 0x20000009\n" > $CONF
+echo "Starting coordinator (epoch, 300 txns, participant limit 1, deadline 1000ms)..."
+./coordinator --conf $CONF --epoch-ms 100 --txns 300 --workers 2 --participant-limit 1 --deadline-ms 1000 \
+    > $LOG_DIR/coordinator_slot.log 2>&1 || fail "coordinator exited with $?"
+[ "$(grep -c 'completed with decision = ABORT' $LOG_DIR/coordinator_slot.log)" -eq 300 ] || fail "expected 300 ABORT callbacks"
+expired=$(grep -n "Txn 300: deadline passed while queued" $LOG_DIR/coordinator_slot.log | cut -d: -f1)
+connect=$(grep -n "Connect FAILED to P2" $LOG_DIR/coordinator_slot.log | head -1 | cut -d: -f1)
+[ -n "$expired" ] || fail "txn 300 was not aborted while waiting for a slot"
+[ -n "$connect" ] && [ "$expired" -lt "$connect" ] || fail "txn 300 waited for the first epoch past its deadline"
+grep -q "Txn 1: deadline passed before PREPARE" $LOG_DIR/coordinator_slot.log || fail "txn 1 was not aborted after the connect retries"
+grep -q "EPOCH_START" txn.log && fail "an expired epoch was prepared"
+[ "$(grep -c PREPARED txn_1.log)" -eq 0 ] || fail "P1 prepared txns past their deadline"
+rm -f txn.log
+
+sleep 1
+kill $PIDS
+echo "Test Case 16 passed. Logs in $LOG_DIR"
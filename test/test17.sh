@@ -0,0 +1,95 @@
+#!/bin/bash
+# Test Case 17: Duplicate request cache - 같은 xid 로 재전송된 PREPARE 는 PREPARED 를 다시 쓰지 않고,
+# DECIDE_BATCH 로 ABORT 된 뒤 늦게 도착한 재전송에는 저장된 YES 가 아니라 NO 로 답하는지 (PREPARE_EPOCH 는 첫 txn 이
+# 아닌 txn 이 ABORT 되어도).
+# DRC 를 끈 P2 에 다시 온 PREPARE 는 PREPARED / COMMITTED 로그로 답하고 lock 을 다시 잡지 않는지
+LOG_DIR="./logs/test17"
+mkdir -p $LOG_DIR
+rm -f txn.log txn_*.log
+
+. "$(dirname "$0")/lib.sh"
+
+PROG=0x20000041
+./participant --id 1 --prog $PROG > $LOG_DIR/participant1.log 2>&1 &
+PIDS="$!"
+./participant --id 2 --prog 0x20000042 --drc-size 0 --lock-policy no-wait > $LOG_DIR/participant2.log 2>&1 &
+PIDS="$PIDS $!"
+sleep 1
+
+# client 의 UDP 재전송처럼 같은 datagram 을 그대로 다시 보냄 (portmapper 로 port 를 찾음)
+echo "Sending duplicated requests to P1..."
+python3 - $PROG > $LOG_DIR/client.log <<'PY' || fail "duplicate request client failed"
+import socket, struct, sys
+
+PROG = int(sys.argv[1], 16)
+PREPARE, COMMIT, ABORT, DECIDE_BATCH, PREPARE_EPOCH = 1, 2, 3, 6, 7
+
+def call(xid, prog, vers, proc, args):
+    return struct.pack(">IIIIII", xid, 0, 2, prog, vers, proc) + struct.pack(">IIII", 0, 0, 0, 0) + args
+
+def send(port, msg):
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    s.settimeout(5)
+    s.sendto(msg, ("127.0.0.1", port))
+    reply = s.recv(65536)
+    s.close()
+    xid, mtype, stat, _, vlen = struct.unpack(">IIIII", reply[:20])
+    accept = struct.unpack(">I", reply[20 + vlen:24 + vlen])[0]
+    assert xid == struct.unpack(">I", msg[:4])[0] and mtype == 1 and stat == 0 and accept == 0, "RPC rejected"
+    return reply[24 + vlen:]
+
+# PMAPPROC_GETPORT(prog, vers 1, udp)
+def getport(prog):
+    port = struct.unpack(">I", send(111, call(1, 100000, 2, 3, struct.pack(">IIII", prog, 1, 17, 0))))[0]
+    assert port, "participant is not registered"
+    return port
+port = getport(PROG)
+
+# PrepareArgs: txn_id, trace_id, span_id, locks<>, fanout, subtree<>
+prepare = call(0x1001, PROG, 1, PREPARE, struct.pack(">iQQIiI", 1, 0, 0, 0, 0, 0))
+vote = lambda reply: struct.unpack(">i", reply[:4])[0]
+print("first PREPARE", vote(send(port, prepare)))
+print("duplicate PREPARE", vote(send(port, prepare)))
+# DecisionBatch: trace_id, span_id, commit_ids<>, abort_ids<>
+print("DECIDE_BATCH", struct.unpack(">i", send(port, call(0x1002, PROG, 1, DECIDE_BATCH, struct.pack(">QQIIi", 0, 0, 0, 1, 1))))[0])
+print("late PREPARE", vote(send(port, prepare)))
+
+# PrepareEpochArgs: epoch_id, trace_id, span_id, txns<> (txn_id, locks<>). epoch 10 = txn 10, 11 이고 11 만 ABORT
+epoch = call(0x1003, PROG, 1, PREPARE_EPOCH, struct.pack(">iQQIiIiI", 10, 0, 0, 2, 10, 0, 11, 0))
+votes = lambda reply: " ".join(str(v) for v in struct.unpack(">%di" % struct.unpack(">I", reply[:4])[0], reply[4:]))
+print("first PREPARE_EPOCH", votes(send(port, epoch)))
+print("ABORT 11", struct.unpack(">i", send(port, call(0x1004, PROG, 1, ABORT, struct.pack(">iQQ", 11, 0, 0))))[0])
+print("late PREPARE_EPOCH", votes(send(port, epoch)))
+
+# DRC 없는 P2: txn 2 는 key 7 을 X 로 잡음. 다시 온 PREPARE 는 로그로 답해야 함
+PROG, port = PROG + 1, getport(PROG + 1)
+locked = lambda txn: struct.pack(">iQQIiiiI", txn, 0, 0, 1, 7, 1, 0, 0)
+print("txn 2 PREPARE", vote(send(port, call(0x2001, PROG, 1, PREPARE, locked(2)))))
+print("txn 2 PREPARE again", vote(send(port, call(0x2002, PROG, 1, PREPARE, locked(2)))))
+# TxnID: txn_id, trace_id, span_id
+print("txn 2 COMMIT", struct.unpack(">i", send(port, call(0x2003, PROG, 1, COMMIT, struct.pack(">iQQ", 2, 0, 0))))[0])
+print("txn 2 late PREPARE", vote(send(port, call(0x2004, PROG, 1, PREPARE, locked(2)))))
+# 늦은 PREPARE 가 key 7 을 다시 잡았다면 no-wait 에서 NO
+print("txn 3 PREPARE", vote(send(port, call(0x3001, PROG, 1, PREPARE, locked(3)))))
+PY
+
+grep -q "^first PREPARE 1$" $LOG_DIR/client.log || fail "first PREPARE did not vote YES"
+grep -q "^duplicate PREPARE 1$" $LOG_DIR/client.log || fail "duplicate PREPARE did not get the same YES"
+grep -q "^DECIDE_BATCH 1$" $LOG_DIR/client.log || fail "DECIDE_BATCH did not apply the ABORT"
+grep -q "^late PREPARE 0$" $LOG_DIR/client.log || fail "late PREPARE after ABORT was answered YES"
+grep -q "answered duplicate request (proc 1) for Txn 1 from cache (1 hit(s))" $LOG_DIR/participant1.log ||
+    fail "duplicate PREPARE was not answered from the cache"
+[ "$(grep -c '^1 PREPARED' txn_1.log)" -eq 1 ] || fail "expected exactly one PREPARED record for txn 1"
+[ "$(grep -c '^1 ABORT$' txn_1.log)" -eq 1 ] || fail "expected exactly one ABORT record for txn 1"
+grep -q "^first PREPARE_EPOCH 1 1$" $LOG_DIR/client.log || fail "first PREPARE_EPOCH did not vote YES for both txns"
+grep -q "^late PREPARE_EPOCH 1 0$" $LOG_DIR/client.log || fail "late PREPARE_EPOCH after ABORT of txn 11 was answered from the cache"
+for step in "txn 2 PREPARE" "txn 2 PREPARE again" "txn 2 COMMIT" "txn 2 late PREPARE" "txn 3 PREPARE"; do
+    grep -q "^$step 1$" $LOG_DIR/client.log || fail "$step did not get YES"
+done
+[ "$(grep -c '^2 PREPARED' txn_2.log)" -eq 1 ] || fail "PREPARE of a PREPARED txn wrote another PREPARED record"
+[ "$(grep -c '^2 ' txn_2.log)" -eq 2 ] || fail "late PREPARE after COMMITTED wrote a log record"
+[ "$(grep -c '^1 ' txn_1.log)" -eq 2 ] || fail "late PREPARE wrote a log record"
+
+sleep 1
+kill $PIDS
+echo "Test Case 17 passed. Logs in $LOG_DIR"
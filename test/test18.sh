@@ -0,0 +1,137 @@
+#!/bin/bash
+# Test Case 18: Hot standby - primary 가 lease 를 쥔 채 연결만 끊고 다시 붙지 않다가 죽어도 standby 가 넘겨받는지,
+# lease 없이 --replica 를 주면 거절하는지, standby 가 끊긴 뒤 primary 가 COMMIT 한 txn 을 standby 가 ABORT 하지 않는지
+LOG_DIR="./logs/test18"
+mkdir -p $LOG_DIR
+rm -f txn.log txn_*.log coord_standby.log coord.lease
+
+. "$(dirname "$0")/lib.sh"
+
+PORT=47002
+
+# 1. lease 없는 복제는 시작하지 않음
+./coordinator --conf participants.conf --replica localhost:$PORT > $LOG_DIR/no_lease.log 2>&1 && fail "--replica without --lease was accepted"
+grep -q "replication to a standby needs a lease file" $LOG_DIR/no_lease.log || fail "missing lease error"
+[ ! -s txn.log ] || fail "coordinator without a lease wrote its log"
+
+# 2. participant 들은 txn 1 을 PREPARED 로 들고 있음
+echo "Starting participants..."
+PIDS=""
+for i in 1 2 3; do
+    echo "1 PREPARED YES" > txn_$i.log
+    ./participant --id $i --prog 0x2000000$i > $LOG_DIR/participant$i.log 2>&1 &
+    PIDS="$PIDS $!"
+done
+sleep 1
+
+echo "Starting standby coordinator..."
+./coordinator --conf participants.conf --log coord_standby.log --lease coord.lease --standby $PORT > $LOG_DIR/standby.log 2>&1 &
+SB=$!
+BG_PIDS=$SB
+sleep 1
+
+# primary 대신: lease 를 잡고 SNAPSHOT 하나 (txn 1 의 DECISION_COMMIT) 를 보낸 뒤 연결을 끊고, 2초 뒤 lease 를 쥔 채 종료
+echo "Starting primary stand-in (disconnects, then exits holding the lease)..."
+python3 - $PORT > $LOG_DIR/primary.log 2>&1 <<'PY' || fail "primary stand-in failed"
+import fcntl, socket, struct, sys, time
+lease = open("coord.lease", "a+")
+fcntl.lockf(lease, fcntl.LOCK_EX)
+log = b"1 START\n1 DECISION_COMMIT\n"
+s = socket.create_connection(("127.0.0.1", int(sys.argv[1])))
+s.sendall(b"S" + struct.pack(">I", len(log)) + log)
+assert s.recv(1) == b"K", "standby did not ack the snapshot"
+s.close()
+time.sleep(2)
+PY
+
+# primary 가 없어진 뒤 다시 붙는 연결이 없어도 곧 넘겨받아 recovery 를 끝내야 함
+for n in $(seq 1 50); do kill -0 $SB 2>/dev/null || break; sleep 0.1; done
+kill -0 $SB 2>/dev/null && fail "standby did not take over within 5s of the primary exiting"
+wait $SB || fail "standby exited with $?"
+grep -q "primary still holds the lease" $LOG_DIR/standby.log || fail "standby took the lease while the primary held it"
+grep -q "Lease acquired" $LOG_DIR/standby.log || fail "standby did not take over after the primary exited"
+grep -q "Txn 1: Found DECISION (DECISION_COMMIT)" $LOG_DIR/standby.log || fail "standby did not recover from the replicated log"
+sleep 1
+for i in 1 2 3; do
+    grep -q "^1 COMMITTED$" txn_$i.log || fail "P$i did not commit txn 1"
+done
+
+
+# 3. primary 와 standby 사이의 중계가 SNAPSHOT 과 START 만 넘기고 끊어짐. primary 는 lease 에 degraded 를 남기고
+#    DECISION_COMMIT 을 기록한 뒤 P1 에 COMMIT. P2 는 COMMIT 을 받다가 죽고, primary 도 그 사이에 죽음.
+#    standby 의 로그에는 START 만 있으므로 넘겨받으면 ABORT 를 보내게 됨 -> 넘겨받지 않아야 함
+rm -f coord_standby.log coord.lease
+start_participants degraded
+kill $(echo $PIDS | cut -d' ' -f2)
+PIDS=$(echo $PIDS | cut -d' ' -f1,3)
+./participant --id 2 --prog 0x20000002 --fail-on-commit > $LOG_DIR/participant2_degraded_fail.log 2>&1 &
+P2=$!
+sleep 1
+
+echo "Starting standby coordinator (behind a relay)..."
+./coordinator --conf participants.conf --log coord_standby.log --lease coord.lease --standby $((PORT + 1)) > $LOG_DIR/standby_degraded.log 2>&1 &
+SB=$!
+BG_PIDS="$SB $P2"
+sleep 1
+
+# primary -> standby 중계: frame 두 개 (SNAPSHOT, 1 START) 와 그 ack 만 넘기고 양쪽과 listen socket 을 닫음
+python3 - $PORT > $LOG_DIR/relay.log 2>&1 <<'PY' &
+import socket, struct, sys
+port = int(sys.argv[1])
+ls = socket.socket()
+ls.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+ls.bind(("127.0.0.1", port))
+ls.listen(1)
+primary, _ = ls.accept()
+standby = socket.create_connection(("127.0.0.1", port + 1))
+def read(s, n):
+    buf = b""
+    while len(buf) < n:
+        part = s.recv(n - len(buf))
+        assert part, "connection closed"
+        buf += part
+    return buf
+for _ in range(2):
+    hdr = read(primary, 5)
+    body = read(primary, struct.unpack(">I", hdr[1:])[0])
+    print("relayed", hdr[:1].decode(), repr(body))
+    standby.sendall(hdr + body)
+    primary.sendall(read(standby, 1))
+for s in (primary, standby, ls):
+    s.close()
+PY
+RELAY=$!
+sleep 0.5
+
+echo "Starting primary coordinator (P2 dies on COMMIT)..."
+./coordinator --conf participants.conf --lease coord.lease --replica localhost:$PORT > $LOG_DIR/primary_degraded.log 2>&1 &
+PRIMARY=$!
+BG_PIDS="$SB $P2 $PRIMARY"
+for n in $(seq 1 100); do kill -0 $P2 2>/dev/null || break; sleep 0.05; done
+kill -0 $P2 2>/dev/null && fail "P2 did not receive COMMIT"
+{ kill -9 $PRIMARY; wait $PRIMARY; } 2>/dev/null
+wait $RELAY
+grep -q "^1 DECISION_COMMIT$" txn.log || fail "primary did not log the decision"
+grep -q "Marked lease coord.lease degraded" $LOG_DIR/primary_degraded.log || fail "primary did not mark the lease degraded"
+grep -q " degraded$" coord.lease || fail "lease file has no degraded mark"
+grep -q "^1 COMMITTED$" txn_1.log || fail "P1 did not commit before the primary died"
+
+./participant --id 2 --prog 0x20000002 > $LOG_DIR/participant2_degraded_restart.log 2>&1 &
+P2=$!
+BG_PIDS="$SB $P2"
+for n in $(seq 1 50); do kill -0 $SB 2>/dev/null || break; sleep 0.1; done
+kill -0 $SB 2>/dev/null && fail "standby neither took over nor refused within 5s of the primary dying"
+wait $SB && fail "standby took over with a stale log"
+grep -q "Lease coord.lease is marked degraded" $LOG_DIR/standby_degraded.log || fail "missing degraded lease error"
+cat txn_*.log | grep -q "ABORT" && fail "a participant received ABORT for the committed txn"
+
+# primary 를 자기 로그로 다시 띄우면 DECISION_COMMIT 으로 recovery
+echo "Restarting primary (recovery from its own log)..."
+./coordinator --conf participants.conf --lease coord.lease > $LOG_DIR/primary_degraded_recovery.log 2>&1 || fail "primary recovery exited with $?"
+sleep 1
+for i in 1 2 3; do
+    grep -q "^1 COMMITTED$" txn_$i.log || fail "P$i did not commit txn 1 after primary recovery"
+done
+
+kill $PIDS $P2
+echo "Test Case 18 passed. Logs in $LOG_DIR"
@@ -0,0 +1,14 @@
+#!/bin/bash
+# Test Case 19: XDR 특화 루틴 - inline 경로와 generic fallback 경로 모두 rpcgen 루틴과 byte 단위로 같은지 (xdrbench 의 확인만, 반복은 적게)
+LOG_DIR="./logs/test19"
+mkdir -p $LOG_DIR
+
+. "$(dirname "$0")/lib.sh"
+
+for n in 0 2 16; do
+    echo "Running xdrbench (--locks $n)..."
+    ./xdrbench --iters 1000 --locks $n > $LOG_DIR/xdrbench_locks$n.log 2>&1 || fail "fast and generic XDR differ with --locks $n"
+    grep -q "^iters=1000 locks=$n$" $LOG_DIR/xdrbench_locks$n.log || fail "xdrbench did not finish with --locks $n"
+done
+
+echo "Test Case 19 passed. Logs in $LOG_DIR"
@@ -0,0 +1,24 @@
+#!/bin/bash
+# Test Case 5: Hierarchical (tree) 2PC - 7 participants, fanout 2
+LOG_DIR="./logs/test5"
+mkdir -p $LOG_DIR
+rm -f txn.log txn_*.log
+
+CONF=$LOG_DIR/participants_tree.conf
+rm -f $CONF
+PIDS=""
+echo "Starting participants..."
+for i in 1 2 3 4 5 6 7; do
+    PROG=$(printf "0x2000001%d" $i)
+    echo "localhost $PROG" >> $CONF
+    ./participant --id $i --prog $PROG > $LOG_DIR/participant$i.log 2>&1 &
+    PIDS="$PIDS $!"
+done
+sleep 1
+
+echo "Starting coordinator (tree fanout 2)..."
+./coordinator --conf $CONF --tree-fanout 2 > $LOG_DIR/coordinator.log 2>&1
+
+sleep 5
+kill $PIDS
+echo "Test Case 5 finished. Logs in $LOG_DIR (txn_1.log ~ txn_7.log should all be COMMITTED)"
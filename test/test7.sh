@@ -0,0 +1,31 @@
+#!/bin/bash
+# Test Case 7: One-phase commit (participant 1개) + last agent (participant 3개)
+LOG_DIR="./logs/test7"
+mkdir -p $LOG_DIR
+rm -f txn.log txn_*.log
+
+CONF1=$LOG_DIR/participants_one.conf
+echo "localhost 0x20000004" > $CONF1
+CONF3=$LOG_DIR/participants_three.conf
+rm -f $CONF3
+for i in 1 2 3; do echo "localhost 0x2000000$i" >> $CONF3; done
+
+echo "Starting participants..."
+PIDS=""
+for i in 1 2 3 4; do
+    ./participant --id $i --prog 0x2000000$i > $LOG_DIR/participant$i.log 2>&1 &
+    PIDS="$PIDS $!"
+done
+sleep 1
+
+echo "Starting coordinator (one-phase, 1 participant)..."
+./coordinator --conf $CONF1 --one-phase > $LOG_DIR/coordinator_one.log 2>&1
+mv txn.log $LOG_DIR/txn_one.log # 다음 coordinator 가 recovery 만 하고 끝나지 않도록
+
+echo "Starting coordinator (last agent, 3 participants)..."
+./coordinator --conf $CONF3 --one-phase > $LOG_DIR/coordinator_three.log 2>&1
+
+sleep 5
+kill $PIDS
+echo "Test Case 7 finished. Logs in $LOG_DIR"
+echo "(txn_4.log, txn_3.log: COMMITTED without PREPARED / txn_1.log, txn_2.log: PREPARED -> COMMITTED)"
@@ -0,0 +1,27 @@
+#!/bin/bash
+# Test Case 8: Hot standby - primary 가 DECISION_COMMIT 후 통지 전에 죽으면 standby 가 lease 를 넘겨받아 결정을 전달
+LOG_DIR="./logs/test8"
+mkdir -p $LOG_DIR
+rm -f txn.log txn_*.log coord_standby.log coord.lease
+
+echo "Starting participants..."
+PIDS=""
+for i in 1 2 3; do
+    ./participant --id $i --prog 0x2000000$i > $LOG_DIR/participant$i.log 2>&1 &
+    PIDS="$PIDS $!"
+done
+sleep 1
+
+echo "Starting standby coordinator..."
+./coordinator --conf participants.conf --log coord_standby.log --lease coord.lease --standby 47001 > $LOG_DIR/standby.log 2>&1 &
+SB=$!
+sleep 1
+
+echo "Starting primary coordinator (crash after commit decision)..."
+./coordinator --conf participants.conf --lease coord.lease --replica localhost:47001 --fail-after-commit > $LOG_DIR/primary.log 2>&1
+wait $SB
+
+sleep 1
+kill $PIDS
+grep "STANDBY\|Recovery finished" $LOG_DIR/standby.log
+echo "Test Case 8 finished. Logs in $LOG_DIR (txn_1.log ~ txn_3.log should all be COMMITTED)"
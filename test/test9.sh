@@ -0,0 +1,38 @@
+#!/bin/bash
+# Test Case 9: Concurrent submit - worker 4 개로 txn 8 개를 동시에 진행, 로그를 쓸 수 없으면 exit 대신 on_error + ABORT
+LOG_DIR="./logs/test9"
+mkdir -p $LOG_DIR
+rm -f txn.log txn_*.log
+
+. "$(dirname "$0")/lib.sh"
+
+echo "Starting participants..."
+PIDS=""
+for i in 1 2 3; do
+    ./participant --id $i --prog 0x2000000$i > $LOG_DIR/participant$i.log 2>&1 &
+    PIDS="$PIDS $!"
+done
+sleep 1
+
+echo "Starting coordinator (8 txns, 4 workers)..."
+./coordinator --conf participants.conf --txns 8 --workers 4 > $LOG_DIR/coordinator.log 2>&1 || fail "coordinator exited with $?"
+[ "$(grep -c 'completed with decision = COMMIT' $LOG_DIR/coordinator.log)" -eq 8 ] || fail "expected 8 COMMIT callbacks"
+[ "$(grep -c ' COMPLETE$' txn.log)" -eq 8 ] || fail "expected 8 COMPLETE records in txn.log"
+for i in 1 2 3; do
+    [ "$(grep -c ' COMMITTED$' txn_$i.log)" -eq 8 ] || fail "P$i did not commit all 8 txns"
+done
+mv txn.log $LOG_DIR/txn_concurrent.log
+
+echo "Starting coordinator with an unwritable log (3 txns)..."
+./coordinator --conf participants.conf --txns 3 --workers 2 --log $LOG_DIR/missing/txn.log > $LOG_DIR/coordinator_nolog.log 2>&1
+rc=$?
+[ $rc -eq 1 ] || fail "expected exit code 1 after a log failure, got $rc"
+grep -q "Coordinator failed: log append" $LOG_DIR/coordinator_nolog.log || fail "on_error was not called"
+grep -q "completed with decision = COMMIT" $LOG_DIR/coordinator_nolog.log && fail "committed without a log"
+for i in 1 2 3; do
+    [ "$(grep -c ' PREPARED' txn_$i.log)" -eq 8 ] || fail "P$i got PREPARE without a START record"
+done
+
+sleep 1
+kill $PIDS
+echo "Test Case 9 passed. Logs in $LOG_DIR"
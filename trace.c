@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include "trace.h"
+
+// seq 는 seqlock: 기록 중에는 0, 다 쓰면 (ring 에서의 순번 + 1). dump 하는 thread 는 복사 전후의 seq 가
+// 기대한 순번과 같을 때만 쓰고, 그 사이 owner thread 가 덮어쓴 event 는 건너뜀
+typedef struct {
+    uint64_t seq;
+    const char *name;     // 항상 문자열 상수
+    char phase;           // 'X' = span, 's'/'f' = flow
+    int txn_id;
+    uint64_t trace_id;
+    uint64_t ts;
+    uint64_t dur;
+    uint64_t flow_id;
+    long tid;             // ring 은 thread 가 끝나면 다른 thread 가 이어 쓰므로 event 마다 둠
+    char detail[32];
+} TraceEvent;
+
+// thread 가 끝나면 (pthread key destructor) in_use 를 내려 다음에 trace 를 시작하는 thread 가 이어 씀.
+// txn 마다 thread 를 만드는 경로 (tree mode) 에서도 ring 수는 동시에 살아 있는 thread 수를 넘지 않고,
+// 끝난 thread 의 event 는 새 owner 가 덮어쓸 때까지 dump 에 남음
+typedef struct TraceRing {
+    TraceEvent ev[TRACE_RING_SIZE];
+    uint64_t count;       // 지금까지 기록한 수 (owner thread 만 증가)
+    int in_use;           // rings_mu 로 보호
+    struct TraceRing *next;
+} TraceRing;
+
+static int enabled = 0;
+static char out_path[256];
+static char proc_name[64];
+static pthread_mutex_t rings_mu = PTHREAD_MUTEX_INITIALIZER;
+static TraceRing *rings = NULL;
+static __thread TraceRing *my_ring = NULL;
+static __thread long my_tid = 0;
+static pthread_key_t ring_key;
+static uint64_t id_counter = 0;
+static int dumped = 0;    // atexit 과 coord_close 양쪽에서 불려도 한 번만 씀
+
+/* ---------- Init ---------- */
+static void release_ring(void *arg) {
+    TraceRing *r = arg;
+    pthread_mutex_lock(&rings_mu);
+    r->in_use = 0;
+    pthread_mutex_unlock(&rings_mu);
+}
+
+void trace_init(const char *path, const char *process_name) {
+    if (!path || !path[0]) return;
+    if (pthread_key_create(&ring_key, release_ring) != 0) { perror("pthread_key_create"); return; }
+    snprintf(out_path, sizeof(out_path), "%s", path);
+    snprintf(proc_name, sizeof(proc_name), "%s", process_name ? process_name : "process");
+    enabled = 1;
+    // maybe_fail 의 exit(99) 같은 비정상 종료에서도 그때까지의 span 을 남김
+    atexit(trace_dump);
+}
+
+int trace_enabled(void) {
+    return enabled;
+}
+
+uint64_t trace_now(void) {
+    struct timespec ts;
+    if (!enabled) return 0;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// 프로세스 간 충돌하지 않도록 pid 를 상위 bit 에 둠
+uint64_t trace_new_id(void) {
+    if (!enabled) return 0;
+    return ((uint64_t)getpid() << 40) | (__atomic_add_fetch(&id_counter, 1, __ATOMIC_RELAXED) & ((1ULL << 40) - 1));
+}
+
+/* ---------- Recording ---------- */
+// 끝난 thread 가 놓은 ring 이 있으면 그것을, 없으면 새로 만들어 씀
+static TraceRing *claim_ring(void) {
+    TraceRing *r;
+    pthread_mutex_lock(&rings_mu);
+    for (r = rings; r && r->in_use; r = r->next)
+        ;
+    if (!r && (r = calloc(1, sizeof(*r)))) {
+        r->next = rings;
+        rings = r;
+    }
+    if (r) r->in_use = 1;
+    pthread_mutex_unlock(&rings_mu);
+    if (r) pthread_setspecific(ring_key, r);
+    return r;
+}
+
+static TraceEvent *next_event(void) {
+    TraceRing *r = my_ring;
+    if (!r) {
+        if (!(r = claim_ring())) return NULL;
+        my_tid = (long) syscall(SYS_gettid);
+        my_ring = r;
+    }
+    TraceEvent *e = &r->ev[r->count % TRACE_RING_SIZE];
+    __atomic_store_n(&e->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    e->tid = my_tid;
+    return e;
+}
+
+static void commit_event(TraceEvent *e) {
+    __atomic_store_n(&e->seq, my_ring->count + 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&my_ring->count, 1, __ATOMIC_RELEASE);
+}
+
+void trace_span(const char *name, int txn_id, uint64_t trace_id, uint64_t start_us, const char *detail) {
+    TraceEvent *e;
+    if (!enabled || !(e = next_event())) return;
+    uint64_t now = trace_now();
+    e->name = name;
+    e->phase = 'X';
+    e->txn_id = txn_id;
+    e->trace_id = trace_id;
+    e->ts = start_us;
+    e->dur = now > start_us ? now - start_us : 0;
+    e->flow_id = 0;
+    snprintf(e->detail, sizeof(e->detail), "%s", detail ? detail : "");
+    commit_event(e);
+}
+
+static void flow(char phase, uint64_t flow_id, int txn_id, uint64_t trace_id) {
+    TraceEvent *e;
+    if (!enabled || !flow_id || !(e = next_event())) return;
+    e->name = "rpc";
+    e->phase = phase;
+    e->txn_id = txn_id;
+    e->trace_id = trace_id;
+    e->ts = trace_now();
+    e->dur = 0;
+    e->flow_id = flow_id;
+    e->detail[0] = '\0';
+    commit_event(e);
+}
+
+void trace_flow_start(uint64_t flow_id, int txn_id, uint64_t trace_id) {
+    flow('s', flow_id, txn_id, trace_id);
+}
+
+void trace_flow_end(uint64_t flow_id, int txn_id, uint64_t trace_id) {
+    flow('f', flow_id, txn_id, trace_id);
+}
+
+/* ---------- Dump ---------- */
+// JSON 문자열: '"' 와 '\' 와 제어 문자를 escape
+static void put_json_string(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char ch = (unsigned char) *s;
+        if (ch == '"' || ch == '\\') fprintf(f, "\\%c", ch);
+        else if (ch < 0x20) fprintf(f, "\\u%04x", ch);
+        else fputc(ch, f);
+    }
+    fputc('"', f);
+}
+
+// owner thread 가 기록 중이거나 덮어쓴 event 면 0
+static int read_event(const TraceEvent *src, uint64_t seq, TraceEvent *out) {
+    if (__atomic_load_n(&src->seq, __ATOMIC_ACQUIRE) != seq) return 0;
+    memcpy(out, src, sizeof(*out));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&src->seq, __ATOMIC_RELAXED) != seq) return 0;
+    out->detail[sizeof(out->detail) - 1] = '\0';
+    return 1;
+}
+
+// JSON array 형식. 프로세스마다 파일 하나
+void trace_dump(void) {
+    TraceRing *r;
+    TraceEvent e;
+    FILE *f;
+    int pid = getpid();
+
+    if (!enabled || __atomic_exchange_n(&dumped, 1, __ATOMIC_ACQ_REL)) return;
+    f = fopen(out_path, "w");
+    if (!f) { perror("fopen trace"); return; }
+
+    fprintf(f, "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":", pid);
+    put_json_string(f, proc_name);
+    fprintf(f, "}}");
+
+    pthread_mutex_lock(&rings_mu);
+    for (r = rings; r; r = r->next) {
+        uint64_t count = __atomic_load_n(&r->count, __ATOMIC_ACQUIRE);
+        uint64_t i = count > TRACE_RING_SIZE ? count - TRACE_RING_SIZE : 0;
+        for (; i < count; i++) {
+            if (!read_event(&r->ev[i % TRACE_RING_SIZE], i + 1, &e)) continue;
+            fprintf(f, ",\n{\"name\":");
+            put_json_string(f, e.name);
+            if (e.phase == 'X') {
+                fprintf(f, ",\"cat\":\"2pc\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,"
+                           "\"pid\":%d,\"tid\":%ld,\"args\":{\"txn\":%d,\"trace_id\":\"0x%llx\",\"detail\":",
+                        (unsigned long long)e.ts, (unsigned long long)e.dur, pid, e.tid,
+                        e.txn_id, (unsigned long long)e.trace_id);
+                put_json_string(f, e.detail);
+                fprintf(f, "}}");
+            } else {
+                fprintf(f, ",\"cat\":\"2pc\",\"ph\":\"%c\",\"id\":\"0x%llx\",\"ts\":%llu,"
+                           "\"pid\":%d,\"tid\":%ld%s,\"args\":{\"txn\":%d,\"trace_id\":\"0x%llx\"}}",
+                        e.phase, (unsigned long long)e.flow_id, (unsigned long long)e.ts,
+                        pid, e.tid, e.phase == 'f' ? ",\"bp\":\"e\"" : "",
+                        e.txn_id, (unsigned long long)e.trace_id);
+            }
+        }
+    }
+    pthread_mutex_unlock(&rings_mu);
+    fprintf(f, "\n]\n");
+    fclose(f);
+}
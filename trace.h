@@ -0,0 +1,35 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/*
+ * Per-transaction trace spans.
+ * thread 마다 고정 크기 ring buffer 에 span 을 기록하고 (가득 차면 오래된 것부터 덮어씀,
+ * 끝난 thread 의 ring 은 다음 thread 가 이어 쓰므로 ring 수는 동시에 살아 있는 thread 수까지)
+ * 종료 시 Chrome trace / Perfetto 의 JSON array 형식으로 덤프한다.
+ * timestamp 는 CLOCK_REALTIME(us) 라서 coordinator 와 participant 들의 파일을 합치면
+ * 한 timeline 에 놓인다. RPC 는 flow 이벤트(s/f)로 보낸 쪽과 받은 쪽을 연결.
+ *
+ * trace_init 은 atexit 으로 trace_dump 를 등록하므로 exit() 로 끝나는 경로도 파일이 남는다.
+ * trace_dump 는 처음 한 번만 쓰고, 다른 thread 가 기록 중인 event 는 건너뛴다.
+ * signal handler 에서 부르면 안 됨 (stdio, mutex 사용): handler 는 flag 만 세우고 main loop 에서 exit.
+ * trace_init(NULL, ...) 이면 비활성: trace_now() 는 0 을 돌려주고 나머지는 아무것도 안 함.
+ */
+
+#include <stdint.h>
+
+#define TRACE_RING_SIZE 4096
+
+void trace_init(const char *path, const char *process_name);
+int trace_enabled(void);
+uint64_t trace_now(void);
+uint64_t trace_new_id(void);
+
+// start_us 부터 지금까지의 complete span ("ph":"X")
+void trace_span(const char *name, int txn_id, uint64_t trace_id, uint64_t start_us, const char *detail);
+// RPC 송신("s") / 수신("f") 연결
+void trace_flow_start(uint64_t flow_id, int txn_id, uint64_t trace_id);
+void trace_flow_end(uint64_t flow_id, int txn_id, uint64_t trace_id);
+
+void trace_dump(void);
+
+#endif /* TRACE_H */
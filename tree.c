@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <rpc/rpc.h>
+#include "tree.h"
+#include "trace.h"
+#include "xdr_fast.h"
+#include "env.h"
+
+typedef struct {
+    const PrepareArgs *base;
+    int txn_id;
+    uint64_t trace_id;
+    int decision;
+    int fanout;
+    Member *root;
+    Member *sub;
+    int sub_n;
+    int ok;
+    char info[256];
+} TreeCall;
+
+// n 개를 fanout 개의 subtree 로 나눌 때 필요한 RPC 단계 수
+int tree_depth(int n, int fanout) {
+    int d = 0;
+    if (fanout < 1) fanout = 1;
+    while (n > 0) {
+        n = (n + fanout - 1) / fanout - 1; // 가장 큰 구간에서 root 를 뺀 나머지
+        d++;
+    }
+    return d;
+}
+
+// 깊은 subtree 일수록 아래 단계의 타임아웃을 기다려야 하므로 depth 에 비례
+static CLIENT *tree_connect(const Member *m, int levels) {
+    struct timeval tv = { TREE_TIMEOUT_SEC * (levels > 0 ? levels : 1), 0 };
+    CLIENT *clnt = NULL;
+    int attempts;
+
+    // 대량 subtree 는 UDP 메시지 한도를 넘으므로 tcp 사용
+    for (attempts = 0; attempts < 3 && !clnt; attempts++) {
+        if (attempts > 0) env->sleep_ms(1000);
+        clnt = env->connect(m->host, m->prog, COMMIT_VERS, "tcp");
+    }
+    if (!clnt) {
+        fprintf(stderr, "[TREE] Connect FAILED to %s (Prog: 0x%x)\n", m->host, m->prog);
+        return NULL;
+    }
+    clnt_control(clnt, CLSET_TIMEOUT, (char *)&tv);
+    return clnt;
+}
+
+/* ---------- Phase 1 ---------- */
+static void *prepare_subtree(void *arg) {
+    TreeCall *tc = arg;
+    int levels = 1 + tree_depth(tc->sub_n, tc->fanout);
+    CLIENT *clnt = tree_connect(tc->root, levels);
+    PrepareArgs a = *tc->base;
+    PrepareResult res;
+    char info[MAX_INFO + 1] = "";
+    struct timeval tv;
+    enum clnt_stat st;
+    int delay_ms = 1, waited_ms = 0;
+
+    tc->ok = 0;
+    if (!clnt) {
+        snprintf(tc->info, sizeof(tc->info), "0x%x unreachable", tc->root->prog);
+        return NULL;
+    }
+
+    a.subtree.subtree_len = tc->sub_n;
+    a.subtree.subtree_val = tc->sub;
+    a.span_id = trace_new_id();
+    memset(&res, 0, sizeof(res));
+    res.PrepareResult_u.info = info; // NO 의 이유를 할당 없이 받음
+    trace_flow_start(a.span_id, a.txn_id, a.trace_id);
+    clnt_control(clnt, CLGET_TIMEOUT, (char *)&tv);
+
+    // VOTE_RETRY (subtree root 가 wait-die 로 lock 대기 중이거나 아직 하위 투표를 모으는 중) 면
+    // backoff 후 다시 보냄. 아래 단계의 타임아웃을 기다릴 수 있도록 depth 에 비례한 시간까지
+    while ((st = clnt_call(clnt, PREPARE,
+                           (xdrproc_t) xdr_PrepareArgs, (caddr_t) &a,
+                           (xdrproc_t) xdr_PrepareResult, (caddr_t) &res, tv)) == RPC_SUCCESS &&
+           res.ok == VOTE_RETRY && waited_ms < TREE_TIMEOUT_SEC * 1000 * levels) {
+        env->sleep_ms(delay_ms);
+        waited_ms += delay_ms;
+        if (delay_ms < 64) delay_ms *= 2;
+    }
+    if (st != RPC_SUCCESS) {
+        snprintf(tc->info, sizeof(tc->info), "0x%x no reply to PREPARE", tc->root->prog);
+    } else if (res.ok == VOTE_RETRY) {
+        snprintf(tc->info, sizeof(tc->info), "0x%x lock wait gave up", tc->root->prog);
+    } else {
+        tc->ok = res.ok;
+        snprintf(tc->info, sizeof(tc->info), "0x%x: %.200s", tc->root->prog, res.ok ? "YES" : info);
+    }
+    clnt_destroy(clnt);
+    return NULL;
+}
+
+/* ---------- Phase 2 ---------- */
+static void *decide_subtree(void *arg) {
+    TreeCall *tc = arg;
+    CLIENT *clnt = tree_connect(tc->root, 1 + tree_depth(tc->sub_n, tc->fanout));
+    TxnID a = { tc->txn_id, tc->trace_id, trace_new_id() };
+    int ack = 0;
+    struct timeval tv;
+
+    if (clnt) {
+        trace_flow_start(a.span_id, a.txn_id, a.trace_id);
+        clnt_control(clnt, CLGET_TIMEOUT, (char *)&tv);
+        if (clnt_call(clnt, tc->decision ? COMMIT : ABORT,
+                      (xdrproc_t) xdr_TxnID_fast, (caddr_t) &a,
+                      (xdrproc_t) xdr_int, (caddr_t) &ack, tv) == RPC_SUCCESS) {
+            clnt_destroy(clnt);
+            return NULL;
+        }
+        clnt_destroy(clnt);
+    }
+
+    // root 가 죽었으면 그 아래는 결정을 받지 못하므로 직접 내려보냄
+    fprintf(stderr, "[TREE] Txn %d: subtree root 0x%x unreachable, notifying its %d member(s) directly\n",
+                     tc->txn_id, tc->root->prog, tc->sub_n);
+    tree_decide(tc->txn_id, tc->decision, tc->sub, tc->sub_n, tc->fanout, tc->trace_id);
+    return NULL;
+}
+
+// 구간마다 fn 을 thread 로 돌림. thread 를 만들지 못한 구간은 이 thread 에서 직접 진행.
+// calls 를 할당하지 못하면 -1
+static int run_split(TreeCall *proto, Member *members, int n, int fanout, void *(*fn)(void *), TreeCall **out) {
+    int chunks = fanout < n ? fanout : n;
+    int c;
+    TreeCall *calls = calloc(chunks, sizeof(TreeCall));
+    pthread_t *tids = calloc(chunks, sizeof(pthread_t));
+    char *started = calloc(chunks, 1);
+    if (!calls) {
+        perror("calloc");
+        free(tids);
+        free(started);
+        return -1;
+    }
+
+    for (c = 0; c < chunks; c++) {
+        int start = (int)((long)c * n / chunks);
+        int end = (int)((long)(c + 1) * n / chunks);
+        calls[c] = *proto;
+        calls[c].root = &members[start];
+        calls[c].sub = &members[start + 1];
+        calls[c].sub_n = end - start - 1;
+        if (tids && started && pthread_create(&tids[c], NULL, fn, &calls[c]) == 0)
+            started[c] = 1;
+        else
+            fn(&calls[c]);
+    }
+    for (c = 0; c < chunks; c++)
+        if (started && started[c]) pthread_join(tids[c], NULL);
+
+    free(tids);
+    free(started);
+    *out = calls;
+    return chunks;
+}
+
+int tree_prepare(const PrepareArgs *base, Member *members, int n, char *why, size_t why_len) {
+    TreeCall proto, *calls;
+    PrepareArgs args = *base;
+    int fanout = base->fanout > 0 ? base->fanout : 2;
+    int chunks, c, ok = 1;
+
+    if (n <= 0) return 1;
+    args.fanout = fanout; // 아래 단계도 같은 fanout 으로 나눔
+    memset(&proto, 0, sizeof(proto));
+    proto.base = &args;
+    proto.fanout = fanout;
+
+    chunks = run_split(&proto, members, n, fanout, prepare_subtree, &calls);
+    if (chunks < 0) {
+        if (why) snprintf(why, why_len, "out of memory");
+        return 0;
+    }
+    for (c = 0; c < chunks; c++) {
+        if (!calls[c].ok && ok) {
+            ok = 0;
+            if (why) snprintf(why, why_len, "%s", calls[c].info);
+        }
+    }
+    free(calls);
+    return ok;
+}
+
+void tree_decide(int txn_id, int decision, Member *members, int n, int fanout, uint64_t trace_id) {
+    TreeCall proto, *calls;
+
+    if (n <= 0) return;
+    memset(&proto, 0, sizeof(proto));
+    proto.txn_id = txn_id;
+    proto.trace_id = trace_id;
+    proto.decision = decision;
+    proto.fanout = fanout > 0 ? fanout : 2;
+
+    if (run_split(&proto, members, n, proto.fanout, decide_subtree, &calls) < 0) {
+        fprintf(stderr, "[TREE] Txn %d: cannot notify %d member(s). Recovery needed.\n", txn_id, n);
+        return;
+    }
+    free(calls);
+}
@@ -0,0 +1,25 @@
+#ifndef TREE_H
+#define TREE_H
+
+/*
+ * Hierarchical (tree) 2PC helper. coordinator 와 sub-coordinator 역할의 participant 가 같이 사용.
+ * members[0..n) 을 fanout 개의 연속 구간으로 나누고, 각 구간의 첫 member 를 subtree root 로,
+ * 나머지를 그 root 의 subtree 로 PREPARE 에 실어 보낸다. 구간별 호출은 thread 로 병렬 진행.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "commit.h"
+
+#define TREE_TIMEOUT_SEC 5
+
+int tree_depth(int n, int fanout);
+
+// 모든 subtree 가 YES 면 1, 하나라도 NO/무응답이면 0 (why 에 첫 실패 사유)
+int tree_prepare(const PrepareArgs *base, Member *members, int n, char *why, size_t why_len);
+
+// subtree root 에 COMMIT/ABORT 전달. root 에 닿지 못하면 그 subtree 에 직접 전달
+// trace_id 는 TxnID 에 실어 보낼 값 (tracing off 면 0)
+void tree_decide(int txn_id, int decision, Member *members, int n, int fanout, uint64_t trace_id);
+
+#endif /* TREE_H */
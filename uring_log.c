@@ -0,0 +1,290 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "uring_log.h"
+
+#define ULOG_DEFAULT_ENTRIES 256
+#define ULOG_STOP ((uint64_t)-1) // completion thread 종료용 NOP
+
+typedef struct {
+    char *buf;
+    size_t len;
+    int res;              // WRITE 결과 (fsync 완료 때 같이 보고)
+    ulog_done_fn cb;
+    void *arg;
+} UlogReq;
+
+struct UringLog {
+    int ring_fd;
+    int file_fd;
+    unsigned entries;
+
+    // SQ ring
+    void *sq_ptr;
+    size_t sq_sz;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    struct io_uring_sqe *sqes;
+    size_t sqes_sz;
+
+    // CQ ring
+    void *cq_ptr;
+    size_t cq_sz;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    pthread_mutex_t sq_mu;
+    pthread_cond_t space_cv;
+    unsigned inflight;     // 아직 fsync 완료가 안 온 레코드 수
+    pthread_t reaper;
+};
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int) syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int) syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+/* ---------- Submission (sq_mu held) ---------- */
+static struct io_uring_sqe *next_sqe(UringLog *l) {
+    unsigned tail = *l->sq_tail;
+    unsigned head = __atomic_load_n(l->sq_head, __ATOMIC_ACQUIRE);
+    if (tail - head >= l->entries) return NULL;
+
+    unsigned idx = tail & *l->sq_mask;
+    struct io_uring_sqe *sqe = &l->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    l->sq_array[idx] = idx;
+    __atomic_store_n(l->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    return sqe;
+}
+
+static int submit(UringLog *l, unsigned n) {
+    int rc;
+    do {
+        rc = sys_io_uring_enter(l->ring_fd, n, 0, 0);
+    } while (rc < 0 && errno == EINTR);
+    return rc < 0 ? -errno : 0;
+}
+
+/* ---------- Completion thread ---------- */
+static void *reaper_main(void *arg) {
+    UringLog *l = arg;
+    for (;;) {
+        unsigned head = *l->cq_head;
+        unsigned tail = __atomic_load_n(l->cq_tail, __ATOMIC_ACQUIRE);
+
+        if (head == tail) {
+            if (sys_io_uring_enter(l->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+                perror("io_uring_enter");
+                return NULL;
+            }
+            continue;
+        }
+
+        struct io_uring_cqe *cqe = &l->cqes[head & *l->cq_mask];
+        uint64_t data = cqe->user_data;
+        int res = cqe->res;
+        __atomic_store_n(l->cq_head, head + 1, __ATOMIC_RELEASE);
+
+        if (data == ULOG_STOP) return NULL;
+
+        // user_data 하위 1bit: 0 = WRITE, 1 = FDATASYNC
+        UlogReq *req = (UlogReq *)(uintptr_t)(data & ~(uint64_t)1);
+        if ((data & 1) == 0) {
+            if (res < 0) req->res = res;
+            else if ((size_t)res != req->len) req->res = -EIO; // append 가 잘림
+            continue;
+        }
+
+        // write 가 실패했으면 링크된 fsync 는 -ECANCELED 로 옴 -> write 쪽 에러를 보고
+        if (req->res == 0 && res < 0) req->res = res;
+        if (req->cb) req->cb(req->res, req->arg);
+        free(req->buf);
+        free(req);
+
+        pthread_mutex_lock(&l->sq_mu);
+        l->inflight--;
+        pthread_cond_signal(&l->space_cv);
+        pthread_mutex_unlock(&l->sq_mu);
+    }
+}
+
+/* ---------- Public API ---------- */
+UringLog *ulog_open(const char *path, unsigned entries) {
+    struct io_uring_params p;
+    UringLog *l = calloc(1, sizeof(*l));
+    if (!l) return NULL;
+    if (entries == 0) entries = ULOG_DEFAULT_ENTRIES;
+    if (getenv("URING_LOG_DISABLE")) { // fallback 경로 확인용
+        fprintf(stderr, "[WARN] io_uring disabled by URING_LOG_DISABLE, falling back to fsync log\n");
+        free(l);
+        return NULL;
+    }
+
+    memset(&p, 0, sizeof(p));
+    l->ring_fd = sys_io_uring_setup(entries, &p);
+    if (l->ring_fd < 0) {
+        fprintf(stderr, "[WARN] io_uring_setup failed (%s), falling back to fsync log\n", strerror(errno));
+        free(l);
+        return NULL;
+    }
+    l->entries = p.sq_entries;
+
+    l->sq_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    l->cq_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (l->cq_sz > l->sq_sz) l->sq_sz = l->cq_sz;
+        l->cq_sz = l->sq_sz;
+    }
+    l->sq_ptr = mmap(NULL, l->sq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     l->ring_fd, IORING_OFF_SQ_RING);
+    if (l->sq_ptr == MAP_FAILED) goto fail_ring;
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        l->cq_ptr = l->sq_ptr;
+    } else {
+        l->cq_ptr = mmap(NULL, l->cq_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         l->ring_fd, IORING_OFF_CQ_RING);
+        if (l->cq_ptr == MAP_FAILED) goto fail_sq;
+    }
+    l->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+    l->sqes = mmap(NULL, l->sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   l->ring_fd, IORING_OFF_SQES);
+    if (l->sqes == MAP_FAILED) goto fail_cq;
+
+    l->sq_head  = (unsigned *)((char *)l->sq_ptr + p.sq_off.head);
+    l->sq_tail  = (unsigned *)((char *)l->sq_ptr + p.sq_off.tail);
+    l->sq_mask  = (unsigned *)((char *)l->sq_ptr + p.sq_off.ring_mask);
+    l->sq_array = (unsigned *)((char *)l->sq_ptr + p.sq_off.array);
+    l->cq_head  = (unsigned *)((char *)l->cq_ptr + p.cq_off.head);
+    l->cq_tail  = (unsigned *)((char *)l->cq_ptr + p.cq_off.tail);
+    l->cq_mask  = (unsigned *)((char *)l->cq_ptr + p.cq_off.ring_mask);
+    l->cqes     = (struct io_uring_cqe *)((char *)l->cq_ptr + p.cq_off.cqes);
+
+    l->file_fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (l->file_fd < 0) { perror("open"); goto fail_sqes; }
+
+    pthread_mutex_init(&l->sq_mu, NULL);
+    pthread_cond_init(&l->space_cv, NULL);
+    if (pthread_create(&l->reaper, NULL, reaper_main, l) != 0) {
+        perror("pthread_create");
+        close(l->file_fd);
+        goto fail_sqes;
+    }
+    return l;
+
+fail_sqes:
+    munmap(l->sqes, l->sqes_sz);
+fail_cq:
+    if (l->cq_ptr && l->cq_ptr != l->sq_ptr) munmap(l->cq_ptr, l->cq_sz);
+fail_sq:
+    munmap(l->sq_ptr, l->sq_sz);
+fail_ring:
+    fprintf(stderr, "[WARN] io_uring ring setup failed, falling back to fsync log\n");
+    close(l->ring_fd);
+    free(l);
+    return NULL;
+}
+
+int ulog_append(UringLog *l, const char *buf, size_t len, ulog_done_fn cb, void *arg) {
+    UlogReq *req = calloc(1, sizeof(*req));
+    if (!req) return -ENOMEM;
+    req->buf = malloc(len);
+    if (!req->buf) { free(req); return -ENOMEM; }
+    memcpy(req->buf, buf, len);
+    req->len = len;
+    req->cb = cb;
+    req->arg = arg;
+
+    pthread_mutex_lock(&l->sq_mu);
+    // 레코드당 SQE 2개, CQ 는 SQ 의 2배 -> entries/2 개까지 in-flight
+    while (l->inflight >= l->entries / 2)
+        pthread_cond_wait(&l->space_cv, &l->sq_mu);
+
+    struct io_uring_sqe *w = next_sqe(l);
+    struct io_uring_sqe *s = w ? next_sqe(l) : NULL;
+    if (!w || !s) {
+        pthread_mutex_unlock(&l->sq_mu);
+        free(req->buf);
+        free(req);
+        return -EBUSY;
+    }
+
+    w->opcode = IORING_OP_WRITE;
+    w->fd = l->file_fd;
+    w->addr = (uint64_t)(uintptr_t)req->buf;
+    w->len = (unsigned)len;
+    w->off = (uint64_t)-1; // O_APPEND: 현재 파일 끝에 기록
+    w->flags = IOSQE_IO_LINK;
+    w->user_data = (uint64_t)(uintptr_t)req;
+
+    s->opcode = IORING_OP_FSYNC;
+    s->fd = l->file_fd;
+    s->fsync_flags = IORING_FSYNC_DATASYNC;
+    s->user_data = (uint64_t)(uintptr_t)req | 1;
+
+    l->inflight++;
+    int rc = submit(l, 2);
+    pthread_mutex_unlock(&l->sq_mu);
+    return rc;
+}
+
+typedef struct {
+    pthread_mutex_t mu;
+    pthread_cond_t cv;
+    int done;
+    int res;
+} SyncWait;
+
+static void sync_done(int res, void *arg) {
+    SyncWait *w = arg;
+    pthread_mutex_lock(&w->mu);
+    w->res = res;
+    w->done = 1;
+    pthread_cond_signal(&w->cv);
+    pthread_mutex_unlock(&w->mu);
+}
+
+int ulog_append_sync(UringLog *l, const char *buf, size_t len) {
+    SyncWait w = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0 };
+    int rc = ulog_append(l, buf, len, sync_done, &w);
+    if (rc < 0) return rc;
+
+    pthread_mutex_lock(&w.mu);
+    while (!w.done) pthread_cond_wait(&w.cv, &w.mu);
+    pthread_mutex_unlock(&w.mu);
+    return w.res;
+}
+
+void ulog_close(UringLog *l) {
+    if (!l) return;
+
+    // in-flight 레코드가 모두 끝난 뒤 NOP 으로 completion thread 를 깨워 종료
+    pthread_mutex_lock(&l->sq_mu);
+    while (l->inflight > 0)
+        pthread_cond_wait(&l->space_cv, &l->sq_mu);
+    struct io_uring_sqe *nop = next_sqe(l);
+    if (nop) {
+        nop->opcode = IORING_OP_NOP;
+        nop->user_data = ULOG_STOP;
+        submit(l, 1);
+    }
+    pthread_mutex_unlock(&l->sq_mu);
+    if (nop) pthread_join(l->reaper, NULL);
+
+    close(l->file_fd);
+    munmap(l->sqes, l->sqes_sz);
+    if (l->cq_ptr != l->sq_ptr) munmap(l->cq_ptr, l->cq_sz);
+    munmap(l->sq_ptr, l->sq_sz);
+    close(l->ring_fd);
+    free(l);
+}
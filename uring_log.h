@@ -0,0 +1,27 @@
+#ifndef URING_LOG_H
+#define URING_LOG_H
+
+/*
+ * io_uring 기반 append-only log.
+ * 레코드마다 WRITE 와 (IOSQE_IO_LINK 로 묶인) FDATASYNC 를 한 번에 submit 하고,
+ * 전용 completion thread 가 fdatasync 완료(CQE)를 받으면 callback 을 호출한다.
+ * 여러 thread 가 동시에 append 하면 그만큼의 fsync 가 동시에 in-flight 상태가 된다.
+ * liburing 없이 io_uring_setup / io_uring_enter syscall 을 직접 사용.
+ */
+
+#include <stddef.h>
+
+typedef struct UringLog UringLog;
+
+// res: 0 = 디스크에 기록됨, < 0 = -errno
+typedef void (*ulog_done_fn)(int res, void *arg);
+
+// io_uring 을 쓸 수 없는 커널/환경이거나 환경 변수 URING_LOG_DISABLE 이 있으면 NULL (호출자는 기존 fopen/fsync 경로 사용)
+UringLog *ulog_open(const char *path, unsigned entries);
+// submit 만 하고 돌아감. cb 는 completion thread 에서 fdatasync 완료 후 호출
+int ulog_append(UringLog *l, const char *buf, size_t len, ulog_done_fn cb, void *arg);
+// 완료까지 기다림
+int ulog_append_sync(UringLog *l, const char *buf, size_t len);
+void ulog_close(UringLog *l);
+
+#endif /* URING_LOG_H */
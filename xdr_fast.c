@@ -0,0 +1,91 @@
+#include <rpc/rpc.h>
+#include "xdr_fast.h"
+
+#define TXNID_UNITS 5 // txn_id + trace_id (2) + span_id (2). PrepareArgs 도 같은 모양으로 시작
+
+// unsigned hyper 는 상위 32bit 먼저
+static int32_t *put_txn(int32_t *buf, int txn_id, u_quad_t trace_id, u_quad_t span_id) {
+    IXDR_PUT_INT32(buf, txn_id);
+    IXDR_PUT_U_INT32(buf, (uint32_t) (trace_id >> 32));
+    IXDR_PUT_U_INT32(buf, (uint32_t) trace_id);
+    IXDR_PUT_U_INT32(buf, (uint32_t) (span_id >> 32));
+    IXDR_PUT_U_INT32(buf, (uint32_t) span_id);
+    return buf;
+}
+
+static int32_t *get_txn(int32_t *buf, int *txn_id, u_quad_t *trace_id, u_quad_t *span_id) {
+    u_quad_t hi;
+    *txn_id = IXDR_GET_INT32(buf);
+    hi = IXDR_GET_U_INT32(buf);
+    *trace_id = hi << 32 | IXDR_GET_U_INT32(buf);
+    hi = IXDR_GET_U_INT32(buf);
+    *span_id = hi << 32 | IXDR_GET_U_INT32(buf);
+    return buf;
+}
+
+bool_t xdr_TxnID_fast(XDR *xdrs, TxnID *objp) {
+    int32_t *buf;
+    if (xdrs->x_op == XDR_FREE) return TRUE;
+    buf = XDR_INLINE(xdrs, TXNID_UNITS * BYTES_PER_XDR_UNIT);
+    if (!buf) return xdr_TxnID(xdrs, objp);
+    if (xdrs->x_op == XDR_ENCODE)
+        put_txn(buf, objp->txn_id, objp->trace_id, objp->span_id);
+    else
+        get_txn(buf, &objp->txn_id, &objp->trace_id, &objp->span_id);
+    return TRUE;
+}
+
+bool_t xdr_PrepareArgs_fast(XDR *xdrs, PrepareArgs *objp) {
+    int32_t *buf;
+    u_int i, n;
+
+    switch (xdrs->x_op) {
+    case XDR_ENCODE:
+        // 앞부분 + locks 개수 + locks + fanout + subtree 개수 (0) 를 한 번에
+        n = objp->locks.locks_len;
+        if (n > MAX_TXN_LOCKS || objp->subtree.subtree_len > 0) break;
+        buf = XDR_INLINE(xdrs, (TXNID_UNITS + 2 * n + 3) * BYTES_PER_XDR_UNIT);
+        if (!buf) break;
+        buf = put_txn(buf, objp->txn_id, objp->trace_id, objp->span_id);
+        IXDR_PUT_U_INT32(buf, n);
+        for (i = 0; i < n; i++) {
+            IXDR_PUT_INT32(buf, objp->locks.locks_val[i].key);
+            IXDR_PUT_INT32(buf, objp->locks.locks_val[i].exclusive);
+        }
+        IXDR_PUT_INT32(buf, objp->fanout);
+        IXDR_PUT_U_INT32(buf, 0);
+        return TRUE;
+
+    case XDR_DECODE:
+        // subtree 개수는 xdr_array 가 직접 읽어야 하므로 fanout 까지만 inline
+        buf = XDR_INLINE(xdrs, (TXNID_UNITS + 1) * BYTES_PER_XDR_UNIT);
+        if (!buf) break;
+        buf = get_txn(buf, &objp->txn_id, &objp->trace_id, &objp->span_id);
+        n = IXDR_GET_U_INT32(buf);
+        if (n > MAX_TXN_LOCKS) return FALSE;
+        if (n > 0 && !objp->locks.locks_val) {
+            objp->locks.locks_val = mem_alloc(n * sizeof(LockReq));
+            if (!objp->locks.locks_val) return FALSE;
+        }
+        objp->locks.locks_len = n;
+
+        buf = XDR_INLINE(xdrs, (2 * n + 1) * BYTES_PER_XDR_UNIT);
+        if (buf) {
+            for (i = 0; i < n; i++) {
+                objp->locks.locks_val[i].key = IXDR_GET_INT32(buf);
+                objp->locks.locks_val[i].exclusive = IXDR_GET_INT32(buf);
+            }
+            objp->fanout = IXDR_GET_INT32(buf);
+        } else {
+            for (i = 0; i < n; i++)
+                if (!xdr_LockReq(xdrs, &objp->locks.locks_val[i])) return FALSE;
+            if (!xdr_int(xdrs, &objp->fanout)) return FALSE;
+        }
+        return xdr_array(xdrs, (char **) &objp->subtree.subtree_val, &objp->subtree.subtree_len,
+                         MAX_SUBTREE, sizeof(Member), (xdrproc_t) xdr_Member);
+
+    default:
+        break;
+    }
+    return xdr_PrepareArgs(xdrs, objp);
+}
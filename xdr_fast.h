@@ -0,0 +1,19 @@
+#ifndef XDR_FAST_H
+#define XDR_FAST_H
+
+/*
+ * commit.x 에서 txn 마다 오가는 고정 모양 메시지 (TxnID, PrepareArgs) 를 손으로 특화한 XDR 루틴.
+ * wire format 은 rpcgen 이 만든 xdr_TxnID / xdr_PrepareArgs 와 같다.
+ * 필드마다 xdr_int / xdr_u_quad_t 를 부르는 대신 XDR_INLINE 으로 stream 의 버퍼 (연결마다 하나인
+ * CLIENT / SVCXPRT 의 송수신 버퍼) 에 한 번에 읽고 쓴다. 버퍼 경계에 걸려 inline 이 안 되면 generic 루틴으로 넘어간다.
+ */
+
+#include "commit.h"
+
+bool_t xdr_TxnID_fast(XDR *xdrs, TxnID *objp);
+
+// decode 때 locks.locks_val 이 미리 잡아 둔 버퍼 (MAX_TXN_LOCKS 개) 면 거기에 채우므로 할당이 없음
+// (그 버퍼는 xdr_free 하지 말 것). NULL 이면 generic 처럼 할당. tree mode 의 subtree 는 항상 generic
+bool_t xdr_PrepareArgs_fast(XDR *xdrs, PrepareArgs *objp);
+
+#endif /* XDR_FAST_H */
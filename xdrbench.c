@@ -0,0 +1,309 @@
+/*
+ * XDR micro benchmark: txn 마다 오가는 메시지 하나를 encode + decode 하는 CPU 비용을
+ * rpcgen 이 만든 generic 루틴과 xdr_fast.c 의 특화 루틴으로 비교한다.
+ *   - TxnID        : COMMIT / ABORT / STATUS 인자
+ *   - PrepareArgs  : PREPARE 인자 (--locks 개). generic 은 decode 때 lock 목록을 할당하고 xdr_free
+ *   - PrepareResult: YES 투표. 이전 형식 (항상 info 문자열 "Prepared" 를 보냄) 과 지금 형식 (NO 일 때만)
+ * 특화 루틴은 inline 이 되는 경로와 generic 으로 넘어가는 경로 (inline 실패, 일부만 inline) 모두에서
+ * encode 결과가 generic 과 byte 단위로 같고 decode 결과가 원래 메시지와 같은지도 확인하고, 다르면 exit 1.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <rpc/rpc.h>
+#include "commit.h"
+#include "xdr_fast.h"
+
+#define BENCH_BUF 1024
+
+typedef struct {
+    const char *name;
+    const char *path;
+    bool_t (*encode)(XDR *, void *);
+    bool_t (*decode)(XDR *, void *);
+    void *msg;
+} Case;
+
+static long iters = 1000000;
+static volatile unsigned long sink; // decode 결과를 쓰게 해서 최적화로 사라지지 않게
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* ---------- 이전 PrepareResult (struct { int ok; string info<256>; }) ---------- */
+static bool_t xdr_PrepareResult_v1(XDR *xdrs, PrepareResult *objp) {
+    return xdr_int(xdrs, &objp->ok) && xdr_string(xdrs, &objp->PrepareResult_u.info, MAX_INFO);
+}
+
+/* ---------- encode / decode 한 쌍 ---------- */
+static TxnID txn = { 42, 0x1122334455667788ULL, 0x99aabbccddeeff00ULL };
+static PrepareArgs prep;
+static PrepareResult yes = { 1, { "Prepared" } };
+
+static bool_t enc_txn_generic(XDR *x, void *m) { return xdr_TxnID(x, m); }
+static bool_t dec_txn_generic(XDR *x, void *m) { TxnID t; (void) m; if (!xdr_TxnID(x, &t)) return FALSE; sink += t.txn_id; return TRUE; }
+static bool_t enc_txn_fast(XDR *x, void *m) { return xdr_TxnID_fast(x, m); }
+static bool_t dec_txn_fast(XDR *x, void *m) { TxnID t; (void) m; if (!xdr_TxnID_fast(x, &t)) return FALSE; sink += t.txn_id; return TRUE; }
+
+static bool_t enc_prep_generic(XDR *x, void *m) { return xdr_PrepareArgs(x, m); }
+static bool_t dec_prep_generic(XDR *x, void *m) {
+    PrepareArgs a;
+    (void) m;
+    memset(&a, 0, sizeof(a));
+    if (!xdr_PrepareArgs(x, &a)) return FALSE;
+    sink += a.txn_id + a.locks.locks_len;
+    xdr_free((xdrproc_t) xdr_PrepareArgs, (char *) &a);
+    return TRUE;
+}
+static bool_t enc_prep_fast(XDR *x, void *m) { return xdr_PrepareArgs_fast(x, m); }
+static bool_t dec_prep_fast(XDR *x, void *m) {
+    static LockReq locks[MAX_TXN_LOCKS];
+    PrepareArgs a;
+    (void) m;
+    memset(&a, 0, sizeof(a));
+    a.locks.locks_val = locks;
+    if (!xdr_PrepareArgs_fast(x, &a)) return FALSE;
+    sink += a.txn_id + a.locks.locks_len;
+    return TRUE;
+}
+
+static bool_t enc_vote_v1(XDR *x, void *m) { return xdr_PrepareResult_v1(x, m); }
+static bool_t dec_vote_v1(XDR *x, void *m) {
+    PrepareResult r;
+    (void) m;
+    memset(&r, 0, sizeof(r));
+    if (!xdr_PrepareResult_v1(x, &r)) return FALSE;
+    sink += r.ok;
+    free(r.PrepareResult_u.info); // 이전 coordinator 는 xdr_free 로 해제
+    return TRUE;
+}
+static bool_t enc_vote(XDR *x, void *m) { return xdr_PrepareResult(x, m); }
+static bool_t dec_vote(XDR *x, void *m) {
+    char info[MAX_INFO + 1];
+    PrepareResult r;
+    (void) m;
+    r.PrepareResult_u.info = info;
+    if (!xdr_PrepareResult(x, &r)) return FALSE;
+    sink += r.ok;
+    return TRUE;
+}
+
+/* ---------- 측정 ---------- */
+static u_int encode_once(const Case *c, char *buf) {
+    XDR x;
+    u_int len;
+    xdrmem_create(&x, buf, BENCH_BUF, XDR_ENCODE);
+    if (!c->encode(&x, c->msg)) { fprintf(stderr, "%s/%s: encode failed\n", c->name, c->path); exit(1); }
+    len = xdr_getpos(&x);
+    xdr_destroy(&x);
+    return len;
+}
+
+// encode + decode 한 번을 iters 번 반복한 메시지당 ns
+static double run(const Case *c, u_int *bytes) {
+    char buf[BENCH_BUF];
+    double t0;
+    long i;
+    XDR enc, dec;
+
+    *bytes = encode_once(c, buf);
+    xdrmem_create(&enc, buf, BENCH_BUF, XDR_ENCODE);
+    xdrmem_create(&dec, buf, BENCH_BUF, XDR_DECODE);
+    t0 = now_ns();
+    for (i = 0; i < iters; i++) {
+        xdr_setpos(&enc, 0);
+        if (!c->encode(&enc, c->msg)) exit(1);
+        xdr_setpos(&dec, 0);
+        if (!c->decode(&dec, c->msg)) { fprintf(stderr, "%s/%s: decode failed\n", c->name, c->path); exit(1); }
+    }
+    return (now_ns() - t0) / iters;
+}
+
+/* ---------- 특화 루틴의 fallback 경로 확인 ---------- */
+// xdrmem 과 같지만 XDR_INLINE 은 limit byte 이하만 됨 (0 = 항상 실패: 버퍼 경계에 걸린 stream 과 같음)
+typedef struct {
+    const struct xdr_ops *mem_ops;
+    struct xdr_ops ops;
+    u_int limit;
+} LimitedXdr;
+
+static int32_t *limited_inline(XDR *xdrs, u_int len) {
+    LimitedXdr *l = (LimitedXdr *) xdrs->x_public;
+    return len <= l->limit ? l->mem_ops->x_inline(xdrs, len) : NULL;
+}
+
+static void xdrlimited_create(XDR *x, LimitedXdr *l, char *buf, enum xdr_op op, u_int limit) {
+    xdrmem_create(x, buf, BENCH_BUF, op);
+    l->mem_ops = x->x_ops;
+    l->ops = *x->x_ops;
+    l->ops.x_inline = limited_inline;
+    l->limit = limit;
+    x->x_ops = &l->ops;
+    x->x_public = (char *) l;
+}
+
+static int same_prep(const PrepareArgs *a, const PrepareArgs *b) {
+    u_int i;
+    if (a->txn_id != b->txn_id || a->trace_id != b->trace_id || a->span_id != b->span_id ||
+        a->fanout != b->fanout || a->locks.locks_len != b->locks.locks_len ||
+        a->subtree.subtree_len != b->subtree.subtree_len)
+        return 0;
+    if (a->locks.locks_len && memcmp(a->locks.locks_val, b->locks.locks_val, a->locks.locks_len * sizeof(LockReq)) != 0)
+        return 0;
+    for (i = 0; i < a->subtree.subtree_len; i++)
+        if (a->subtree.subtree_val[i].prog != b->subtree.subtree_val[i].prog ||
+            strcmp(a->subtree.subtree_val[i].host, b->subtree.subtree_val[i].host) != 0)
+            return 0;
+    return 1;
+}
+
+// generic 으로 encode 한 결과 (기준) 와 limit 을 건 stream 에서 특화 루틴으로 encode 한 결과를 비교하고,
+// 같은 stream 에서 특화 루틴으로 decode 한 것이 원래 메시지와 같은지 확인
+static int check_txn(const TxnID *m, u_int limit) {
+    char want[BENCH_BUF], got[BENCH_BUF];
+    LimitedXdr l;
+    TxnID t;
+    XDR x;
+    u_int n0, n1;
+    int ok;
+
+    xdrmem_create(&x, want, BENCH_BUF, XDR_ENCODE);
+    ok = xdr_TxnID(&x, (TxnID *) m);
+    n0 = xdr_getpos(&x);
+    xdr_destroy(&x);
+    xdrlimited_create(&x, &l, got, XDR_ENCODE, limit);
+    ok = ok && xdr_TxnID_fast(&x, (TxnID *) m);
+    n1 = xdr_getpos(&x);
+    xdr_destroy(&x);
+    ok = ok && n0 == n1 && memcmp(want, got, n0) == 0;
+
+    xdrlimited_create(&x, &l, got, XDR_DECODE, limit);
+    ok = ok && xdr_TxnID_fast(&x, &t) && xdr_getpos(&x) == n0;
+    xdr_destroy(&x);
+    ok = ok && t.txn_id == m->txn_id && t.trace_id == m->trace_id && t.span_id == m->span_id;
+    if (!ok) fprintf(stderr, "TxnID: fast path differs from generic (inline limit %u)\n", limit);
+    return ok ? 0 : 1;
+}
+
+static int check_prep(const char *what, const PrepareArgs *m, u_int limit) {
+    static LockReq locks[MAX_TXN_LOCKS];
+    char want[BENCH_BUF], got[BENCH_BUF];
+    LimitedXdr l;
+    PrepareArgs a;
+    XDR x;
+    u_int n0, n1;
+    int ok;
+
+    xdrmem_create(&x, want, BENCH_BUF, XDR_ENCODE);
+    ok = xdr_PrepareArgs(&x, (PrepareArgs *) m);
+    n0 = xdr_getpos(&x);
+    xdr_destroy(&x);
+    xdrlimited_create(&x, &l, got, XDR_ENCODE, limit);
+    ok = ok && xdr_PrepareArgs_fast(&x, (PrepareArgs *) m);
+    n1 = xdr_getpos(&x);
+    xdr_destroy(&x);
+    ok = ok && n0 == n1 && memcmp(want, got, n0) == 0;
+
+    memset(&a, 0, sizeof(a));
+    a.locks.locks_val = locks;
+    xdrlimited_create(&x, &l, got, XDR_DECODE, limit);
+    ok = ok && xdr_PrepareArgs_fast(&x, &a) && xdr_getpos(&x) == n0 && same_prep(&a, m);
+    xdr_destroy(&x);
+    a.locks.locks_val = NULL; // 고정 버퍼. subtree 만 해제
+    a.locks.locks_len = 0;
+    xdr_free((xdrproc_t) xdr_PrepareArgs, (char *) &a);
+    if (!ok) fprintf(stderr, "PrepareArgs (%s): fast path differs from generic (inline limit %u)\n", what, limit);
+    return ok ? 0 : 1;
+}
+
+// inline 전부 실패 / 앞부분 (txn_id .. locks 개수) 만 inline / 항상 inline
+static int check_fast(void) {
+    static LockReq many[MAX_TXN_LOCKS];
+    static Member members[] = { { "localhost", 0x20000023 }, { "node-b", 0x20000024 } };
+    const u_int limits[] = { 0, (5 + 1) * BYTES_PER_XDR_UNIT, BENCH_BUF };
+    PrepareArgs full = prep, tree = prep;
+    int rc = 0;
+    u_int i;
+
+    for (i = 0; i < MAX_TXN_LOCKS; i++) { many[i].key = 2000 + i; many[i].exclusive = !(i & 1); }
+    full.locks.locks_len = MAX_TXN_LOCKS;
+    full.locks.locks_val = many;
+    tree.fanout = 2;
+    tree.subtree.subtree_len = 2;
+    tree.subtree.subtree_val = members;
+
+    for (i = 0; i < sizeof(limits) / sizeof(limits[0]); i++) {
+        rc |= check_txn(&txn, limits[i]);
+        rc |= check_prep("--locks", &prep, limits[i]);
+        rc |= check_prep("MAX_TXN_LOCKS", &full, limits[i]);
+        rc |= check_prep("subtree", &tree, limits[i]);
+    }
+    return rc;
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [OPTIONS]\n"
+        "--iters <n>     (메시지당 반복 수, 기본 1000000)\n"
+        "--locks <n>     (PrepareArgs 의 lock 수, 기본 2, 최대 %d)\n"
+        "-h,--help\n",
+        prog, MAX_TXN_LOCKS);
+}
+
+int main(int argc, char **argv) {
+    static LockReq locks[MAX_TXN_LOCKS];
+    int nlocks = 2, i, rc = 0;
+    static struct option long_opts[] = {
+        {"iters", required_argument, 0, 'n'},
+        {"locks", required_argument, 0, 'l'},
+        {"help", no_argument, 0, 'h'},
+        {0,0,0,0}
+    };
+    int opt, index = 0;
+    while ((opt = getopt_long(argc, argv, "n:l:h", long_opts, &index)) != -1) {
+        switch (opt) {
+            case 'n': iters = atol(optarg); break;
+            case 'l': nlocks = atoi(optarg); break;
+            case 'h':
+            default: print_usage(argv[0]); exit(opt=='h'?0:1);
+        }
+    }
+    if (iters < 1) iters = 1;
+    if (nlocks < 0) nlocks = 0;
+    if (nlocks > MAX_TXN_LOCKS) nlocks = MAX_TXN_LOCKS;
+
+    for (i = 0; i < nlocks; i++) { locks[i].key = 1000 + i; locks[i].exclusive = i & 1; }
+    prep.txn_id = txn.txn_id;
+    prep.trace_id = txn.trace_id;
+    prep.span_id = txn.span_id;
+    prep.locks.locks_len = nlocks;
+    prep.locks.locks_val = locks;
+
+    // 같은 메시지를 두 경로로: [0] 이 기준, [1] 이 바뀐 경로
+    Case cases[][2] = {
+        { { "TxnID", "generic", enc_txn_generic, dec_txn_generic, &txn },
+          { "TxnID", "fast", enc_txn_fast, dec_txn_fast, &txn } },
+        { { "PrepareArgs", "generic", enc_prep_generic, dec_prep_generic, &prep },
+          { "PrepareArgs", "fast", enc_prep_fast, dec_prep_fast, &prep } },
+        { { "PrepareResult", "always-info", enc_vote_v1, dec_vote_v1, &yes },
+          { "PrepareResult", "info-on-NO", enc_vote, dec_vote, &yes } },
+    };
+
+    printf("%-14s %-12s %6s %9s\n", "message", "path", "bytes", "ns/msg");
+    for (i = 0; i < (int) (sizeof(cases) / sizeof(cases[0])); i++) {
+        u_int b0, b1;
+        double ns0 = run(&cases[i][0], &b0);
+        double ns1 = run(&cases[i][1], &b1);
+        printf("%-14s %-12s %6u %9.1f\n", cases[i][0].name, cases[i][0].path, b0, ns0);
+        printf("%-14s %-12s %6u %9.1f  (%+.0f%%)\n", cases[i][1].name, cases[i][1].path, b1, ns1, (ns1 / ns0 - 1) * 100);
+    }
+    // 특화 루틴은 wire format 이 같아야 함 (PrepareResult 는 형식 자체가 바뀌었으므로 비교하지 않음)
+    rc = check_fast();
+    printf("iters=%ld locks=%d\n", iters, nlocks);
+    return rc;
+}